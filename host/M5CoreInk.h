@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file M5CoreInk.h
+ * @brief Headless stand-in for the parts of M5Core-Ink the UI draws with.
+ *
+ * `Ink_Sprite` rasterizes into an in-memory 1bpp buffer laid out like the
+ * real one (rows of `width / 8` bytes, MSB leftmost) and counts draw calls;
+ * `InkPanel` keeps the pixels it was sent so a frame can be checked against
+ * what the panel would show. Set bits are ink. Only the calls the firmware
+ * uses are provided.
+ */
+
+#define TFT_BLACK 0
+#define TFT_WHITE 1
+
+/**
+ * @brief Milliseconds since the first call.
+ * @return Monotonic milliseconds.
+ */
+uint32_t millis();
+
+/**
+ * @brief Microseconds since the first call, on the same origin as `millis()`.
+ * @return Monotonic microseconds; wraps like the device's.
+ */
+uint32_t micros();
+
+/** @brief The e-ink panel: windowed updates into a 200x200 1bpp image. */
+class InkPanel {
+ public:
+  /** @brief Panel side in pixels. */
+  static const int SIZE = 200;
+
+  /** @return Always `true`; there is nothing to bring up. */
+  bool isInit() { return true; }
+  /**
+   * @brief Full-waveform clear to white.
+   * @param mode Ignored.
+   * @return 0.
+   */
+  int clear(int mode = 0);
+  /**
+   * @brief Select the window the next `drawBuff()` updates.
+   * @return 0.
+   */
+  int setDrawAddr(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  /**
+   * @brief Update the selected window.
+   * @param before What the window showed (checked against the panel).
+   * @param after What it shows now.
+   * @param size Bytes in each buffer.
+   * @return 0.
+   */
+  int drawBuff(uint8_t *before, uint8_t *after, size_t size);
+
+  /** @brief Current panel image. */
+  uint8_t pixels[SIZE / 8 * SIZE];
+  /** @brief Windows sent with `drawBuff()`. */
+  uint32_t windows;
+  /** @brief Pixels sent with `drawBuff()`. */
+  uint32_t windowPixels;
+  /** @brief `drawBuff()` calls whose "before" did not match the panel. */
+  uint32_t staleBefore;
+  /** @brief `clear()` calls. */
+  uint32_t clears;
+
+ private:
+  uint16_t addrX = 0;
+  uint16_t addrY = 0;
+  uint16_t addrW = 0;
+  uint16_t addrH = 0;
+};
+
+/** @brief Sprite that draws into RAM, with the legacy M5Core-Ink API. */
+class Ink_Sprite {
+ public:
+  /** @param panel Panel `pushSprite()` copies to. */
+  explicit Ink_Sprite(InkPanel *panel) : panel(panel) {}
+
+  /** @brief Allocate the buffer; only full-screen 200x200 sprites exist. */
+  int creatSprite(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                  bool copyFull = true);
+  /** @brief Copy the whole buffer to the panel. */
+  int pushSprite();
+  /** @return The 1bpp framebuffer. */
+  uint8_t *getSpritePtr() { return buffer; }
+
+  void fillScreen(uint16_t color);
+  void drawPixel(int x, int y, uint16_t color);
+  void drawRect(int x, int y, int w, int h, uint16_t color);
+  void fillRect(int x, int y, int w, int h, uint16_t color);
+  void drawLine(int x0, int y0, int x1, int y1, uint16_t color);
+  void drawCircle(int x, int y, int r, uint16_t color);
+  void fillCircle(int x, int y, int r, uint16_t color);
+  void drawBitmap(int x, int y, const uint8_t *bits, int w, int h,
+                  uint16_t color);
+  /** @brief 6x8 glyphs (5x7 font plus spacing) times the text size. */
+  void drawString(const char *text, int x, int y);
+  void setTextSize(uint8_t size) { textSize = size ? size : 1; }
+  void setTextColor(uint16_t color) { textColor = color; }
+  void setColor(uint16_t color) { (void)color; }
+
+  /** @brief Drawing calls made since boot (`fillScreen` included). */
+  uint32_t drawCalls = 0;
+
+ private:
+  void plot(int x, int y, uint16_t color);
+
+  InkPanel *panel;
+  uint8_t buffer[InkPanel::SIZE / 8 * InkPanel::SIZE];
+  uint8_t textSize = 1;
+  uint16_t textColor = TFT_WHITE;
+};
+
+/** @brief The `M5` singleton, reduced to its panel. */
+struct M5CoreInkHost {
+  InkPanel M5Ink;
+};
+
+/** @brief Board singleton, as in the real library. */
+extern M5CoreInkHost M5;
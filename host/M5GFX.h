@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * @file M5GFX.h
+ * @brief Host builds draw through `host/M5CoreInk.h`; nothing else is needed.
+ */
+
+#include "M5CoreInk.h"
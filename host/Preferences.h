@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file Preferences.h
+ * @brief File-backed stand-in for the Arduino `Preferences` NVS wrapper.
+ *
+ * Each key is one file, `<dir>/<namespace>.<key>.bin`, where `<dir>` comes
+ * from `Preferences::setStorageDir()` or the `TAMA_PREFS_DIR` environment
+ * variable (default: current directory). Only the calls the firmware uses
+ * are provided.
+ */
+class Preferences {
+ public:
+  /**
+   * @brief Open a namespace.
+   * @param name Namespace name.
+   * @param readOnly Reject writes until `end()`.
+   * @return `true` on success.
+   */
+  bool begin(const char *name, bool readOnly = false);
+  /** @brief Close the namespace. */
+  void end();
+  /**
+   * @brief Size of a stored blob.
+   * @param key Key name.
+   * @return Length in bytes, or `0` when the key does not exist.
+   */
+  size_t getBytesLength(const char *key);
+  /**
+   * @brief Read a blob.
+   * @param key Key name.
+   * @param buf Destination.
+   * @param maxLen Capacity of `buf`.
+   * @return Bytes read, or `0` when missing or larger than `maxLen`.
+   */
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  /**
+   * @brief Store a blob, replacing any previous value.
+   * @param key Key name.
+   * @param value Data.
+   * @param len Length in bytes.
+   * @return Bytes written; `0` on failure or an injected torn write.
+   */
+  size_t putBytes(const char *key, const void *value, size_t len);
+  /**
+   * @brief Delete a key.
+   * @param key Key name.
+   * @return `true` if it existed.
+   */
+  bool remove(const char *key);
+
+  /**
+   * @brief Directory the stand-in keeps its files in.
+   * @param dir Existing directory; `nullptr` restores the default.
+   */
+  static void setStorageDir(const char *dir);
+  /**
+   * @brief Make the next `putBytes()` stop after `keepBytes`, like power
+   * failing mid-write. It leaves the truncated blob behind and returns `0`.
+   * @param keepBytes Bytes that reach storage.
+   */
+  static void tearNextWrite(size_t keepBytes);
+
+ private:
+  bool pathFor(const char *key, char *out, size_t capacity) const;
+
+  char name_[16] = {0};
+  bool open_ = false;
+  bool readOnly_ = true;
+};
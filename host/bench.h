@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file bench.h
+ * @brief Host benchmark suites and the tiny harness they share.
+ */
+
+/**
+ * @brief Monotonic wall clock for timing runs.
+ * @return Nanoseconds since an arbitrary origin.
+ */
+uint64_t benchNowNs();
+
+/**
+ * @brief Record checks a suite saw go wrong; any at all fail the run.
+ * @param count Mismatches, missing goldens and the like; `0` is a no-op.
+ */
+void benchFail(int count);
+
+/**
+ * @brief Simulation throughput: simulated minutes per second of
+ * `simulateMinutes` over week- and year-long horizons.
+ */
+void runSimBench();
+
+/**
+ * @brief Packed save size plus encode/decode time for a year-old pet.
+ */
+void runSaveBench();
+
+/**
+ * @brief CRC16/CRC32 throughput on save-sized and log-sized buffers.
+ */
+void runChecksumBench();
+
+/**
+ * @brief A/B save slots against torn writes, plus save/load time.
+ */
+void runSlotsBench();
+
+/**
+ * @brief Event log append/flush cost, flash bytes per event, wrap-around and
+ * read-back after torn writes, on a RAM model of NOR flash.
+ */
+void runEvlogBench();
+
+/**
+ * @brief Every screen rendered headless: draw calls and time per switch and
+ * per clock tick, plus a pixel comparison with the golden PBM frames.
+ */
+void runRenderBench();
+
+/**
+ * @brief Timing probes over a week of catch-up and a round of every screen:
+ * per-probe totals, plus the Chrome trace JSON.
+ */
+void runTraceBench();
+
+/**
+ * @brief A day of the event-driven loop on a virtual clock: wakeups and time
+ * asleep against the old 10 ms poll.
+ */
+void runWakeBench();
+
+/**
+ * @brief Button pipeline on scripted bouncy edges (gestures, a burst while
+ * the loop is stalled) and the edge queue across two threads.
+ */
+void runInputBench();
+
+/**
+ * @brief View-model sequence lock: publish and read cost, then one writer
+ * against several reader threads, counting torn copies.
+ */
+void runSnapshotBench();
+
+/**
+ * @brief A week of deep sleep as `wakeDeepSleepUntil()` plans it, neglected
+ * and tended: sleeps per day, minutes awake, changes slept through, and a
+ * battery estimate against light sleep alone.
+ */
+void runDeepSleepBench();
@@ -0,0 +1,121 @@
+#include "bench.h"
+#include "checksum.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @file bench_checksum.cpp
+ * @brief CRC throughput on save-sized and log-sized buffers.
+ *
+ * The bitwise CRC16 is the loop saves used before the checksum subsystem and
+ * is kept here as the baseline. On the host `crc16Le`/`crc32Le` are the
+ * table fallbacks, not the ROM, so every backend is first checked against
+ * the catalogued check value of its algorithm (the CRC of `"123456789"`),
+ * which is what the ROM functions return.
+ */
+
+static const uint64_t BENCH_MIN_RUN_NS = 100ULL * 1000ULL * 1000ULL;
+static const size_t SAVE_BYTES = 99;
+static const size_t LOG_BYTES = 4096;
+
+static uint8_t gBuffer[LOG_BYTES];
+static volatile uint32_t gSink;
+
+static uint16_t crc16ModbusBitwise(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; ++b) {
+      if (crc & 1)
+        crc = (crc >> 1) ^ 0xA001;
+      else
+        crc >>= 1;
+    }
+  }
+  return crc;
+}
+
+static uint32_t runBitwise(const uint8_t *data, size_t len) {
+  return crc16ModbusBitwise(data, len);
+}
+static uint32_t runModbus(const uint8_t *data, size_t len) {
+  return crc16Modbus(data, len);
+}
+static uint32_t runCrc16Le(const uint8_t *data, size_t len) {
+  return crc16Le(0, data, len);
+}
+static uint32_t runCrc32Le(const uint8_t *data, size_t len) {
+  return crc32Le(0, data, len);
+}
+
+struct CrcCase {
+  const char *name;
+  uint32_t (*fn)(const uint8_t *, size_t);
+  /** @brief CRC of `"123456789"` for the algorithm. */
+  uint32_t check;
+};
+
+static const CrcCase kCases[] = {
+    {"crc16 bitwise", runBitwise, 0x4B37},
+    {"crc16 modbus", runModbus, 0x4B37},
+    {"crc16_le", runCrc16Le, 0x906E},
+    {"crc32_le", runCrc32Le, 0xCBF43926},
+};
+
+/** Known answers, plus the ROM chaining convention on a split buffer. */
+static int checkKnownAnswers() {
+  static const char kInput[] = "123456789";
+  const uint8_t *data = reinterpret_cast<const uint8_t *>(kInput);
+  const size_t len = strlen(kInput);
+  int wrong = 0;
+  for (const CrcCase &c : kCases) {
+    const uint32_t got = c.fn(data, len);
+    if (got != c.check) {
+      printf("%s(\"123456789\") = 0x%08lX, want 0x%08lX\n", c.name,
+             (unsigned long)got, (unsigned long)c.check);
+      ++wrong;
+    }
+  }
+  if (crc16Le(crc16Le(0, data, 4), data + 4, len - 4) != 0x906E ||
+      crc32Le(crc32Le(0, data, 4), data + 4, len - 4) != 0xCBF43926) {
+    printf("crc16_le/crc32_le do not chain like the ROM\n");
+    ++wrong;
+  }
+  return wrong;
+}
+
+static void benchCase(const CrcCase &c, size_t len) {
+  uint32_t runs = 0;
+  uint32_t acc = 0;
+  uint64_t start = benchNowNs();
+  uint64_t elapsed = 0;
+  do {
+    acc += c.fn(gBuffer, len);
+    ++runs;
+    elapsed = benchNowNs() - start;
+  } while (elapsed < BENCH_MIN_RUN_NS);
+  gSink = acc;
+
+  double ns = (double)elapsed / runs;
+  printf("%-14s %5lu B  %10.1f ns  %8.1f MB/s\n", c.name, (unsigned long)len,
+         ns, (double)len * 1e3 / ns);
+}
+
+/** @copydoc runChecksumBench */
+void runChecksumBench() {
+  for (size_t i = 0; i < LOG_BYTES; ++i) {
+    gBuffer[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+  if (crc16Modbus(gBuffer, LOG_BYTES) != crc16ModbusBitwise(gBuffer, LOG_BYTES)) {
+    printf("crc16 modbus table disagrees with bitwise reference\n");
+    benchFail(1);
+  }
+  const int wrong = checkKnownAnswers();
+  printf("check values: %d wrong\n", wrong);
+  benchFail(wrong);
+
+  printf("rom: %s\n", checksumUsesRom() ? "yes" : "no (table fallback)");
+  for (const CrcCase &c : kCases) benchCase(c, SAVE_BYTES);
+  for (const CrcCase &c : kCases) benchCase(c, LOG_BYTES);
+}
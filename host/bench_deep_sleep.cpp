@@ -0,0 +1,186 @@
+#include "bench.h"
+#include "sim.h"
+#include "wake.h"
+
+#include <stdio.h>
+
+/**
+ * @file bench_deep_sleep.cpp
+ * @brief A week of deep sleep planned by `wakeDeepSleepUntil()`.
+ *
+ * The real simulation runs from a fresh egg. Whenever the policy allows it
+ * the device "sleeps" until the planned epoch; the bench still steps those
+ * minutes one by one and checks that nothing the Home screen shows changed
+ * before the wake (a missed event). The tended run has someone fix every
+ * alert the panel shows after a wake, which costs a press and an idle
+ * period awake.
+ *
+ * The battery estimate multiplies the counted time by assumed currents, not
+ * measured ones; it compares the plans, not the hardware.
+ */
+
+static const uint32_t BENCH_START_EPOCH = 1767225600UL; // 2026-01-01 00:00 UTC
+static const uint32_t BENCH_DAYS = 7;
+static const int TIMING_CALLS = 1000000;
+
+// Assumptions for the estimate.
+static const double BATTERY_MAH = 390.0;
+/** @brief Average draw while light-sleeping between minute ticks. */
+static const double LIGHT_SLEEP_MA = 1.5;
+/** @brief Whole-board draw in deep sleep. */
+static const double DEEP_SLEEP_MA = 0.05;
+/** @brief Boot, catch-up and one panel refresh, per deep sleep wake. */
+static const double WAKE_MAS = 70.0;
+
+/** @brief What the Home screen shows, short of the stat bars and mood. */
+struct HomeLook {
+  uint8_t alerts;
+  bool asleep;
+  bool tantrum;
+  bool sick;
+  uint8_t stage;
+  uint8_t poop;
+  uint16_t careMistakes;
+  uint32_t days;
+};
+
+static HomeLook homeLook() {
+  HomeLook look;
+  look.alerts = gAlerts.mask;
+  look.asleep = gState.asleep;
+  look.tantrum = gState.tantrumUntilEpoch != 0;
+  look.sick = gState.sick;
+  look.stage = gState.stage;
+  look.poop = gState.poop;
+  look.careMistakes = gState.careMistakes;
+  look.days = gState.ageMinutes / (24 * 60);
+  return look;
+}
+
+static bool sameLook(const HomeLook &a, const HomeLook &b) {
+  return a.alerts == b.alerts && a.asleep == b.asleep &&
+         a.tantrum == b.tantrum && a.sick == b.sick && a.stage == b.stage &&
+         a.poop == b.poop && a.careMistakes == b.careMistakes &&
+         a.days == b.days;
+}
+
+static void stepMinute() {
+  simulateMinutes(gState.lastEpoch, 1);
+  gState.lastEpoch += SECONDS_PER_MINUTE;
+}
+
+/** Fix whatever the alerts ask for, as a player with the device would. */
+static void tend() {
+  const uint8_t mask = gAlerts.mask;
+  if (mask & (1U << ATTN_HUNGER)) gState.hunger = 80;
+  if (mask & (1U << ATTN_HAPPINESS)) gState.happiness = 80;
+  if (mask & (1U << ATTN_POOP)) gState.poop = 0;
+  if (mask & (1U << ATTN_SICK)) gState.sick = false;
+  if (mask & (1U << ATTN_LIGHTS)) gState.lightsOn = false;
+  if (mask & (1U << ATTN_TANTRUM)) resolveTantrum(gState.lastEpoch);
+  syncAlerts();
+}
+
+/** @brief Counters of one run. */
+struct DeepSleepRun {
+  uint32_t sleeps;
+  uint32_t sleptMinutes;
+  uint32_t awakeMinutes;
+  uint32_t presses;
+  /** @brief Wakes that found the screen unchanged (the length cap). */
+  uint32_t quietWakes;
+  /** @brief Sleeps that slept through a change. */
+  uint32_t missed;
+};
+
+static DeepSleepRun runWeek(bool tended) {
+  DeepSleepRun r = {};
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  syncAlerts();
+  const uint32_t endEpoch = BENCH_START_EPOCH + BENCH_DAYS * 24 * 60 * 60;
+  uint32_t idleMs = WAKE_DEEP_IDLE_MS;
+
+  while (gState.lastEpoch < endEpoch) {
+    if (tended && gAlerts.mask != 0) {
+      tend();
+      ++r.presses;
+      idleMs = 0;
+    }
+
+    DeepSleepInputs in;
+    in.nowEpoch = gState.lastEpoch;
+    in.idleMs = idleMs;
+    in.home = true;
+    in.nextEventEpoch = simNextEventEpoch(gState, WAKE_DEEP_MAX_MINUTES);
+    const uint32_t wakeEpoch = wakeDeepSleepUntil(in);
+    if (wakeEpoch == 0) {
+      stepMinute();
+      ++r.awakeMinutes;
+      idleMs += SECONDS_PER_MINUTE * 1000;
+      continue;
+    }
+
+    const HomeLook before = homeLook();
+    const uint32_t minutes = (wakeEpoch - gState.lastEpoch) / SECONDS_PER_MINUTE;
+    bool missed = false;
+    for (uint32_t m = 1; m <= minutes; ++m) {
+      stepMinute();
+      if (m < minutes && !sameLook(before, homeLook())) missed = true;
+    }
+    if (missed) ++r.missed;
+    if (sameLook(before, homeLook())) ++r.quietWakes;
+    ++r.sleeps;
+    r.sleptMinutes += minutes;
+  }
+  return r;
+}
+
+/** Days a full battery lasts at the run's daily charge. */
+static double batteryDays(const DeepSleepRun &r) {
+  const double mAsPerDay =
+      ((double)r.awakeMinutes * 60.0 * LIGHT_SLEEP_MA +
+       (double)r.sleptMinutes * 60.0 * DEEP_SLEEP_MA + r.sleeps * WAKE_MAS) /
+      BENCH_DAYS;
+  return BATTERY_MAH * 3600.0 / mAsPerDay;
+}
+
+/** @copydoc runDeepSleepBench */
+void runDeepSleepBench() {
+  printf("%-16s %7s %8s %12s %8s %7s %6s %7s %9s\n", "7 days", "sleeps",
+         "per day", "avg sleep m", "awake m", "presses", "quiet", "missed",
+         "est days");
+  printf("%-16s %7s %8s %12s %8u %7s %6s %7s %9.1f\n", "light sleep only",
+         "-", "-", "-", BENCH_DAYS * 24 * 60, "-", "-", "-",
+         BATTERY_MAH / (LIGHT_SLEEP_MA * 24.0));
+  for (int tended = 0; tended <= 1; ++tended) {
+    const DeepSleepRun r = runWeek(tended != 0);
+    printf("%-16s %7lu %8.1f %12.1f %8lu %7lu %6lu %7lu %9.1f\n",
+           tended ? "tended" : "neglected", (unsigned long)r.sleeps,
+           (double)r.sleeps / BENCH_DAYS,
+           r.sleeps ? (double)r.sleptMinutes / r.sleeps : 0.0,
+           (unsigned long)r.awakeMinutes, (unsigned long)r.presses,
+           (unsigned long)r.quietWakes, (unsigned long)r.missed,
+           batteryDays(r));
+    benchFail((int)r.missed);
+  }
+  printf("assumed: %.0f mAh, light sleep %.1f mA, deep sleep %.2f mA, "
+         "%.0f mAs per wake\n",
+         BATTERY_MAH, LIGHT_SLEEP_MA, DEEP_SLEEP_MA, WAKE_MAS);
+
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  stepMinute();
+  DeepSleepInputs in;
+  in.idleMs = WAKE_DEEP_IDLE_MS;
+  in.home = true;
+  volatile uint32_t sink = 0;
+  const uint64_t start = benchNowNs();
+  for (int i = 0; i < TIMING_CALLS; ++i) {
+    in.nowEpoch = gState.lastEpoch + (i & 63);
+    in.nextEventEpoch = simNextEventEpoch(gState, WAKE_DEEP_MAX_MINUTES);
+    sink = sink + wakeDeepSleepUntil(in);
+  }
+  printf("simNextEventEpoch + wakeDeepSleepUntil %.1f ns/call\n",
+         (double)(benchNowNs() - start) / TIMING_CALLS);
+}
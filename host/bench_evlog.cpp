@@ -0,0 +1,166 @@
+#include "bench.h"
+#include "event_log.h"
+
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+/**
+ * @file bench_evlog.cpp
+ * @brief Event log against a RAM model of NOR flash.
+ *
+ * The model behaves like the real thing where it matters: erase sets a whole
+ * sector to `0xFF` and programming can only clear bits. A few flushes are torn
+ * part-way through and followed by a remount, like a brownout and a reboot.
+ * Whatever the log reads back must be exactly the newest records that were
+ * flushed successfully.
+ */
+
+static const uint32_t BENCH_START_EPOCH = 1767225600UL; // 2026-01-01 00:00 UTC
+static const uint32_t FLASH_SECTOR_BYTES = 4096;
+static const uint32_t FLASH_SECTORS = 16;
+static const int EVENT_ROUNDS = 200000;
+/** @brief Records between flushes, like a handful of events per save. */
+static const int EVENTS_PER_FLUSH = 6;
+
+/** @brief RAM NOR flash with an optional torn write. */
+struct RamFlash {
+  std::vector<uint8_t> bytes;
+  /** @brief Bytes of the next write that land before "power loss"; -1 = all. */
+  long tearAt;
+  /** @brief Writes that tried to turn a 0 bit back into 1. */
+  uint32_t bitViolations;
+};
+
+static bool ramRead(void *ctx, uint32_t offset, void *dst, size_t len) {
+  RamFlash *flash = static_cast<RamFlash *>(ctx);
+  if (offset + len > flash->bytes.size()) return false;
+  memcpy(dst, &flash->bytes[offset], len);
+  return true;
+}
+
+static bool ramWrite(void *ctx, uint32_t offset, const void *src, size_t len) {
+  RamFlash *flash = static_cast<RamFlash *>(ctx);
+  if (offset + len > flash->bytes.size()) return false;
+  size_t n = len;
+  bool torn = flash->tearAt >= 0 && (size_t)flash->tearAt < len;
+  if (torn) n = (size_t)flash->tearAt;
+  flash->tearAt = -1;
+
+  const uint8_t *in = static_cast<const uint8_t *>(src);
+  for (size_t i = 0; i < n; ++i) {
+    uint8_t &cell = flash->bytes[offset + i];
+    if ((in[i] & ~cell) != 0) ++flash->bitViolations;
+    cell &= in[i];
+  }
+  return !torn;
+}
+
+static bool ramErase(void *ctx, uint32_t sector) {
+  RamFlash *flash = static_cast<RamFlash *>(ctx);
+  if ((sector + 1) * FLASH_SECTOR_BYTES > flash->bytes.size()) return false;
+  memset(&flash->bytes[sector * FLASH_SECTOR_BYTES], 0xFF, FLASH_SECTOR_BYTES);
+  return true;
+}
+
+static bool sameRecord(const EventRecord &a, const EventRecord &b) {
+  return a.type == b.type && a.epoch == b.epoch && a.value == b.value;
+}
+
+/** @copydoc runEvlogBench */
+void runEvlogBench() {
+  RamFlash ram;
+  ram.bytes.assign(FLASH_SECTOR_BYTES * FLASH_SECTORS, 0xFF);
+  ram.tearAt = -1;
+  ram.bitViolations = 0;
+  EventLogFlash flash = {FLASH_SECTOR_BYTES, FLASH_SECTORS, ramRead, ramWrite,
+                         ramErase, &ram};
+
+  gEventLogStats = EventLogStats();
+  if (!eventLogMount(&flash)) {
+    printf("mount failed\n");
+    return;
+  }
+
+  std::mt19937 rng(4321);
+  std::vector<EventRecord> committed;
+  std::vector<EventRecord> pending;
+  uint32_t epoch = BENCH_START_EPOCH;
+  uint32_t torn = 0;
+  uint64_t appendNs = 0;
+  uint64_t flushNs = 0;
+
+  for (int i = 0; i < EVENT_ROUNDS; ++i) {
+    epoch += 60 * (rng() % 240);
+    EventRecord rec;
+    rec.type = static_cast<uint8_t>(EVENT_CARE_MISTAKE + rng() % EVENT_RESET);
+    rec.epoch = epoch;
+    rec.value = rng() % 8;
+
+    uint64_t t0 = benchNowNs();
+    eventLogAppend(static_cast<EventType>(rec.type), rec.epoch, rec.value);
+    appendNs += benchNowNs() - t0;
+    pending.push_back(rec);
+
+    if ((i + 1) % EVENTS_PER_FLUSH != 0) continue;
+
+    bool tear = rng() % 500 == 0;
+    if (tear) {
+      ram.tearAt = (long)(rng() % 32);
+      ++torn;
+    }
+    t0 = benchNowNs();
+    bool ok = eventLogFlush();
+    flushNs += benchNowNs() - t0;
+    if (ok) {
+      committed.insert(committed.end(), pending.begin(), pending.end());
+    }
+    pending.clear();
+    if (tear && !eventLogMount(&flash)) {
+      printf("remount after torn write failed\n");
+      return;
+    }
+  }
+  eventLogFlush();
+  committed.insert(committed.end(), pending.begin(), pending.end());
+
+  // Reboot once more, then stream the whole log back.
+  eventLogMount(&flash);
+  uint64_t t0 = benchNowNs();
+  EventLogReader reader;
+  eventLogReaderBegin(reader);
+  std::vector<EventRecord> readBack;
+  EventRecord rec;
+  while (eventLogReaderNext(reader, rec)) {
+    readBack.push_back(rec);
+  }
+  uint64_t readNs = benchNowNs() - t0;
+
+  size_t mismatches = 0;
+  if (readBack.size() > committed.size()) {
+    mismatches = readBack.size();
+  } else {
+    size_t skip = committed.size() - readBack.size();
+    for (size_t k = 0; k < readBack.size(); ++k) {
+      if (!sameRecord(readBack[k], committed[skip + k])) ++mismatches;
+    }
+  }
+
+  const EventLogStats &stats = gEventLogStats;
+  printf("events %d  chunks %lu  erases %lu  (%lu x %lu B sectors)\n",
+         EVENT_ROUNDS, (unsigned long)stats.chunks,
+         (unsigned long)stats.sectorErases, (unsigned long)FLASH_SECTORS,
+         (unsigned long)FLASH_SECTOR_BYTES);
+  printf("%.2f flash bytes/event  append %.1f ns  flush %.1f us\n",
+         (double)stats.bytesWritten / stats.appended,
+         (double)appendNs / EVENT_ROUNDS,
+         (double)flushNs / (EVENT_ROUNDS / EVENTS_PER_FLUSH) / 1e3);
+  printf("torn %lu  dropped %lu  bit violations %lu\n", (unsigned long)torn,
+         (unsigned long)stats.dropped, (unsigned long)ram.bitViolations);
+  printf("retained %zu newest events  mismatches %zu  read %.1f us\n",
+         readBack.size(), mismatches, (double)readNs / 1e3);
+  benchFail((int)mismatches + (int)ram.bitViolations);
+
+  eventLogMount(nullptr);
+}
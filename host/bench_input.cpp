@@ -0,0 +1,402 @@
+#include "bench.h"
+#include "input.h"
+#include "logic.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+/**
+ * @file bench_input.cpp
+ * @brief The button pipeline on scripted raw edges, contact bounce included,
+ * plus the edge queue under a real second thread.
+ *
+ * Each case feeds raw edges (every bounce is one) through the debounce, the
+ * queue and the gesture recognizer the way the interrupt and the loop do,
+ * and compares the events with what a person meant. Each raw edge carries the
+ * level the interrupt reads with it, so spurious edges and mid-bounce reads
+ * can be scripted. The stalled case queues a burst of taps while the
+ * consumer is blocked, like during a panel push.
+ * The dispatch cases go on into `handleInputEvents()` and check the screen
+ * and list positions a tap or a hold leaves behind. The stress run pushes
+ * edges from one thread and pops them on another; any edge lost or out of
+ * order is reported.
+ */
+
+static const uint32_t MS = 1000;
+static const uint32_t STRESS_EDGES = 1000000;
+
+/** @brief One raw edge: a pin changed at `timeUs`. */
+struct RawEdge {
+  uint32_t timeUs;
+  InputButton button;
+  /** @brief Level the interrupt reads right after the edge. */
+  bool down;
+};
+
+/** @brief An expected event, without its timestamp. */
+struct Expected {
+  InputEventKind kind;
+  InputButton button;
+};
+
+/** @brief A scripted case. */
+struct InputCase {
+  const char *name;
+  RawEdge raw[128];
+  uint8_t rawCount;
+  Expected expected[24];
+  uint8_t expectedCount;
+  /** @brief Loop polls at this time (after all edges); 0 = never. */
+  uint32_t pollUs;
+};
+
+/** Raw edges of a bouncy press at `t`: down, three bounces. */
+static uint8_t bouncyPress(RawEdge *out, InputButton b, uint32_t t) {
+  const uint32_t offsets[] = {0, 300, 900, 1500};
+  const bool levels[] = {true, false, true, true};
+  for (uint8_t i = 0; i < 4; ++i) out[i] = {t + offsets[i], b, levels[i]};
+  return 4;
+}
+
+/** Raw edges of a bouncy release at `t`: up, one bounce. */
+static uint8_t bouncyRelease(RawEdge *out, InputButton b, uint32_t t) {
+  out[0] = {t, b, false};
+  out[1] = {t + 400, b, false};
+  return 2;
+}
+
+/** Add a bouncy tap of `b` from `downUs` to `upUs`. */
+static void tap(InputCase &c, InputButton b, uint32_t downUs, uint32_t upUs) {
+  c.rawCount += bouncyPress(c.raw + c.rawCount, b, downUs);
+  c.rawCount += bouncyRelease(c.raw + c.rawCount, b, upUs);
+}
+
+static void expect(InputCase &c, InputEventKind kind, InputButton b) {
+  c.expected[c.expectedCount++] = {kind, b};
+}
+
+static void sortRaw(InputCase &c) {
+  for (uint8_t i = 1; i < c.rawCount; ++i) {
+    for (uint8_t j = i; j > 0 && c.raw[j].timeUs < c.raw[j - 1].timeUs; --j) {
+      RawEdge t = c.raw[j];
+      c.raw[j] = c.raw[j - 1];
+      c.raw[j - 1] = t;
+    }
+  }
+}
+
+/**
+ * Feed one case through the pipeline the way the input task does; `stalled`
+ * delays all consuming until the last raw edge.
+ * @return Number of events written to `got` (at most 64).
+ */
+static uint8_t collectEvents(InputCase &c, bool stalled, InputEvent got[64],
+                             uint32_t &dropped) {
+  sortRaw(c);
+  InputDebounce debounce;
+  inputDebounceReset(debounce, 0, 0);
+  InputQueue queue;
+  memset(&queue, 0, sizeof(queue));
+  InputGestures gestures;
+  memset(&gestures, 0, sizeof(gestures));
+  gestures.deferMask = LOGIC_LONG_PRESS_BUTTONS;
+
+  uint8_t gotCount = 0;
+  InputEvent events[INPUT_EVENTS_PER_EDGE];
+  InputEdge edge;
+  bool level[INPUT_BUTTON_COUNT] = {};
+  for (uint8_t i = 0; i < c.rawCount; ++i) {
+    level[c.raw[i].button] = c.raw[i].down;
+    // Raw times start at 100 ms so the first edge is past the debounce.
+    if (inputDebounceEdge(debounce, c.raw[i].button, c.raw[i].down,
+                          c.raw[i].timeUs + 100 * MS, edge)) {
+      inputQueuePush(queue, edge);
+    }
+    if (stalled) continue;
+    while (inputQueuePop(queue, edge)) {
+      uint8_t n = inputGesturesFeed(gestures, edge, events);
+      for (uint8_t k = 0; k < n && gotCount < 64; ++k) got[gotCount++] = events[k];
+    }
+  }
+  // The consumer re-reads the levels once the last edge has settled.
+  const uint32_t settleUs =
+      (c.rawCount ? c.raw[c.rawCount - 1].timeUs : 0) + INPUT_DEBOUNCE_US;
+  for (uint8_t b = 0; b < INPUT_BUTTON_COUNT; ++b) {
+    if (inputDebounceSync(debounce, static_cast<InputButton>(b), level[b],
+                          settleUs + 100 * MS, edge)) {
+      inputQueuePush(queue, edge);
+    }
+  }
+  while (inputQueuePop(queue, edge)) {
+    uint8_t n = inputGesturesFeed(gestures, edge, events);
+    for (uint8_t k = 0; k < n && gotCount < 64; ++k) got[gotCount++] = events[k];
+  }
+  if (c.pollUs) {
+    uint8_t n = inputGesturesPoll(gestures, c.pollUs + 100 * MS, events);
+    for (uint8_t k = 0; k < n && gotCount < 64; ++k) got[gotCount++] = events[k];
+  }
+  dropped = queue.dropped;
+  return gotCount;
+}
+
+/** Run one case and compare its events with the expected ones. */
+static int runCase(InputCase &c, bool stalled, uint32_t &dropped) {
+  InputEvent got[64];
+  const uint8_t gotCount = collectEvents(c, stalled, got, dropped);
+
+  int mismatches = gotCount == c.expectedCount ? 0 : 1;
+  for (uint8_t i = 0; i < gotCount && i < c.expectedCount; ++i) {
+    if (got[i].kind != c.expected[i].kind ||
+        got[i].button != c.expected[i].button) {
+      ++mismatches;
+    }
+  }
+  return mismatches;
+}
+
+/** @brief A gesture on a screen, through to what `logic.cpp` makes of it. */
+struct DispatchCase {
+  const char *name;
+  Screen screen;
+  InputButton button;
+  /** @brief How long the button is held. */
+  uint32_t holdUs;
+  /** @brief Screen and list positions expected afterwards. */
+  Screen expectScreen;
+  uint8_t expectMenu;
+  uint8_t expectItem;
+};
+
+/** Edges to events to `handleInputEvents()`, as the input and game tasks run them. */
+static int runDispatch(const DispatchCase &d) {
+  defaultState();
+  memset(&gRun, 0, sizeof(gRun));
+  gRun.screen = d.screen;
+  gRun.menuIndex = 3;
+  gRun.inventoryIndex = 2;
+
+  InputCase c;
+  memset(&c, 0, sizeof(c));
+  tap(c, d.button, 0, d.holdUs);
+  InputEvent got[64];
+  uint32_t dropped = 0;
+  uint8_t count = collectEvents(c, false, got, dropped);
+  handleInputEvents(got, count);
+
+  return gRun.screen == d.expectScreen && gRun.menuIndex == d.expectMenu &&
+                 gRun.inventoryIndex == d.expectItem
+             ? 0
+             : 1;
+}
+
+/**
+ * A pressed before the mini-game deadline and let go after it. The game
+ * loop sees the deadline pass while the press is still held back, then the
+ * release brings the press, dated to when A went down.
+ * @return 0 when the round is scored as a hit.
+ */
+static int runMiniGameHold() {
+  defaultState();
+  memset(&gRun, 0, sizeof(gRun));
+  gRun.screen = SCREEN_MINIGAME;
+  gRun.mgActive = true;
+  gRun.mgTarget = INPUT_BUTTON_A;
+  const uint16_t coins = gState.coins;
+
+  InputCase c;
+  memset(&c, 0, sizeof(c));
+  tap(c, INPUT_BUTTON_A, 0, 300 * MS);
+  InputEvent got[64];
+  uint32_t dropped = 0;
+  uint8_t count = collectEvents(c, false, got, dropped);
+  // Down 300 ms ago, up just now; the deadline fell in between. Host time
+  // starts at its first read, so wait until 300 ms ago exists.
+  if (millis() < 400) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(400 - millis()));
+  }
+  const uint32_t nowUs = micros();
+  for (uint8_t i = 0; i < count; ++i) got[i].timeUs = nowUs - 300 * MS;
+  gRun.mgDeadlineMs = millis() - 100;
+  handleMiniGameTimeout(true);
+  handleInputEvents(got, count);
+
+  return !gRun.mgActive && gState.coins == coins + 5 ? 0 : 1;
+}
+
+/** Consumer thread half of the stress run. */
+static void stressConsumer(InputQueue *q, uint32_t *lost, uint32_t *reordered) {
+  uint32_t expected = 0;
+  InputEdge edge;
+  while (expected < STRESS_EDGES) {
+    if (!inputQueuePop(*q, edge)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (edge.timeUs != expected) {
+      if (edge.timeUs > expected) {
+        *lost += edge.timeUs - expected;
+      } else {
+        ++*reordered;
+      }
+    }
+    expected = edge.timeUs + 1;
+  }
+}
+
+/** @copydoc runInputBench */
+void runInputBench() {
+  static InputCase cases[11];
+  memset(cases, 0, sizeof(cases));
+  uint8_t n = 0;
+
+  InputCase &clean = cases[n++];
+  clean.name = "bouncy tap";
+  tap(clean, INPUT_BUTTON_A, 0, 80 * MS);
+  expect(clean, INPUT_PRESS, INPUT_BUTTON_A);
+
+  InputCase &order = cases[n++];
+  order.name = "A B C in 60 ms";
+  tap(order, INPUT_BUTTON_A, 0, 25 * MS);
+  tap(order, INPUT_BUTTON_B, 30 * MS, 55 * MS);
+  tap(order, INPUT_BUTTON_C, 60 * MS, 85 * MS);
+  expect(order, INPUT_PRESS, INPUT_BUTTON_A);
+  expect(order, INPUT_PRESS, INPUT_BUTTON_B);
+  expect(order, INPUT_PRESS, INPUT_BUTTON_C);
+
+  InputCase &hold = cases[n++];
+  hold.name = "long press";
+  tap(hold, INPUT_BUTTON_C, 0, 1200 * MS);
+  expect(hold, INPUT_LONG_PRESS, INPUT_BUTTON_C);
+
+  InputCase &held = cases[n++];
+  held.name = "still held";
+  held.rawCount = bouncyPress(held.raw, INPUT_BUTTON_A, 0);
+  held.pollUs = 900 * MS;
+  expect(held, INPUT_LONG_PRESS, INPUT_BUTTON_A);
+
+  InputCase &twice = cases[n++];
+  twice.name = "double press";
+  tap(twice, INPUT_BUTTON_TOP, 0, 70 * MS);
+  tap(twice, INPUT_BUTTON_TOP, 250 * MS, 320 * MS);
+  tap(twice, INPUT_BUTTON_TOP, 500 * MS, 570 * MS);
+  tap(twice, INPUT_BUTTON_TOP, 1400 * MS, 1470 * MS);
+  expect(twice, INPUT_PRESS, INPUT_BUTTON_TOP);
+  expect(twice, INPUT_PRESS, INPUT_BUTTON_TOP);
+  expect(twice, INPUT_DOUBLE_PRESS, INPUT_BUTTON_TOP);
+  expect(twice, INPUT_PRESS, INPUT_BUTTON_TOP);
+  expect(twice, INPUT_PRESS, INPUT_BUTTON_TOP);
+
+  InputCase &chord = cases[n++];
+  chord.name = "chord";
+  tap(chord, INPUT_BUTTON_TOP, 0, 200 * MS);
+  tap(chord, INPUT_BUTTON_SIDE, 60 * MS, 210 * MS);
+  expect(chord, INPUT_PRESS, INPUT_BUTTON_TOP);
+  expect(chord, INPUT_CHORD, INPUT_BUTTON_SIDE);
+
+  // A's press waits for the release, unless another button joins first.
+  InputCase &joined = cases[n++];
+  joined.name = "A held, B joins";
+  tap(joined, INPUT_BUTTON_A, 0, 200 * MS);
+  tap(joined, INPUT_BUTTON_B, 60 * MS, 210 * MS);
+  expect(joined, INPUT_PRESS, INPUT_BUTTON_A);
+  expect(joined, INPUT_CHORD, INPUT_BUTTON_B);
+
+  // ADC1 reads fire edges on GPIO 39 without the level changing.
+  InputCase &glitch = cases[n++];
+  glitch.name = "C ADC glitches";
+  glitch.raw[glitch.rawCount++] = {0, INPUT_BUTTON_C, false};
+  tap(glitch, INPUT_BUTTON_C, 100 * MS, 400 * MS);
+  glitch.raw[glitch.rawCount++] = {250 * MS, INPUT_BUTTON_C, true};
+  glitch.raw[glitch.rawCount++] = {900 * MS, INPUT_BUTTON_C, false};
+  expect(glitch, INPUT_PRESS, INPUT_BUTTON_C);
+
+  InputCase &misread = cases[n++];
+  misread.name = "read mid-bounce";
+  misread.raw[misread.rawCount++] = {0, INPUT_BUTTON_B, false};
+  misread.raw[misread.rawCount++] = {300, INPUT_BUTTON_B, true};
+  misread.raw[misread.rawCount++] = {900, INPUT_BUTTON_B, true};
+  expect(misread, INPUT_PRESS, INPUT_BUTTON_B);
+
+  printf("%-20s %6s %6s %10s %8s\n", "case", "raw", "events", "mismatches",
+         "dropped");
+  int total = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    uint32_t dropped = 0;
+    int mismatches = runCase(cases[i], false, dropped);
+    total += mismatches;
+    printf("%-20s %6u %6u %10d %8lu\n", cases[i].name, cases[i].rawCount,
+           cases[i].expectedCount, mismatches, (unsigned long)dropped);
+  }
+
+  // Twenty taps while the loop is stuck in a 3 s panel push.
+  InputCase &stall = cases[n++];
+  stall.name = "20 taps, stalled";
+  static const InputButton kCycle[] = {INPUT_BUTTON_A, INPUT_BUTTON_B,
+                                       INPUT_BUTTON_C};
+  for (uint8_t i = 0; i < 20; ++i) {
+    const uint32_t t = i * 150 * MS;
+    tap(stall, kCycle[i % 3], t, t + 60 * MS);
+    expect(stall, INPUT_PRESS, kCycle[i % 3]);
+  }
+  uint32_t dropped = 0;
+  int mismatches = runCase(stall, true, dropped);
+  total += mismatches;
+  printf("%-20s %6u %6u %10d %8lu\n", stall.name, stall.rawCount,
+         stall.expectedCount, mismatches, (unsigned long)dropped);
+
+  // The whole path into the dispatcher.
+  const DispatchCase kDispatch[] = {
+      {"hold C on Menu", SCREEN_MENU, INPUT_BUTTON_C, 1200 * MS, SCREEN_MENU,
+       (uint8_t)(kMenuCount - 1), 2},
+      {"hold A on Menu", SCREEN_MENU, INPUT_BUTTON_A, 1200 * MS, SCREEN_MENU, 0,
+       2},
+      {"hold C on Inventory", SCREEN_INVENTORY, INPUT_BUTTON_C, 1200 * MS,
+       SCREEN_INVENTORY, 3, ITEM_COUNT - 1},
+      {"hold A on Inventory", SCREEN_INVENTORY, INPUT_BUTTON_A, 1200 * MS,
+       SCREEN_INVENTORY, 3, 0},
+      {"hold C on Home", SCREEN_HOME, INPUT_BUTTON_C, 1200 * MS, SCREEN_STATUS,
+       3, 2},
+      {"tap A on Menu", SCREEN_MENU, INPUT_BUTTON_A, 80 * MS, SCREEN_HOME, 3, 2},
+      {"tap C on Menu", SCREEN_MENU, INPUT_BUTTON_C, 80 * MS, SCREEN_MENU, 4, 2},
+  };
+  int dispatchMismatches = 0;
+  for (const DispatchCase &d : kDispatch) {
+    const int wrong = runDispatch(d);
+    dispatchMismatches += wrong;
+    printf("%-20s %s\n", d.name, wrong ? "WRONG" : "ok");
+  }
+  const int lateRelease = runMiniGameHold();
+  dispatchMismatches += lateRelease;
+  printf("%-20s %s\n", "A across deadline", lateRelease ? "WRONG" : "ok");
+  total += dispatchMismatches;
+
+  // Time per raw edge through debounce, queue and recognizer.
+  const int rounds = 100000;
+  uint64_t start = benchNowNs();
+  for (int r = 0; r < rounds; ++r) runCase(stall, false, dropped);
+  printf("pipeline %.1f ns/raw edge\n",
+         (double)(benchNowNs() - start) / rounds / stall.rawCount);
+
+  static InputQueue queue;
+  memset(&queue, 0, sizeof(queue));
+  uint32_t lost = 0;
+  uint32_t reordered = 0;
+  start = benchNowNs();
+  std::thread consumer(stressConsumer, &queue, &lost, &reordered);
+  for (uint32_t i = 0; i < STRESS_EDGES; ++i) {
+    InputEdge edge = {i, INPUT_BUTTON_A, (i & 1) == 0};
+    while (!inputQueuePush(queue, edge)) std::this_thread::yield();
+  }
+  consumer.join();
+  printf("threads: %lu edges, %.1f ns/edge, full %lu times, lost %lu, "
+         "reordered %lu\n",
+         (unsigned long)STRESS_EDGES,
+         (double)(benchNowNs() - start) / STRESS_EDGES,
+         (unsigned long)queue.dropped, (unsigned long)lost,
+         (unsigned long)reordered);
+  printf("mismatches %d\n", total);
+  benchFail(total + (int)lost + (int)reordered);
+}
@@ -0,0 +1,69 @@
+#include "bench.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @file bench_main.cpp
+ * @brief Host benchmark entry point.
+ *
+ * Run everything with no arguments, or name the suites you care about. The
+ * exit status is non-zero when any suite reported a failed check, so CI can
+ * run it as a test.
+ */
+
+/** @brief A named benchmark suite. */
+struct BenchSuite {
+  /** @brief Name accepted on the command line. */
+  const char *name;
+  /** @brief Suite body; prints its own results. */
+  void (*run)();
+};
+
+static const BenchSuite kSuites[] = {
+    {"sim", runSimBench},
+    {"save", runSaveBench},
+    {"checksum", runChecksumBench},
+    {"slots", runSlotsBench},
+    {"evlog", runEvlogBench},
+    {"render", runRenderBench},
+    {"trace", runTraceBench},
+    {"wake", runWakeBench},
+    {"input", runInputBench},
+    {"snapshot", runSnapshotBench},
+    {"deepsleep", runDeepSleepBench},
+};
+
+/** @copydoc benchNowNs */
+uint64_t benchNowNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static int gFailures = 0;
+
+/** @copydoc benchFail */
+void benchFail(int count) { gFailures += count; }
+
+static bool suiteSelected(const char *name, int argc, char **argv) {
+  if (argc <= 1) return true;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], name) == 0) return true;
+  }
+  return false;
+}
+
+int main(int argc, char **argv) {
+  for (const BenchSuite &suite : kSuites) {
+    if (!suiteSelected(suite.name, argc, argv)) continue;
+    printf("== %s ==\n", suite.name);
+    suite.run();
+  }
+  if (gFailures > 0) {
+    printf("FAILED: %d checks\n", gFailures);
+    return 1;
+  }
+  return 0;
+}
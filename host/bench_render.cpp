@@ -0,0 +1,221 @@
+#include "bench.h"
+#include "ui.h"
+#include "ui_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file bench_render.cpp
+ * @brief Every screen rendered headless, timed, and checked against golden
+ * frames.
+ *
+ * A fixed pet is shown on each screen in turn. Per screen it reports the draw
+ * calls and time of switching to it (cold: chrome drawn, warm: chrome copied
+ * from the cache) and of a one-minute clock tick, and compares the frame with
+ * `<golden dir>/<screen>.pbm`.
+ *
+ * Environment:
+ * - `TAMA_GOLDEN_DIR`: golden frames (default `host/golden` in the source
+ *   tree, wherever the bench runs from).
+ * - `TAMA_GOLDEN_UPDATE=1`: write the frames as the new goldens instead.
+ * - `TAMA_FRAME_DIR`: also dump every frame there, to look at.
+ */
+
+static const uint32_t BENCH_START_EPOCH = 1767270840UL; // 2026-01-01 12:34 UTC
+static const int WARM_ROUNDS = 200;
+static const int FRAME_BYTES = SCREEN_W / 8 * SCREEN_H;
+
+/** @brief A screen and the file name of its frames. */
+struct RenderScreen {
+  Screen screen;
+  const char *name;
+};
+
+static const RenderScreen kScreens[] = {
+    {SCREEN_HOME, "home"},
+    {SCREEN_MENU, "menu"},
+    {SCREEN_STATUS, "status"},
+    {SCREEN_INVENTORY, "inventory"},
+    {SCREEN_MINIGAME, "minigame"},
+    {SCREEN_HELP, "help"},
+    {SCREEN_RESET_CONFIRM, "reset_confirm"},
+    {SCREEN_MESSAGE, "message"},
+};
+
+/** A pet on day 3 with a bit of everything to draw. */
+static void loadFixture() {
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  gState.ageMinutes = 3 * 24 * 60 + 75;
+  gState.coins = 120;
+  gState.stage = STAGE_CHILD;
+  gState.hunger = 64;
+  gState.happiness = 80;
+  gState.cleanliness = 35;
+  gState.health = 92;
+  gState.discipline = 50;
+  gState.weight = 12;
+  gState.poop = 1;
+  gState.sick = true;
+  gState.invFood = 2;
+  gState.invSnack = 0;
+  gState.careMistakes = 3;
+  gState.nextTantrumEpoch = BENCH_START_EPOCH + 3 * 3600;
+  gState.tantrumUntilEpoch = 0;
+  syncAlerts();
+  takeAlertChanges();
+
+  memset(&gRun, 0, sizeof(gRun));
+  gRun.menuIndex = 3;
+  gRun.inventoryIndex = ITEM_FOOD;
+  gRun.helpScroll = 2;
+  snprintf(gRun.message, sizeof(gRun.message), "Yum!");
+
+  hostSetClock(BENCH_START_EPOCH);
+  gHostBatteryPercent = 87;
+}
+
+/** Render one frame of `screen`; returns its draw calls, adds its time. */
+static uint32_t renderOnce(Screen screen, uint64_t &ns) {
+  gRun.screen = screen;
+  gRun.dirty = true;
+  uint32_t calls = gSprite.drawCalls;
+  uint64_t start = benchNowNs();
+  renderScreen();
+  ns += benchNowNs() - start;
+  return gSprite.drawCalls - calls;
+}
+
+static bool writePbm(const char *path, const uint8_t *frame) {
+  FILE *f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P4\n%d %d\n", SCREEN_W, SCREEN_H);
+  bool ok = fwrite(frame, 1, FRAME_BYTES, f) == (size_t)FRAME_BYTES;
+  return fclose(f) == 0 && ok;
+}
+
+static bool readPbm(const char *path, uint8_t *frame) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  int w = 0;
+  int h = 0;
+  bool ok = fscanf(f, "P4 %d %d", &w, &h) == 2 && w == SCREEN_W &&
+            h == SCREEN_H && fgetc(f) != EOF &&
+            fread(frame, 1, FRAME_BYTES, f) == (size_t)FRAME_BYTES;
+  fclose(f);
+  return ok;
+}
+
+/**
+ * The checked-in goldens. `TAMA_SOURCE_DIR` comes from the native env;
+ * other builds fall back to the directory this file was compiled from.
+ */
+static void defaultGoldenDir(char *out, size_t size) {
+#ifdef TAMA_SOURCE_DIR
+  snprintf(out, size, "%s/host/golden", TAMA_SOURCE_DIR);
+#else
+  const char *file = __FILE__;
+  const char *slash = strrchr(file, '/');
+  if (slash) {
+    snprintf(out, size, "%.*s/golden", (int)(slash - file), file);
+  } else {
+    snprintf(out, size, "golden");
+  }
+#endif
+}
+
+static int pixelsDiffering(const uint8_t *a, const uint8_t *b) {
+  int count = 0;
+  for (int i = 0; i < FRAME_BYTES; ++i) {
+    count += __builtin_popcount(a[i] ^ b[i]);
+  }
+  return count;
+}
+
+/** @copydoc runRenderBench */
+void runRenderBench() {
+  char defaultDir[256];
+  defaultGoldenDir(defaultDir, sizeof(defaultDir));
+  const char *goldenDir = getenv("TAMA_GOLDEN_DIR");
+  if (!goldenDir) goldenDir = defaultDir;
+  const char *frameDir = getenv("TAMA_FRAME_DIR");
+  const char *update = getenv("TAMA_GOLDEN_UPDATE");
+  const bool updating = update && update[0] == '1';
+
+  gSprite.creatSprite(0, 0, SCREEN_W, SCREEN_H, true);
+  loadFixture();
+
+  printf("%-14s %6s %8s %6s %8s %6s %8s  %s\n", "screen", "cold", "us",
+         "warm", "us", "tick", "us", "golden");
+
+  int mismatches = 0;
+  for (const RenderScreen &s : kScreens) {
+    loadFixture();
+    // Start from another screen so every measurement is a real switch.
+    const Screen away = s.screen == SCREEN_HOME ? SCREEN_MENU : SCREEN_HOME;
+    uint64_t ns = 0;
+    renderOnce(away, ns);
+
+    ns = 0;
+    uint32_t coldBuilds = gRefreshStats.chromeBuilds;
+    uint32_t coldCalls = renderOnce(s.screen, ns);
+    const bool coldBuilt = gRefreshStats.chromeBuilds != coldBuilds;
+    const double coldUs = ns / 1000.0;
+
+    uint8_t frame[FRAME_BYTES];
+    memcpy(frame, gSprite.getSpritePtr(), sizeof(frame));
+    if (memcmp(frame, M5.M5Ink.pixels, sizeof(frame)) != 0) {
+      printf("%s: panel does not show the frame\n", s.name);
+      ++mismatches;
+    }
+
+    char path[512];
+    if (frameDir) {
+      snprintf(path, sizeof(path), "%s/%s.pbm", frameDir, s.name);
+      writePbm(path, frame);
+    }
+    snprintf(path, sizeof(path), "%s/%s.pbm", goldenDir, s.name);
+    char golden[48];
+    uint8_t expected[FRAME_BYTES];
+    if (updating) {
+      snprintf(golden, sizeof(golden), writePbm(path, frame) ? "written" : "WRITE FAILED");
+    } else if (!readPbm(path, expected)) {
+      snprintf(golden, sizeof(golden), "MISSING");
+      ++mismatches;
+    } else if (int diff = pixelsDiffering(frame, expected)) {
+      snprintf(golden, sizeof(golden), "DIFF %d px", diff);
+      ++mismatches;
+    } else {
+      snprintf(golden, sizeof(golden), "ok");
+    }
+
+    uint32_t warmCalls = 0;
+    ns = 0;
+    for (int i = 0; i < WARM_ROUNDS; ++i) {
+      uint64_t awayNs = 0;
+      renderOnce(away, awayNs);
+      warmCalls += renderOnce(s.screen, ns);
+    }
+    const double warmUs = ns / 1000.0 / WARM_ROUNDS;
+
+    uint32_t tickCalls = 0;
+    ns = 0;
+    for (int i = 1; i <= WARM_ROUNDS; ++i) {
+      hostSetClock(BENCH_START_EPOCH + 60 * i);
+      tickCalls += renderOnce(s.screen, ns);
+    }
+    const double tickUs = ns / 1000.0 / WARM_ROUNDS;
+
+    printf("%-14s %6lu %8.1f %6.1f %8.1f %6.1f %8.1f  %s%s\n", s.name,
+           (unsigned long)coldCalls, coldUs, (double)warmCalls / WARM_ROUNDS,
+           warmUs, (double)tickCalls / WARM_ROUNDS, tickUs, golden,
+           coldBuilt ? "" : " (chrome was cached)");
+  }
+
+  printf("golden mismatches %d, stale panel windows %lu\n", mismatches,
+         (unsigned long)M5.M5Ink.staleBefore);
+  benchFail(mismatches);
+  if (M5.M5Ink.staleBefore != 0) benchFail(1);
+}
@@ -0,0 +1,259 @@
+#include "bench.h"
+#include "save_codec.h"
+#include "sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @file bench_save.cpp
+ * @brief Size and speed of the packed save encoding.
+ *
+ * The state is a year-old pet so timers and counters carry realistic values.
+ * Before timing, the suite checks that the pet survives an encode/decode
+ * round trip field by field, that frozen version 2 and 3 blobs still migrate
+ * to known values, and that an out-of-range stage is clamped on load.
+ */
+
+static const uint32_t BENCH_START_EPOCH = 1767225600UL; // 2026-01-01 00:00 UTC
+static const uint64_t BENCH_MIN_RUN_NS = 200ULL * 1000ULL * 1000ULL;
+
+// Raw struct saves as versions 2 and 3 wrote them (little-endian ESP32
+// layout), CRC included. Version 2 stops before the RNG stream.
+static const uint8_t kLegacyV2[124] = {
+    0x41, 0x4D, 0x41, 0x54, 0x02, 0x00, 0xE9, 0x97, 0x00, 0xB9, 0x55, 0x69,
+    0xCA, 0xA8, 0x00, 0x00, 0x41, 0x01, 0x03, 0x40, 0x48, 0x37, 0x5A, 0x58,
+    0x29, 0x25, 0x02, 0x00, 0x01, 0x00, 0x01, 0x04, 0x03, 0x02, 0x01, 0x00,
+    0x11, 0x00, 0x0C, 0x00, 0xE2, 0x04, 0x1E, 0x00, 0x2D, 0x00, 0xF9, 0xFF,
+    0x05, 0x00, 0xFD, 0xFF, 0x09, 0x00, 0xFF, 0xFF, 0x0B, 0x00, 0x02, 0x00,
+    0x20, 0xA3, 0x55, 0x69, 0x10, 0xC7, 0x55, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0xB0, 0xBD, 0x55, 0x69, 0xA8, 0xB6, 0x55, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x50, 0xB4, 0x55, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0xCA, 0x55, 0x69,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+};
+static const uint8_t kLegacyV3[148] = {
+    0x41, 0x4D, 0x41, 0x54, 0x03, 0x00, 0x74, 0x65, 0x00, 0xB9, 0x55, 0x69,
+    0xCA, 0xA8, 0x00, 0x00, 0x41, 0x01, 0x03, 0x40, 0x48, 0x37, 0x5A, 0x58,
+    0x29, 0x25, 0x02, 0x00, 0x01, 0x00, 0x01, 0x04, 0x03, 0x02, 0x01, 0x00,
+    0x11, 0x00, 0x0C, 0x00, 0xE2, 0x04, 0x1E, 0x00, 0x2D, 0x00, 0xF9, 0xFF,
+    0x05, 0x00, 0xFD, 0xFF, 0x09, 0x00, 0xFF, 0xFF, 0x0B, 0x00, 0x02, 0x00,
+    0x20, 0xA3, 0x55, 0x69, 0x10, 0xC7, 0x55, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0xB0, 0xBD, 0x55, 0x69, 0xA8, 0xB6, 0x55, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x50, 0xB4, 0x55, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0xCA, 0x55, 0x69,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x78, 0x56, 0x34, 0x12, 0xF0, 0xDE, 0xBC, 0x9A,
+    0x3C, 0x2D, 0x1E, 0x0F, 0x78, 0x69, 0x5A, 0x4B, 0xC4, 0x09, 0x00, 0x00,
+    0x5A, 0x00, 0x00, 0x00,
+};
+
+/**
+ * `epoch` as the codec stores it: whole minutes from `base`, rounded up onto
+ * the minute grid and limited to what 16 bits of minutes reach.
+ */
+static uint32_t onMinuteGrid(uint32_t epoch, uint32_t base) {
+  if (epoch == 0) return 0;
+  const int64_t diff = (int64_t)epoch - (int64_t)base;
+  int64_t minutes = diff >= 0
+                        ? (diff + SECONDS_PER_MINUTE - 1) / SECONDS_PER_MINUTE
+                        : -(-diff / SECONDS_PER_MINUTE);
+  if (minutes > INT16_MAX) minutes = INT16_MAX;
+  if (minutes < -INT16_MAX) minutes = -INT16_MAX;
+  return (uint32_t)((int64_t)base + minutes * SECONDS_PER_MINUTE);
+}
+
+/** `s` with every timer epoch as a save would bring it back. */
+static PetState onMinuteGrid(const PetState &s) {
+  PetState out = s;
+  const uint32_t base = s.lastEpoch;
+  out.lastMedicineEpoch = onMinuteGrid(s.lastMedicineEpoch, base);
+  out.nextTantrumEpoch = onMinuteGrid(s.nextTantrumEpoch, base);
+  out.tantrumUntilEpoch = onMinuteGrid(s.tantrumUntilEpoch, base);
+  out.tantrumCooldownUntilEpoch =
+      onMinuteGrid(s.tantrumCooldownUntilEpoch, base);
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    out.attentionSinceEpoch[i] = onMinuteGrid(s.attentionSinceEpoch[i], base);
+    out.attentionCooldownUntilEpoch[i] =
+        onMinuteGrid(s.attentionCooldownUntilEpoch[i], base);
+  }
+  return out;
+}
+
+/** Number of fields that differ, each printed with `what`. */
+static int diffFields(const char *what, const PetState &got,
+                      const PetState &want) {
+  int diffs = 0;
+#define SAVE_FIELD(f)                                                        \
+  if (got.f != want.f) {                                                     \
+    printf("%s: " #f " = %ld, want %ld\n", what, (long)got.f, (long)want.f); \
+    ++diffs;                                                                 \
+  }
+  SAVE_FIELD(lastEpoch) SAVE_FIELD(ageMinutes) SAVE_FIELD(coins)
+  SAVE_FIELD(stage) SAVE_FIELD(hunger) SAVE_FIELD(happiness)
+  SAVE_FIELD(cleanliness) SAVE_FIELD(energy) SAVE_FIELD(health)
+  SAVE_FIELD(discipline) SAVE_FIELD(weight) SAVE_FIELD(poop)
+  SAVE_FIELD(asleep) SAVE_FIELD(sick) SAVE_FIELD(lightsOn)
+  SAVE_FIELD(medGuaranteePending) SAVE_FIELD(invFood) SAVE_FIELD(invSnack)
+  SAVE_FIELD(invMed) SAVE_FIELD(invToy) SAVE_FIELD(careMistakes)
+  SAVE_FIELD(stageStartMistakes) SAVE_FIELD(sicknessRiskPermille)
+  SAVE_FIELD(lowHungerMinutes) SAVE_FIELD(lowHappinessMinutes)
+  SAVE_FIELD(hungerAcc) SAVE_FIELD(happinessAcc) SAVE_FIELD(disciplineAcc)
+  SAVE_FIELD(cleanlinessAcc) SAVE_FIELD(healthAcc) SAVE_FIELD(poopMinuteAcc)
+  SAVE_FIELD(coinMinuteAcc) SAVE_FIELD(lastMedicineEpoch)
+  SAVE_FIELD(nextTantrumEpoch) SAVE_FIELD(tantrumUntilEpoch)
+  SAVE_FIELD(tantrumCooldownUntilEpoch) SAVE_FIELD(sickChancePpm)
+  SAVE_FIELD(sickMinutesLeft)
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    SAVE_FIELD(attentionSinceEpoch[i])
+    SAVE_FIELD(attentionCooldownUntilEpoch[i])
+  }
+  for (uint8_t i = 0; i < 4; ++i) {
+    SAVE_FIELD(rng.s[i])
+  }
+#undef SAVE_FIELD
+  return diffs;
+}
+
+/** What `kLegacyV3` holds; version 2 is the same without the RNG fields. */
+static PetState legacyExpected(uint16_t version) {
+  PetState s;
+  memset(&s, 0, sizeof(s));
+  s.lastEpoch = 1767225600;
+  s.ageMinutes = 43210;
+  s.coins = 321;
+  s.stage = STAGE_TEEN;
+  s.hunger = 64;
+  s.happiness = 72;
+  s.cleanliness = 55;
+  s.energy = 90;
+  s.health = 88;
+  s.discipline = 41;
+  s.weight = 37;
+  s.poop = 2;
+  s.sick = true;
+  s.medGuaranteePending = true;
+  s.invFood = 4;
+  s.invSnack = 3;
+  s.invMed = 2;
+  s.invToy = 1;
+  s.careMistakes = 17;
+  s.stageStartMistakes = 12;
+  s.sicknessRiskPermille = 1250;
+  s.lowHungerMinutes = 30;
+  s.lowHappinessMinutes = 45;
+  s.hungerAcc = -7;
+  s.happinessAcc = 5;
+  s.disciplineAcc = -3;
+  s.cleanlinessAcc = 9;
+  s.healthAcc = -1;
+  s.poopMinuteAcc = 11;
+  s.coinMinuteAcc = 2;
+  s.lastMedicineEpoch = 1767220000;
+  s.nextTantrumEpoch = 1767229200;
+  s.tantrumCooldownUntilEpoch = 1767226800;
+  s.attentionSinceEpoch[ATTN_HUNGER] = 1767225000;
+  s.attentionSinceEpoch[ATTN_SICK] = 1767224400;
+  s.attentionCooldownUntilEpoch[ATTN_HAPPINESS] = 1767230000;
+  if (version >= 3) {
+    s.rng.s[0] = 0x12345678;
+    s.rng.s[1] = 0x9ABCDEF0;
+    s.rng.s[2] = 0x0F1E2D3C;
+    s.rng.s[3] = 0x4B5A6978;
+    s.sickChancePpm = 2500;
+    s.sickMinutesLeft = 90;
+  }
+  return s;
+}
+
+/** One legacy blob: decodes to the known pet and survives re-encoding. */
+static int checkLegacy(const char *what, const uint8_t *blob, size_t len,
+                       uint16_t version) {
+  PetState decoded;
+  uint16_t from = 0;
+  if (!decodeSave(blob, len, decoded, &from) || from != version) {
+    printf("%s: not decoded as version %u\n", what, version);
+    return 1;
+  }
+  const PetState want = legacyExpected(version);
+  int diffs = diffFields(what, decoded, want);
+
+  uint8_t packed[SAVE_MAX_BLOB_BYTES];
+  PetState migrated;
+  const size_t packedLen = encodeSave(decoded, packed, sizeof(packed));
+  if (!decodeSave(packed, packedLen, migrated, &from) ||
+      from != STATE_VERSION) {
+    printf("%s: migrated save does not decode\n", what);
+    return diffs + 1;
+  }
+  return diffs + diffFields(what, migrated, onMinuteGrid(decoded));
+}
+
+/** The stage is 3 bits in the save; values past the last stage are clamped. */
+static int checkStageClamp() {
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  gState.stage = 7;
+  uint8_t blob[SAVE_MAX_BLOB_BYTES];
+  const size_t len = encodeSave(gState, blob, sizeof(blob));
+  if (!decodeSave(blob, len, gState, 0)) return 1;
+  clampState();
+  if (gState.stage != STAGE_ELDER) {
+    printf("stage 7 loaded as %u, want %u\n", gState.stage, STAGE_ELDER);
+    return 1;
+  }
+  return 0;
+}
+
+static void prepareState() {
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  uint32_t epoch = BENCH_START_EPOCH;
+  for (int week = 0; week < 52; ++week) {
+    simulateMinutes(epoch, MAX_OFFLINE_MINUTES);
+    epoch += MAX_OFFLINE_MINUTES * SECONDS_PER_MINUTE;
+  }
+  gState.lastEpoch = epoch;
+}
+
+/** @copydoc runSaveBench */
+void runSaveBench() {
+  int wrong = checkLegacy("v2", kLegacyV2, sizeof(kLegacyV2), 2) +
+              checkLegacy("v3", kLegacyV3, sizeof(kLegacyV3), 3) +
+              checkStageClamp();
+  prepareState();
+
+  const PetState want = onMinuteGrid(gState);
+
+  uint8_t blob[SAVE_MAX_BLOB_BYTES];
+  size_t len = 0;
+  uint32_t runs = 0;
+  uint64_t start = benchNowNs();
+  uint64_t elapsed = 0;
+  do {
+    len = encodeSave(gState, blob, sizeof(blob));
+    ++runs;
+    elapsed = benchNowNs() - start;
+  } while (elapsed < BENCH_MIN_RUN_NS);
+  double encodeNs = (double)elapsed / runs;
+
+  PetState decoded;
+  bool ok = true;
+  runs = 0;
+  start = benchNowNs();
+  do {
+    ok = decodeSave(blob, len, decoded, 0) && ok;
+    ++runs;
+    elapsed = benchNowNs() - start;
+  } while (elapsed < BENCH_MIN_RUN_NS);
+  double decodeNs = (double)elapsed / runs;
+
+  printf("blob   %3lu bytes (PetState %lu bytes)\n", (unsigned long)len,
+         (unsigned long)sizeof(PetState));
+  printf("encode %8.1f ns   decode %8.1f ns%s\n", encodeNs, decodeNs,
+         ok ? "" : "   DECODE FAILED");
+  if (ok) wrong += diffFields("round trip", decoded, want);
+  printf("round trip, v2/v3 migration, stage clamp: %d wrong\n", wrong);
+  benchFail((ok ? 0 : 1) + wrong);
+}
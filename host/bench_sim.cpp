@@ -0,0 +1,152 @@
+#include "bench.h"
+#include "platform_host.h"
+#include "sim.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+/**
+ * @file bench_sim.cpp
+ * @brief Catch-up throughput of the simulation core.
+ *
+ * The pet is left completely alone for the whole horizon, which is the
+ * worst case for catch-up: every alert fires, poop piles up, sickness
+ * arrives, and the fast-forward engine has the most horizons to stop at.
+ *
+ * The same neglected week is then simulated again one minute per call and
+ * the two event streams are compared entry by entry, order included: the
+ * event log stores them as they come. Last, a month-long absence checks that
+ * sliced catch-up still stops at `MAX_OFFLINE_MINUTES`.
+ */
+
+static const uint32_t BENCH_START_EPOCH = 1767225600UL; // 2026-01-01 00:00 UTC
+static const uint64_t BENCH_MIN_RUN_NS = 300ULL * 1000ULL * 1000ULL;
+
+static void simulateHorizon(uint32_t minutes) {
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+
+  uint32_t epoch = BENCH_START_EPOCH;
+  while (minutes > 0) {
+    uint32_t chunk = minutes > MAX_OFFLINE_MINUTES ? MAX_OFFLINE_MINUTES : minutes;
+    simulateMinutes(epoch, chunk);
+    epoch += chunk * SECONDS_PER_MINUTE;
+    minutes -= chunk;
+  }
+  gState.lastEpoch = epoch;
+  clampState();
+}
+
+static void benchHorizon(const char *label, uint32_t minutes) {
+  uint32_t runs = 0;
+  memset(&gSimStats, 0, sizeof(gSimStats));
+
+  uint64_t start = benchNowNs();
+  uint64_t elapsed = 0;
+  do {
+    simulateHorizon(minutes);
+    ++runs;
+    elapsed = benchNowNs() - start;
+  } while (elapsed < BENCH_MIN_RUN_NS);
+
+  double seconds = (double)elapsed / 1e9;
+  double simulated = (double)minutes * runs;
+  printf("%-6s %8lu min  %10.0f sim-min/s  %8.1f us/run  stepped %lu  spans %lu\n",
+         label, (unsigned long)minutes, simulated / seconds,
+         seconds * 1e6 / runs, (unsigned long)(gSimStats.steppedMinutes / runs),
+         (unsigned long)(gSimStats.fastForwardSpans / runs));
+}
+
+/** @brief One recorded `platformSimEvent()` call. */
+struct RecordedEvent {
+  SimEvent event;
+  uint32_t epoch;
+  uint32_t detail;
+};
+
+static std::vector<RecordedEvent> gRecorded;
+
+static void recordEvent(SimEvent event, uint32_t epoch, uint32_t detail) {
+  gRecorded.push_back({event, epoch, detail});
+}
+
+static std::vector<RecordedEvent> recordWeek(uint32_t minutesPerCall) {
+  const uint32_t minutes = 7 * 24 * 60;
+  defaultState();
+  gRecorded.clear();
+  hostSetSimEventSink(recordEvent);
+  for (uint32_t done = 0; done < minutes; done += minutesPerCall) {
+    simulateMinutes(BENCH_START_EPOCH + done * SECONDS_PER_MINUTE,
+                    minutesPerCall);
+  }
+  hostSetSimEventSink(nullptr);
+  return gRecorded;
+}
+
+static void compareEventOrder() {
+  std::vector<RecordedEvent> spans = recordWeek(7 * 24 * 60);
+  const PetState fastForwarded = gState;
+  std::vector<RecordedEvent> steps = recordWeek(1);
+
+  size_t mismatches = spans.size() > steps.size() ? spans.size() - steps.size()
+                                                  : steps.size() - spans.size();
+  size_t backwards = 0;
+  for (size_t i = 0; i < spans.size() && i < steps.size(); ++i) {
+    if (spans[i].event != steps[i].event || spans[i].epoch != steps[i].epoch ||
+        spans[i].detail != steps[i].detail) {
+      ++mismatches;
+    }
+    if (i > 0 && spans[i].epoch < spans[i - 1].epoch) ++backwards;
+  }
+  const bool sameState = memcmp(&fastForwarded, &gState, sizeof(gState)) == 0;
+  printf("event order: %zu events, mismatches %zu, backwards %zu, state %s\n",
+         spans.size(), mismatches, backwards, sameState ? "same" : "DIFFERS");
+  benchFail((int)(mismatches + backwards) + (sameState ? 0 : 1));
+}
+
+/**
+ * A month away caught up in day-long slices, as the game task does: the
+ * first week is simulated, exactly like one week-long call, and `lastEpoch`
+ * then skips to the return.
+ */
+static void checkOfflineCap() {
+  const uint32_t awayMinutes = 30 * 24 * 60 + 17;
+  const uint32_t sliceMinutes = 24 * 60;
+  const uint32_t nowEpoch = BENCH_START_EPOCH + awayMinutes * SECONDS_PER_MINUTE;
+
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  simulateMinutes(BENCH_START_EPOCH, MAX_OFFLINE_MINUTES);
+  PetState week = gState;
+  week.lastEpoch = nowEpoch;
+
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  CatchUp catchUp;
+  memset(&catchUp, 0, sizeof(catchUp));
+  const uint32_t before = gSimStats.simulatedMinutes;
+  uint32_t slices = 1;
+  while (simCatchUpSlice(catchUp, nowEpoch, sliceMinutes)) ++slices;
+  const uint32_t simulated = gSimStats.simulatedMinutes - before;
+  const bool idle = !simCatchUpSlice(catchUp, nowEpoch, sliceMinutes) &&
+                    gSimStats.simulatedMinutes - before == simulated;
+
+  const bool sameState = memcmp(&week, &gState, sizeof(gState)) == 0;
+  const bool ok = simulated == MAX_OFFLINE_MINUTES &&
+                  gState.lastEpoch == nowEpoch && idle && sameState;
+  printf("30 days away: simulated %lu min in %lu slices, lastEpoch %s, "
+         "state %s\n",
+         (unsigned long)simulated, (unsigned long)slices,
+         gState.lastEpoch == nowEpoch && idle ? "caught up" : "WRONG",
+         sameState ? "same as one week" : "DIFFERS");
+  benchFail(ok ? 0 : 1);
+}
+
+/** @copydoc runSimBench */
+void runSimBench() {
+  benchHorizon("week", 7 * 24 * 60);
+  benchHorizon("year", 365 * 24 * 60);
+  compareEventOrder();
+  checkOfflineCap();
+}
@@ -0,0 +1,132 @@
+#include "bench.h"
+#include "snapshot.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <thread>
+
+/**
+ * @file bench_snapshot.cpp
+ * @brief The view-model sequence lock, alone and under real threads.
+ *
+ * Frame `k` has every field derived from `k`, so a reader can tell from the
+ * copy alone whether it holds one whole frame. One writer publishes a cycle
+ * of `STRESS_FRAMES` prebuilt frames as fast as it can while readers copy
+ * them out; a copy that mixes two frames, or is not the frame its version
+ * says, is torn, and a version lower than one already seen went backwards.
+ * Republishing an unchanged frame must keep the version.
+ */
+
+static const uint32_t STRESS_VERSIONS = 4000000;
+static const uint32_t STRESS_FRAMES = 256;
+static const int STRESS_READERS = 3;
+static const int TIMING_CALLS = 1000000;
+
+static void makeFrame(ViewModel &vm, uint32_t k) {
+  memset(&vm, 0, sizeof(vm));
+  vm.screen = static_cast<uint8_t>(k % 9);
+  vm.days = k;
+  vm.coins = static_cast<uint16_t>(k * 7);
+  for (uint8_t i = 0; i < VIEW_STAT_COUNT; ++i) {
+    vm.stats[i] = static_cast<uint8_t>((k + i) % 101);
+  }
+  vm.mgSecondsLeft = ~k;
+  snprintf(vm.message, sizeof(vm.message), "frame %lu", (unsigned long)k);
+  for (uint8_t i = 0; i < DEBUG_OVERLAY_LINES; ++i) {
+    snprintf(vm.debugLines[i], DEBUG_LINE_LEN, "%lu/%u", (unsigned long)k, i);
+  }
+}
+
+static ViewModel gFrames[STRESS_FRAMES];
+
+/** Whether `vm` is exactly the frame published as `version`. */
+static bool wholeFrame(const ViewModel &vm, uint32_t version) {
+  return memcmp(&gFrames[(version - 1) % STRESS_FRAMES], &vm, sizeof(vm)) == 0;
+}
+
+/** @brief What one reader thread saw. */
+struct ReaderStats {
+  uint32_t reads;
+  uint32_t retries;
+  uint32_t torn;
+  uint32_t backwards;
+};
+
+static void reader(const ViewSnapshot *s, const bool *done, ReaderStats *stats) {
+  ViewModel vm;
+  uint32_t last = 0;
+  while (!__atomic_load_n(done, __ATOMIC_ACQUIRE)) {
+    uint32_t version;
+    if (!snapshotTryRead(*s, vm, version)) {
+      ++stats->retries;
+      std::this_thread::yield();
+      continue;
+    }
+    ++stats->reads;
+    if (version == 0) continue;
+    if (!wholeFrame(vm, version)) ++stats->torn;
+    if (version < last) ++stats->backwards;
+    last = version;
+  }
+}
+
+/** @copydoc runSnapshotBench */
+void runSnapshotBench() {
+  static ViewSnapshot snapshot;
+  for (uint32_t k = 0; k < STRESS_FRAMES; ++k) makeFrame(gFrames[k], k + 1);
+
+  memset(&snapshot, 0, sizeof(snapshot));
+  uint64_t start = benchNowNs();
+  for (int i = 0; i < TIMING_CALLS; ++i) {
+    snapshotPublish(snapshot, gFrames[i & 1]);
+  }
+  const double publishNs = (double)(benchNowNs() - start) / TIMING_CALLS;
+
+  start = benchNowNs();
+  for (int i = 0; i < TIMING_CALLS; ++i) snapshotPublish(snapshot, gFrames[1]);
+  const double unchangedNs = (double)(benchNowNs() - start) / TIMING_CALLS;
+
+  ViewModel vm;
+  volatile uint32_t sink = 0;
+  start = benchNowNs();
+  for (int i = 0; i < TIMING_CALLS; ++i) {
+    sink = sink + snapshotRead(snapshot, vm);
+  }
+  const double readNs = (double)(benchNowNs() - start) / TIMING_CALLS;
+  printf("%u bytes: publish %.1f ns, unchanged %.1f ns, read %.1f ns\n",
+         (unsigned)sizeof(snapshot.words), publishNs, unchangedNs, readNs);
+
+  memset(&snapshot, 0, sizeof(snapshot));
+  bool done = false;
+  ReaderStats stats[STRESS_READERS];
+  memset(stats, 0, sizeof(stats));
+  std::thread readers[STRESS_READERS];
+  for (int i = 0; i < STRESS_READERS; ++i) {
+    readers[i] = std::thread(reader, &snapshot, &done, &stats[i]);
+  }
+  uint32_t unchanged = 0;
+  for (uint32_t k = 0; k < STRESS_VERSIONS; ++k) {
+    const ViewModel &frame = gFrames[k % STRESS_FRAMES];
+    snapshotPublish(snapshot, frame);
+    if ((k & 63) == 0 && snapshotPublish(snapshot, frame)) ++unchanged;
+  }
+  __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+
+  ReaderStats total;
+  memset(&total, 0, sizeof(total));
+  for (int i = 0; i < STRESS_READERS; ++i) {
+    readers[i].join();
+    total.reads += stats[i].reads;
+    total.retries += stats[i].retries;
+    total.torn += stats[i].torn;
+    total.backwards += stats[i].backwards;
+  }
+  printf("threads: 1 writer, %d readers, version %lu, %lu reads, %lu retries, "
+         "torn %lu, backwards %lu, unchanged bumps %lu\n",
+         STRESS_READERS, (unsigned long)snapshotVersion(snapshot),
+         (unsigned long)total.reads, (unsigned long)total.retries,
+         (unsigned long)total.torn, (unsigned long)total.backwards,
+         (unsigned long)unchanged);
+  benchFail((int)(total.torn + total.backwards + unchanged));
+}
@@ -0,0 +1,170 @@
+#include "bench.h"
+#include "metrics.h"
+#include "platform.h"
+#include "trace.h"
+#include "ui.h"
+#include "ui_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+
+/**
+ * @file bench_trace.cpp
+ * @brief A boot-like sequence under the timing probes, summarized per probe
+ * and exported as a Chrome trace.
+ *
+ * Catches up a week offline, then visits every screen twice and ticks the
+ * clock a few times, the way a busy interaction would, then prints the
+ * metrics registry as the serial `m` command would. Set `TAMA_TRACE_FILE`
+ * to write the trace JSON there. Needs `-DTAMA_TRACE=1`, which the native
+ * env sets.
+ *
+ * Then one thread records probes while this one copies and dumps the ring,
+ * like the render task's probes against the serial `t` command. Every copy
+ * must be one whole event: its name and duration are derived from its start.
+ */
+
+static const uint32_t BENCH_START_EPOCH = 1767225600UL; // 2026-01-01 00:00 UTC
+static const uint32_t STRESS_EVENTS = 1000000;
+static const char *const kStressNames[2] = {"stress.even", "stress.odd"};
+
+/** @brief Totals of one probe name. */
+struct ProbeTotals {
+  const char *name;
+  uint32_t count;
+  uint64_t ticks;
+  uint32_t maxTicks;
+};
+
+static void writeFile(const char *text, void *ctx) {
+  fputs(text, static_cast<FILE *>(ctx));
+}
+
+static void writeStdout(const char *text, void *ctx) {
+  (void)ctx;
+  fputs(text, stdout);
+}
+
+static void countBytes(const char *text, void *ctx) {
+  *static_cast<size_t *>(ctx) += strlen(text);
+}
+
+#if TAMA_TRACE
+/** Writer half of the stress run: event `k` starts at `k`, lasts `k % 1000`. */
+static void stressRecorder(bool *done) {
+  for (uint32_t k = 1; k <= STRESS_EVENTS; ++k) {
+    traceRecord(kStressNames[k & 1], k, k + k % 1000);
+  }
+  __atomic_store_n(done, true, __ATOMIC_RELEASE);
+}
+
+/** Copy and dump the ring while another thread records into it. */
+static void runTraceStress() {
+  traceClear();
+  bool done = false;
+  std::thread recorder(stressRecorder, &done);
+  uint32_t copies = 0;
+  uint32_t torn = 0;
+  uint32_t dumps = 0;
+  uint32_t oversized = 0;
+  while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+    TraceEvent event;
+    for (uint16_t i = 0; traceEvent(i, event); i += 17) {
+      ++copies;
+      const uint32_t k = static_cast<uint32_t>(event.start);
+      if (event.name != kStressNames[k & 1] || event.ticks != k % 1000) ++torn;
+    }
+    size_t bytes = 0;
+    if (traceWriteJson(countBytes, &bytes) > TRACE_RING_EVENTS) ++oversized;
+    ++dumps;
+  }
+  recorder.join();
+  printf("threads: %lu events recorded, %lu copies, %lu dumps, torn %lu, "
+         "oversized %lu\n",
+         (unsigned long)STRESS_EVENTS, (unsigned long)copies,
+         (unsigned long)dumps, (unsigned long)torn, (unsigned long)oversized);
+  benchFail((int)(torn + oversized));
+  traceClear();
+}
+#endif
+
+/** @copydoc runTraceBench */
+void runTraceBench() {
+#if !TAMA_TRACE
+  printf("built without -DTAMA_TRACE=1; nothing to record\n");
+#else
+  traceClear();
+  metricsReset();
+  gSprite.creatSprite(0, 0, SCREEN_W, SCREEN_H, true);
+  defaultState();
+  gState.lastEpoch = BENCH_START_EPOCH;
+  memset(&gRun, 0, sizeof(gRun));
+
+  const uint32_t minutes = 7 * 24 * 60;
+  simulateMinutes(gState.lastEpoch, minutes);
+  gState.lastEpoch += minutes * 60;
+  hostSetClock(gState.lastEpoch);
+
+  for (int pass = 0; pass < 2; ++pass) {
+    for (uint8_t screen = SCREEN_HOME; screen <= SCREEN_RESET_CONFIRM; ++screen) {
+      gRun.screen = static_cast<Screen>(screen);
+      gRun.dirty = true;
+      renderScreen();
+    }
+  }
+  gRun.screen = SCREEN_HOME;
+  for (int minute = 1; minute <= 5; ++minute) {
+    simulateMinutes(gState.lastEpoch, 1);
+    gState.lastEpoch += 60;
+    hostSetClock(gState.lastEpoch);
+    gRun.dirty = true;
+    renderScreen();
+  }
+
+  ProbeTotals totals[16];
+  uint8_t probes = 0;
+  TraceEvent event;
+  for (uint16_t i = 0; traceEvent(i, event); ++i) {
+    uint8_t p = 0;
+    while (p < probes && strcmp(totals[p].name, event.name) != 0) ++p;
+    if (p == probes) {
+      if (probes == sizeof(totals) / sizeof(totals[0])) continue;
+      totals[probes++] = {event.name, 0, 0, 0};
+    }
+    ++totals[p].count;
+    totals[p].ticks += event.ticks;
+    if (event.ticks > totals[p].maxTicks) totals[p].maxTicks = event.ticks;
+  }
+
+  const double perUs = platformCyclesPerUs();
+  printf("%-18s %6s %10s %10s %10s\n", "probe", "count", "total us", "avg us",
+         "max us");
+  for (uint8_t p = 0; p < probes; ++p) {
+    printf("%-18s %6lu %10.1f %10.2f %10.2f\n", totals[p].name,
+           (unsigned long)totals[p].count, totals[p].ticks / perUs,
+           totals[p].ticks / perUs / totals[p].count, totals[p].maxTicks / perUs);
+  }
+
+  size_t bytes = 0;
+  uint16_t events = traceWriteJson(countBytes, &bytes);
+  printf("events %u (overwritten %lu), trace %lu bytes\n", events,
+         (unsigned long)gTraceStats.overwritten, (unsigned long)bytes);
+  metricsWrite(writeStdout, nullptr);
+
+  const char *path = getenv("TAMA_TRACE_FILE");
+  if (path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+      printf("cannot write %s\n", path);
+      return;
+    }
+    traceWriteJson(writeFile, f);
+    fclose(f);
+    printf("trace written to %s\n", path);
+  }
+  runTraceStress();
+#endif
+}
@@ -0,0 +1,172 @@
+#include "bench.h"
+#include "pet.h"
+#include "wake.h"
+
+#include <stdio.h>
+
+/**
+ * @file bench_wake.cpp
+ * @brief A day of the event-driven game task on a virtual clock.
+ *
+ * A small model of the game task (minute ticks, message timeouts, the save
+ * scheduler, redraws) is driven by `wakeDelayMs()` exactly like the task is:
+ * each iteration does its work, then the clock jumps to the next deadline or
+ * button press. It counts wakeups against the 8,640,000 iterations a day of
+ * the old 10 ms poll, and checks that no press waited.
+ */
+
+static const uint32_t DAY_MS = 24UL * 60UL * 60UL * 1000UL;
+static const uint32_t POLL_MS = 10;
+static const uint32_t MESSAGE_MS = 1500;
+static const int TIMING_CALLS = 1000000;
+
+/** @brief The loop's deadlines and what it did. */
+struct LoopModel {
+  uint32_t nowMs;
+  uint32_t minuteDueMs;
+  bool dirty;
+  bool messageActive;
+  uint32_t messageUntilMs;
+  bool savePending;
+  bool saveUser;
+  uint32_t saveFirstMs;
+  uint32_t saveLastMs;
+
+  uint32_t wakeups;
+  uint32_t renders;
+  uint32_t saves;
+  uint32_t lateMs;
+};
+
+static void requestSaveModel(LoopModel &m, bool user) {
+  if (!m.savePending) {
+    m.savePending = true;
+    m.saveFirstMs = m.nowMs;
+  }
+  if (user) {
+    m.saveUser = true;
+    m.saveLastMs = m.nowMs;
+  }
+}
+
+/** A press opens a message and asks for a user save, like most actions. */
+static void pressModel(LoopModel &m) {
+  m.messageActive = true;
+  m.messageUntilMs = m.nowMs + MESSAGE_MS;
+  m.dirty = true;
+  requestSaveModel(m, true);
+}
+
+/** One pass of the game task minus the buttons. */
+static void stepModel(LoopModel &m) {
+  if (m.messageActive && m.nowMs > m.messageUntilMs) {
+    m.messageActive = false;
+    m.dirty = true;
+  }
+  if (static_cast<int32_t>(m.nowMs - m.minuteDueMs) >= 0) {
+    m.minuteDueMs += 60UL * 1000UL;
+    m.dirty = true;
+    requestSaveModel(m, false);
+  }
+  if (m.savePending &&
+      ((m.saveUser && m.nowMs - m.saveLastMs >= SAVE_QUIET_MS) ||
+       m.nowMs - m.saveFirstMs >= SAVE_MAX_LATENCY_MS)) {
+    m.savePending = false;
+    m.saveUser = false;
+    ++m.saves;
+  }
+  if (m.dirty) {
+    m.dirty = false;
+    ++m.renders;
+  }
+}
+
+static WakeInputs wakeInputs(const LoopModel &m) {
+  WakeInputs in = {};
+  in.nowMs = m.nowMs;
+  in.busy = m.dirty;
+  in.minuteDueMs = m.minuteDueMs;
+  in.messageActive = m.messageActive;
+  in.messageDueMs = m.messageUntilMs + 1;
+  in.savePending = m.savePending;
+  if (m.savePending) {
+    in.saveDueMs = m.saveFirstMs + SAVE_MAX_LATENCY_MS;
+    if (m.saveUser && m.saveLastMs + SAVE_QUIET_MS < in.saveDueMs) {
+      in.saveDueMs = m.saveLastMs + SAVE_QUIET_MS;
+    }
+  }
+  return in;
+}
+
+/**
+ * Run a day with a burst of `burst` presses 3 s apart every `everyMs`
+ * (no presses when `burst` is 0).
+ */
+static LoopModel runDay(uint32_t everyMs, uint8_t burst) {
+  LoopModel m = {};
+  m.minuteDueMs = 60UL * 1000UL;
+  uint32_t nextBurstMs = everyMs / 2;
+  uint8_t burstLeft = 0;
+  uint32_t nextPressMs = 0;
+
+  while (m.nowMs < DAY_MS) {
+    ++m.wakeups;
+    if (burstLeft == 0 && burst && m.nowMs >= nextBurstMs) {
+      burstLeft = burst;
+      nextPressMs = nextBurstMs;
+      nextBurstMs += everyMs;
+    }
+    if (burstLeft && m.nowMs >= nextPressMs) {
+      m.lateMs += m.nowMs - nextPressMs;
+      pressModel(m);
+      --burstLeft;
+      nextPressMs += 3000;
+    }
+    stepModel(m);
+
+    uint32_t wakeAt = m.nowMs + wakeDelayMs(wakeInputs(m));
+    uint32_t pressAt = burstLeft ? nextPressMs : nextBurstMs;
+    if (burst && pressAt < wakeAt) wakeAt = pressAt > m.nowMs ? pressAt : m.nowMs;
+    m.nowMs = wakeAt;
+  }
+  return m;
+}
+
+/** @copydoc runWakeBench */
+void runWakeBench() {
+  struct Scenario {
+    const char *name;
+    uint32_t everyMs;
+    uint8_t burst;
+  };
+  static const Scenario kScenarios[] = {
+      {"idle", 0, 0},
+      {"5 presses/2h", 2UL * 60UL * 60UL * 1000UL, 5},
+      {"5 presses/10m", 10UL * 60UL * 1000UL, 5},
+  };
+
+  printf("%-14s %8s %8s %6s %12s %10s %8s\n", "day", "wakeups", "renders",
+         "saves", "avg sleep ms", "vs poll", "late ms");
+  for (const Scenario &s : kScenarios) {
+    LoopModel m = runDay(s.everyMs, s.burst);
+    printf("%-14s %8lu %8lu %6lu %12.1f %9.0fx %8lu\n", s.name,
+           (unsigned long)m.wakeups, (unsigned long)m.renders,
+           (unsigned long)m.saves, (double)DAY_MS / m.wakeups,
+           (double)(DAY_MS / POLL_MS) / m.wakeups, (unsigned long)m.lateMs);
+  }
+
+  LoopModel m = {};
+  m.minuteDueMs = 60UL * 1000UL;
+  m.messageActive = true;
+  m.messageUntilMs = 1500;
+  m.savePending = true;
+  m.saveUser = true;
+  volatile uint32_t sink = 0;
+  uint64_t start = benchNowNs();
+  for (int i = 0; i < TIMING_CALLS; ++i) {
+    m.nowMs = static_cast<uint32_t>(i);
+    sink = sink + wakeDelayMs(wakeInputs(m));
+  }
+  printf("wakeDelayMs %.1f ns/call\n",
+         (double)(benchNowNs() - start) / TIMING_CALLS);
+}
@@ -0,0 +1,273 @@
+#include "M5CoreInk.h"
+
+#include <chrono>
+#include <string.h>
+
+/**
+ * @file m5_host.cpp
+ * @brief RAM rasterizer behind the host `Ink_Sprite` and panel.
+ */
+
+M5CoreInkHost M5;
+
+static std::chrono::steady_clock::duration sinceStart() {
+  static const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  return std::chrono::steady_clock::now() - start;
+}
+
+/** @copydoc millis */
+uint32_t millis() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+             sinceStart())
+      .count();
+}
+
+/** @copydoc micros */
+uint32_t micros() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             sinceStart())
+      .count();
+}
+
+static const int ROW_BYTES = InkPanel::SIZE / 8;
+
+/** @copydoc InkPanel::clear */
+int InkPanel::clear(int mode) {
+  (void)mode;
+  memset(pixels, 0, sizeof(pixels));
+  ++clears;
+  return 0;
+}
+
+/** @copydoc InkPanel::setDrawAddr */
+int InkPanel::setDrawAddr(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  addrX = x;
+  addrY = y;
+  addrW = w;
+  addrH = h;
+  return 0;
+}
+
+/** @copydoc InkPanel::drawBuff */
+int InkPanel::drawBuff(uint8_t *before, uint8_t *after, size_t size) {
+  const int bytes = addrW / 8;
+  if (size < (size_t)bytes * addrH) return 0;
+  bool stale = false;
+  for (int row = 0; row < addrH; ++row) {
+    uint8_t *dst = pixels + (addrY + row) * ROW_BYTES + addrX / 8;
+    if (memcmp(dst, before + row * bytes, bytes) != 0) stale = true;
+    memcpy(dst, after + row * bytes, bytes);
+  }
+  if (stale) ++staleBefore;
+  ++windows;
+  windowPixels += (uint32_t)addrW * addrH;
+  return 0;
+}
+
+/** @copydoc Ink_Sprite::creatSprite */
+int Ink_Sprite::creatSprite(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                            bool copyFull) {
+  (void)x;
+  (void)y;
+  (void)w;
+  (void)h;
+  (void)copyFull;
+  memset(buffer, 0, sizeof(buffer));
+  return 0;
+}
+
+/** @copydoc Ink_Sprite::pushSprite */
+int Ink_Sprite::pushSprite() {
+  memcpy(panel->pixels, buffer, sizeof(buffer));
+  return 0;
+}
+
+void Ink_Sprite::plot(int x, int y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= InkPanel::SIZE || y >= InkPanel::SIZE) return;
+  uint8_t &byte = buffer[y * ROW_BYTES + x / 8];
+  const uint8_t mask = 0x80 >> (x & 7);
+  if (color) {
+    byte |= mask;
+  } else {
+    byte &= ~mask;
+  }
+}
+
+void Ink_Sprite::fillScreen(uint16_t color) {
+  ++drawCalls;
+  memset(buffer, color ? 0xFF : 0x00, sizeof(buffer));
+}
+
+void Ink_Sprite::drawPixel(int x, int y, uint16_t color) {
+  ++drawCalls;
+  plot(x, y, color);
+}
+
+void Ink_Sprite::drawRect(int x, int y, int w, int h, uint16_t color) {
+  ++drawCalls;
+  for (int i = 0; i < w; ++i) {
+    plot(x + i, y, color);
+    plot(x + i, y + h - 1, color);
+  }
+  for (int j = 0; j < h; ++j) {
+    plot(x, y + j, color);
+    plot(x + w - 1, y + j, color);
+  }
+}
+
+void Ink_Sprite::fillRect(int x, int y, int w, int h, uint16_t color) {
+  ++drawCalls;
+  for (int j = 0; j < h; ++j) {
+    for (int i = 0; i < w; ++i) plot(x + i, y + j, color);
+  }
+}
+
+void Ink_Sprite::drawLine(int x0, int y0, int x1, int y1, uint16_t color) {
+  ++drawCalls;
+  // Bresenham, both ends inclusive.
+  const int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+  const int dy = y1 > y0 ? y0 - y1 : y1 - y0;
+  const int sx = x0 < x1 ? 1 : -1;
+  const int sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  for (;;) {
+    plot(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    const int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void Ink_Sprite::drawCircle(int x, int y, int r, uint16_t color) {
+  ++drawCalls;
+  // Midpoint circle, the same octant walk Adafruit GFX uses.
+  int f = 1 - r;
+  int ddx = 1;
+  int ddy = -2 * r;
+  int px = 0;
+  int py = r;
+  plot(x, y + r, color);
+  plot(x, y - r, color);
+  plot(x + r, y, color);
+  plot(x - r, y, color);
+  while (px < py) {
+    if (f >= 0) {
+      --py;
+      ddy += 2;
+      f += ddy;
+    }
+    ++px;
+    ddx += 2;
+    f += ddx;
+    plot(x + px, y + py, color);
+    plot(x - px, y + py, color);
+    plot(x + px, y - py, color);
+    plot(x - px, y - py, color);
+    plot(x + py, y + px, color);
+    plot(x - py, y + px, color);
+    plot(x + py, y - px, color);
+    plot(x - py, y - px, color);
+  }
+}
+
+void Ink_Sprite::fillCircle(int x, int y, int r, uint16_t color) {
+  ++drawCalls;
+  for (int j = -r; j <= r; ++j) {
+    for (int i = -r; i <= r; ++i) {
+      if (i * i + j * j <= r * r) plot(x + i, y + j, color);
+    }
+  }
+}
+
+void Ink_Sprite::drawBitmap(int x, int y, const uint8_t *bits, int w, int h,
+                            uint16_t color) {
+  ++drawCalls;
+  const int rowBytes = (w + 7) / 8;
+  for (int row = 0; row < h; ++row) {
+    for (int col = 0; col < w; ++col) {
+      if (bits[row * rowBytes + col / 8] & (0x80 >> (col & 7))) {
+        plot(x + col, y + row, color);
+      }
+    }
+  }
+}
+
+/** @brief Classic 5x7 font for ' '..'~', one byte per column, LSB on top. */
+static const uint8_t kFont5x7[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00},
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00},
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00},
+    {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08},
+    {0x00, 0x00, 0x60, 0x60, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33},
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},
+    {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E},
+    {0x00, 0x00, 0x14, 0x00, 0x00}, {0x00, 0x40, 0x34, 0x00, 0x00},
+    {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06},
+    {0x3E, 0x41, 0x5D, 0x59, 0x4E}, {0x7C, 0x12, 0x11, 0x12, 0x7C},
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41},
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x41, 0x51, 0x73},
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x1C, 0x02, 0x7F},
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E},
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x26, 0x49, 0x49, 0x49, 0x32},
+    {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x03, 0x04, 0x78, 0x04, 0x03},
+    {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F},
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+    {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28},
+    {0x38, 0x44, 0x44, 0x28, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18},
+    {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00},
+    {0x20, 0x40, 0x40, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+    {0xFC, 0x18, 0x24, 0x24, 0x18}, {0x18, 0x24, 0x24, 0x18, 0xFC},
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C},
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+    {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+    {0x00, 0x00, 0x77, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00},
+    {0x02, 0x01, 0x02, 0x04, 0x02},
+};
+
+/** @copydoc Ink_Sprite::drawString */
+void Ink_Sprite::drawString(const char *text, int x, int y) {
+  ++drawCalls;
+  for (; *text; ++text, x += 6 * textSize) {
+    uint8_t c = static_cast<uint8_t>(*text);
+    if (c < ' ' || c > '~') c = '?';
+    const uint8_t *glyph = kFont5x7[c - ' '];
+    for (int col = 0; col < 5; ++col) {
+      for (int row = 0; row < 8; ++row) {
+        if (!(glyph[col] & (1 << row))) continue;
+        for (int dy = 0; dy < textSize; ++dy) {
+          for (int dx = 0; dx < textSize; ++dx) {
+            plot(x + col * textSize + dx, y + row * textSize + dy, textColor);
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,47 @@
+#include "platform_host.h"
+
+#include <chrono>
+#include <mutex>
+#include <random>
+
+/**
+ * @file platform_host.cpp
+ * @brief Host implementation of the simulation platform hooks.
+ */
+
+/** @copydoc platformEntropy */
+uint32_t platformEntropy() {
+  static std::random_device device;
+  return device();
+}
+
+static HostSimEventSink gSimEventSink = nullptr;
+
+/** @copydoc hostSetSimEventSink */
+void hostSetSimEventSink(HostSimEventSink sink) { gSimEventSink = sink; }
+
+/** @copydoc platformSimEvent */
+void platformSimEvent(SimEvent event, uint32_t epoch, uint32_t detail) {
+  if (gSimEventSink) gSimEventSink(event, epoch, detail);
+}
+
+/** @copydoc platformCycleCount */
+uint32_t platformCycleCount() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** @copydoc platformCyclesPerUs */
+uint32_t platformCyclesPerUs() { return 1000; }
+
+static std::mutex gPlatformMutex;
+
+/** @copydoc platformLock */
+void platformLock() { gPlatformMutex.lock(); }
+
+/** @copydoc platformUnlock */
+void platformUnlock() { gPlatformMutex.unlock(); }
+
+/** @copydoc platformCoreId */
+uint8_t platformCoreId() { return 0; }
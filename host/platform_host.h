@@ -0,0 +1,18 @@
+#pragma once
+
+#include "platform.h"
+
+/**
+ * @file platform_host.h
+ * @brief Host-only controls for the platform hooks in `platform_host.cpp`.
+ */
+
+/** @brief Receiver for `platformSimEvent()` calls on the host. */
+typedef void (*HostSimEventSink)(SimEvent event, uint32_t epoch,
+                                 uint32_t detail);
+
+/**
+ * @brief Route simulation events to `sink`, e.g. to record them in a bench.
+ * @param sink Receiver, or `nullptr` to drop events again (the default).
+ */
+void hostSetSimEventSink(HostSimEventSink sink);
@@ -0,0 +1,89 @@
+#include "Preferences.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file preferences_host.cpp
+ * @brief One-file-per-key implementation of the host `Preferences` stand-in.
+ */
+
+static const char *gStorageDir = nullptr;
+static bool gTearNext = false;
+static size_t gTearKeep = 0;
+
+static const char *storageDir() {
+  if (gStorageDir) return gStorageDir;
+  const char *env = getenv("TAMA_PREFS_DIR");
+  return env && env[0] ? env : ".";
+}
+
+void Preferences::setStorageDir(const char *dir) { gStorageDir = dir; }
+
+void Preferences::tearNextWrite(size_t keepBytes) {
+  gTearNext = true;
+  gTearKeep = keepBytes;
+}
+
+bool Preferences::begin(const char *name, bool readOnly) {
+  if (!name || strlen(name) >= sizeof(name_)) return false;
+  strcpy(name_, name);
+  readOnly_ = readOnly;
+  open_ = true;
+  return true;
+}
+
+void Preferences::end() { open_ = false; }
+
+bool Preferences::pathFor(const char *key, char *out, size_t capacity) const {
+  if (!open_ || !key) return false;
+  int n = snprintf(out, capacity, "%s/%s.%s.bin", storageDir(), name_, key);
+  return n > 0 && (size_t)n < capacity;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  char path[512];
+  if (!pathFor(key, path, sizeof(path))) return 0;
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+  fseek(f, 0, SEEK_END);
+  long len = ftell(f);
+  fclose(f);
+  return len > 0 ? (size_t)len : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  size_t len = getBytesLength(key);
+  if (len == 0 || len > maxLen) return 0;
+
+  char path[512];
+  pathFor(key, path, sizeof(path));
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+  size_t got = fread(buf, 1, len, f);
+  fclose(f);
+  return got == len ? len : 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  char path[512];
+  if (readOnly_ || !pathFor(key, path, sizeof(path))) return 0;
+
+  bool torn = gTearNext;
+  size_t keep = torn && gTearKeep < len ? gTearKeep : len;
+  gTearNext = false;
+
+  FILE *f = fopen(path, "wb");
+  if (!f) return 0;
+  size_t wrote = fwrite(value, 1, keep, f);
+  fclose(f);
+  if (torn) return 0;
+  return wrote == len ? len : 0;
+}
+
+bool Preferences::remove(const char *key) {
+  char path[512];
+  if (readOnly_ || !pathFor(key, path, sizeof(path))) return false;
+  return ::remove(path) == 0;
+}
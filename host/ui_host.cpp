@@ -0,0 +1,81 @@
+#include "ui_host.h"
+
+#include "logic.h"
+
+#include <string.h>
+
+/**
+ * @file ui_host.cpp
+ * @brief Host definitions of the UI's hardware-facing state.
+ */
+
+RuntimeState gRun;
+Ink_Sprite gSprite(&M5.M5Ink);
+SaveStats gSaveStats;
+
+// Must match pet.cpp; the golden frames of the menu would tell.
+const char *const kMenuItems[] = {
+    "Feed",      "Play",  "Clean", "Light", "Med",
+    "Scold",     "Inv",   "Game",  "Status", "Helper"};
+
+const uint8_t kMenuCount = sizeof(kMenuItems) / sizeof(kMenuItems[0]);
+
+uint8_t gHostBatteryPercent = 100;
+
+static ClockSnapshot gHostClock;
+
+/** @copydoc hostSetClock */
+void hostSetClock(uint32_t epoch) {
+  gHostClock.valid = epoch != 0;
+  gHostClock.epoch = epoch;
+  gHostClock.minuteOfDay = static_cast<uint16_t>((epoch / 60) % (24 * 60));
+  gHostClock.hour = static_cast<uint8_t>(gHostClock.minuteOfDay / 60);
+  gHostClock.minute = static_cast<uint8_t>(gHostClock.minuteOfDay % 60);
+}
+
+/** @copydoc clockNow */
+const ClockSnapshot &clockNow() { return gHostClock; }
+
+/** @copydoc getBatteryPercent */
+uint8_t getBatteryPercent() { return gHostBatteryPercent; }
+
+/** @copydoc isTantrumActive */
+bool isTantrumActive() {
+  return tantrumActiveAt(gHostClock.valid ? gHostClock.epoch : gState.lastEpoch);
+}
+
+/** @copydoc getActiveAlertMask */
+uint8_t getActiveAlertMask() { return gAlerts.mask; }
+
+/** @copydoc getActiveAlertCount */
+uint8_t getActiveAlertCount() { return gAlerts.count; }
+
+/** @copydoc markDirty */
+void markDirty() {
+  syncAlerts();
+  gRun.dirty = true;
+}
+
+/** @copydoc showMessage */
+void showMessage(const char *msg, uint32_t durationMs) {
+  strncpy(gRun.message, msg, sizeof(gRun.message) - 1);
+  gRun.message[sizeof(gRun.message) - 1] = '\0';
+  gRun.messageUntilMs = millis() + durationMs;
+  gRun.lastScreen = gRun.screen;
+  gRun.screen = SCREEN_MESSAGE;
+  markDirty();
+}
+
+/** @copydoc resolveTantrumByScold */
+bool resolveTantrumByScold() {
+  return resolveTantrum(gHostClock.valid ? gHostClock.epoch : gState.lastEpoch);
+}
+
+/** @copydoc requestSave */
+void requestSave(SaveUrgency urgency) {
+  (void)urgency;
+  ++gSaveStats.requests;
+}
+
+/** @copydoc flushSave */
+void flushSave() { ++gSaveStats.forcedWrites; }
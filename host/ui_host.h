@@ -0,0 +1,21 @@
+#pragma once
+
+#include "pet.h"
+
+/**
+ * @file ui_host.h
+ * @brief Host stand-ins for the hardware-facing state `ui.cpp` reads.
+ *
+ * `pet.cpp` and `clock_service.cpp` talk to the ADC, NVS and RTC, so the
+ * host build provides just the globals and getters the UI and `logic.cpp`
+ * need, fed from the settings below. Saves are only counted.
+ */
+
+/**
+ * @brief Set the wall clock `clockNow()` reports.
+ * @param epoch Seconds since the Unix epoch; `0` reports an unset clock.
+ */
+void hostSetClock(uint32_t epoch);
+
+/** @brief Battery percentage `getBatteryPercent()` reports. */
+extern uint8_t gHostBatteryPercent;
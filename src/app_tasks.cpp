@@ -0,0 +1,265 @@
+#include "app_tasks.h"
+
+#include <M5CoreInk.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <string.h>
+
+#include "input.h"
+#include "logic.h"
+#include "metrics.h"
+#include "pet.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "ui.h"
+#include "wake.h"
+
+/**
+ * @file app_tasks.cpp
+ * @brief Input, game and render tasks.
+ *
+ * The render task gets core 1 to itself, where the Arduino loop used to run
+ * the panel driver; its busy-waits never starve core 0's idle task.
+ */
+
+static const BaseType_t APP_GAME_CORE = 0;
+static const BaseType_t APP_RENDER_CORE = 1;
+static const uint32_t APP_INPUT_STACK = 3072;
+static const uint32_t APP_GAME_STACK = 8192;
+static const uint32_t APP_RENDER_STACK = 8192;
+// Input preempts the game task on their shared core, so edges become events
+// even in the middle of a catch-up slice.
+static const UBaseType_t APP_INPUT_PRIORITY = 3;
+static const UBaseType_t APP_GAME_PRIORITY = 2;
+static const UBaseType_t APP_RENDER_PRIORITY = 2;
+
+/** @brief What the game task's queue carries. */
+enum AppMessageKind : uint8_t {
+  /** @brief One input event. */
+  APP_MESSAGE_INPUT,
+  /** @brief The render task caught up with the newest frame. */
+  APP_MESSAGE_FRAME_DONE
+};
+
+struct AppMessage {
+  AppMessageKind kind;
+  InputEvent event;
+};
+
+static QueueHandle_t gGameQueue = nullptr;
+static TaskHandle_t gRenderTask = nullptr;
+/** @brief What the screen should show; the game task publishes it. */
+static ViewSnapshot gView;
+/** @brief Snapshot version on the panel; only the render task stores it. */
+static uint32_t gViewShown = 0;
+/** @brief Set while the input task holds edges it has not sent yet. */
+static volatile bool gInputBusy = false;
+/** @brief Presses the input task holds back (`InputGestures::pendingMask`). */
+static volatile uint8_t gInputDeferred = 0;
+
+static void sendEvents(const InputEvent *events, uint8_t count) {
+  for (uint8_t i = 0; i < count; ++i) {
+    AppMessage message;
+    message.kind = APP_MESSAGE_INPUT;
+    message.event = events[i];
+    // Blocks while the game task is behind; the edge ring keeps buffering.
+    xQueueSend(gGameQueue, &message, portMAX_DELAY);
+  }
+}
+
+static void inputTask(void *arg) {
+  (void)arg;
+  InputGestures gestures;
+  memset(&gestures, 0, sizeof(gestures));
+  gestures.deferMask = LOGIC_LONG_PRESS_BUTTONS;
+  for (;;) {
+    // A held button is checked in short slices until its long press is out,
+    // a bouncing one until its level has settled and been re-read.
+    const bool watching = (gestures.heldMask & ~gestures.longSentMask) != 0 ||
+                          wakeEdgesSettling();
+    ulTaskNotifyTake(pdTRUE, watching ? pdMS_TO_TICKS(WAKE_HELD_POLL_MS)
+                                      : portMAX_DELAY);
+    gInputBusy = true;
+    // Sampled first: every edge up to now is already queued, so a long press
+    // cannot be reported for a hold whose release is still waiting.
+    const uint32_t nowUs = micros();
+    InputEvent events[INPUT_EVENTS_PER_EDGE];
+    InputEdge edge;
+    while (wakeTakeEdge(edge)) {
+      sendEvents(events, inputGesturesFeed(gestures, edge, events));
+    }
+    sendEvents(events, inputGesturesPoll(gestures, nowUs, events));
+    metricSet(METRIC_INPUT_DROPPED, wakeDroppedEdges());
+    gInputDeferred = gestures.pendingMask;
+    gInputBusy = false;
+  }
+}
+
+static void renderTask(void *arg) {
+  (void)arg;
+  static ViewModel vm;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // Frames published during a refresh are skipped for the newest one.
+    while (snapshotVersion(gView) != gViewShown) {
+      const uint32_t version = snapshotRead(gView, vm);
+      renderViewModel(vm);
+      __atomic_store_n(&gViewShown, version, __ATOMIC_RELEASE);
+    }
+    // Lets the game task light-sleep; if the queue is full it is awake.
+    AppMessage message;
+    memset(&message, 0, sizeof(message));
+    message.kind = APP_MESSAGE_FRAME_DONE;
+    xQueueSend(gGameQueue, &message, 0);
+  }
+}
+
+/**
+ * Handle queued events, waiting up to `wait` for the first one.
+ * @return Whether any input was handled.
+ */
+static bool drainEvents(TickType_t wait) {
+  bool handled = false;
+  AppMessage message;
+  while (xQueueReceive(gGameQueue, &message, wait) == pdTRUE) {
+    if (message.kind == APP_MESSAGE_INPUT) {
+      handleInputEvents(&message.event, 1);
+      handled = true;
+    }
+    wait = 0;
+  }
+  return handled;
+}
+
+/** Hand the render task a new frame if anything visible changed. */
+static void publishFrame() {
+  static ViewModel vm;
+  if (takeViewModel(vm) && snapshotPublish(gView, vm)) {
+    xTaskNotifyGive(gRenderTask);
+  }
+}
+
+static void writeSerial(const char *text, void *ctx) {
+  (void)ctx;
+  Serial.print(text);
+}
+
+/**
+ * Serial commands: `m` dumps the metrics; with `TAMA_TRACE`, `t` dumps the
+ * probe ring as a Chrome trace and `c` clears it.
+ */
+static void serviceSerial() {
+  while (Serial.available() > 0) {
+    int command = Serial.read();
+    if (command == 'm') {
+      metricsWrite(writeSerial, nullptr);
+#if TAMA_TRACE
+    } else if (command == 't') {
+      traceWriteJson(writeSerial, nullptr);
+    } else if (command == 'c') {
+      traceClear();
+#endif
+    }
+  }
+}
+
+/** Whether light sleep would stall no other task's work. */
+static bool othersIdle() {
+  const uint32_t shown = __atomic_load_n(&gViewShown, __ATOMIC_ACQUIRE);
+  return !gInputBusy && !wakeButtonHeld() && shown == snapshotVersion(gView) &&
+         uxQueueMessagesWaiting(gGameQueue) == 0;
+}
+
+/** Epoch to deep-sleep until, or 0 to stay up (see `wakeDeepSleepUntil()`). */
+static uint32_t deepSleepUntil(const ClockSnapshot &now) {
+  DeepSleepInputs in;
+  in.nowEpoch = now.valid ? now.epoch : 0;
+  in.idleMs = millis() - gRun.lastUiActionMs;
+  in.home = gRun.screen == SCREEN_HOME;
+  in.nextEventEpoch = simNextEventEpoch(gState, WAKE_DEEP_MAX_MINUTES);
+  return wakeDeepSleepUntil(in);
+}
+
+/** Sleep until the next deadline, button press or serial input. */
+static void waitForNextEvent() {
+  WakeInputs in;
+  in.nowMs = millis();
+  in.busy = gRun.dirty || Serial.available() > 0;
+  // Held buttons are the input task's to watch.
+  in.buttonHeld = false;
+  const ClockSnapshot &now = clockNow();
+  in.minuteDueMs = in.nowMs + (now.valid ? clockMsUntil(gState.lastEpoch +
+                                                         SECONDS_PER_MINUTE)
+                                         : WAKE_MAX_SLEEP_MS);
+  in.messageActive = gRun.screen == SCREEN_MESSAGE;
+  // The handlers fire once `millis()` is past the deadline, not at it.
+  in.messageDueMs = gRun.messageUntilMs + 1;
+  // A deferred press holds the round open; its release ends the wait.
+  in.miniGameActive = gRun.screen == SCREEN_MINIGAME && gRun.mgActive &&
+                      gInputDeferred == 0;
+  in.miniGameDueMs = gRun.mgDeadlineMs + 1;
+  in.savePending = saveDueMs(in.saveDueMs);
+  const uint32_t ms = wakeDelayMs(in);
+  if (ms == 0) return;
+
+  if (othersIdle()) {
+    const uint32_t wakeEpoch = deepSleepUntil(now);
+    if (wakeEpoch != 0) {
+      // The RTC mirror keeps the pet through the sleep; NVS waits for its
+      // usual deadline, so a timer wake costs no flash write.
+      mirrorForDeepSleep();
+      wakeDeepSleep(wakeEpoch - now.epoch);
+    }
+    wakeSleep(ms);
+    return;
+  }
+  // The panel or a button is still busy: idle on the queue instead, which
+  // the next event or the finished frame ends early.
+  drainEvents(pdMS_TO_TICKS(ms));
+}
+
+static void gameTask(void *arg) {
+  (void)arg;
+  // Catch up with the time spent off, answering presses between slices.
+  while (applyOfflineProgress()) {
+    if (drainEvents(0)) publishFrame();
+  }
+
+  for (;;) {
+    const uint32_t startUs = micros();
+    M5.update();
+
+    drainEvents(0);
+    handleMiniGameTimeout(gInputDeferred != 0);
+    handleMessageTimeout();
+    while (advanceTime()) {
+      if (drainEvents(0)) publishFrame();
+    }
+    serviceSaves();
+    handleIdle();
+    publishFrame();
+    serviceSerial();
+
+    metricObserve(METRIC_LOOP_US, micros() - startUs);
+    metricSet(METRIC_HEAP_FREE, ESP.getFreeHeap());
+    metricSet(METRIC_HEAP_MIN, ESP.getMinFreeHeap());
+    waitForNextEvent();
+  }
+}
+
+/** @copydoc appTasksStart */
+void appTasksStart() {
+  gGameQueue = xQueueCreate(APP_EVENT_QUEUE, sizeof(AppMessage));
+
+  TaskHandle_t input = nullptr;
+  xTaskCreatePinnedToCore(renderTask, "render", APP_RENDER_STACK, nullptr,
+                          APP_RENDER_PRIORITY, &gRenderTask, APP_RENDER_CORE);
+  xTaskCreatePinnedToCore(gameTask, "game", APP_GAME_STACK, nullptr,
+                          APP_GAME_PRIORITY, nullptr, APP_GAME_CORE);
+  xTaskCreatePinnedToCore(inputTask, "input", APP_INPUT_STACK, nullptr,
+                          APP_INPUT_PRIORITY, &input, APP_GAME_CORE);
+  wakeSetEdgeTask(input);
+  // Edges queued before the task existed.
+  xTaskNotifyGive(input);
+}
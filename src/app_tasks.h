@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file app_tasks.h
+ * @brief The firmware's three FreeRTOS tasks and how they talk.
+ *
+ * - Input (core 0, highest priority): woken by the button interrupt, turns
+ *   queued edges into gestures (see input.h) and sends the events on.
+ * - Game (core 0): the only task that touches `gState` and `gRun`. Handles
+ *   events, timeouts, the minute tick, saves and serial commands, publishes
+ *   a `ViewModel` whenever something changed, then sleeps until the next
+ *   deadline, or deep-sleeps until the pet next changes once it has been
+ *   left alone on the Home screen (wake.h).
+ * - Render (core 1): draws the newest published view model and pushes it to
+ *   the panel.
+ *
+ * Events go through a bounded queue. Frames are published as a snapshot
+ * (snapshot.h) that the render task copies without a lock; a slow panel
+ * skips to the newest frame instead of working through stale ones. The game
+ * task never waits for the panel, and a long catch-up stops every
+ * `SIM_SLICE_MINUTES` to handle whatever was pressed meanwhile, so presses
+ * are answered at once whatever the panel or the simulation is doing.
+ *
+ * Device only.
+ */
+
+/** @brief Events the game task can fall behind by; the edge ring holds more. */
+static const uint8_t APP_EVENT_QUEUE = 16;
+
+/**
+ * @brief Start the tasks. Call last in `setup()`, with the state loaded;
+ * from then on only the game task may touch `gState` and `gRun`.
+ */
+void appTasksStart();
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file checksum.h
+ * @brief CRCs for saves and logs.
+ *
+ * On the ESP32 the reflected CRC16/CRC32 come from the mask ROM (`crc16_le`,
+ * `crc32_le`); elsewhere, table-driven fallbacks give bit-identical results.
+ * CRC-16/MODBUS is what saves have always used and has no ROM version, so it
+ * is always table-driven.
+ */
+
+/** @brief Algorithms available through `checksum()`. */
+enum ChecksumAlgo {
+  /** @brief CRC-16/MODBUS (poly 0xA001 reflected, init 0xFFFF). Save format. */
+  CHECKSUM_CRC16_MODBUS,
+  /** @brief CRC-16/X-25, i.e. ROM `crc16_le(0, ...)`. */
+  CHECKSUM_CRC16_LE,
+  /** @brief CRC-32/ISO-HDLC (zlib), i.e. ROM `crc32_le(0, ...)`. */
+  CHECKSUM_CRC32_LE
+};
+
+/**
+ * @brief CRC-16/MODBUS of a buffer; the checksum every save version uses.
+ * @param data Bytes to checksum.
+ * @param len Number of bytes.
+ * @return CRC value.
+ */
+uint16_t crc16Modbus(const uint8_t *data, size_t len);
+/**
+ * @brief CRC-16/X-25 with the ROM's chaining convention.
+ * @param crc `0` to start, or the previous result to continue.
+ * @param data Bytes to checksum.
+ * @param len Number of bytes.
+ * @return CRC value.
+ */
+uint16_t crc16Le(uint16_t crc, const uint8_t *data, size_t len);
+/**
+ * @brief CRC-32 (zlib) with the ROM's chaining convention.
+ * @param crc `0` to start, or the previous result to continue.
+ * @param data Bytes to checksum.
+ * @param len Number of bytes.
+ * @return CRC value.
+ */
+uint32_t crc32Le(uint32_t crc, const uint8_t *data, size_t len);
+/**
+ * @brief Checksum a buffer with the chosen algorithm.
+ * @param algo Algorithm.
+ * @param data Bytes to checksum.
+ * @param len Number of bytes.
+ * @return CRC value, zero-extended for the 16-bit algorithms.
+ */
+uint32_t checksum(ChecksumAlgo algo, const uint8_t *data, size_t len);
+/**
+ * @brief Whether `crc16Le`/`crc32Le` run from the ESP32 ROM in this build.
+ * @return `true` on the device, `false` on the host fallback.
+ */
+bool checksumUsesRom();
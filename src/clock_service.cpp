@@ -0,0 +1,174 @@
+#include "clock_service.h"
+#include "metrics.h"
+
+#include <M5CoreInk.h>
+#include <esp_timer.h>
+#include <stdio.h>
+
+/**
+ * @file clock_service.cpp
+ * @brief RTC-anchored clock extrapolated from the monotonic timer.
+ */
+
+/** @brief How often the extrapolated time is re-anchored to the RTC. */
+static const int64_t CLOCK_RESYNC_US = 10LL * 60LL * 1000000LL;
+/**
+ * @brief Largest backwards correction absorbed instead of applied.
+ *
+ * The RTC only has whole seconds, so a resync can land slightly behind the
+ * extrapolation. Small lags are left for the RTC to catch up with rather than
+ * letting time run backwards; anything larger is a real clock change.
+ */
+static const uint32_t CLOCK_MAX_HOLD_SECONDS = 2;
+
+static ClockSnapshot gClock;
+static bool gClockStarted = false;
+static uint32_t gBaseEpoch = 0;
+static int64_t gBaseUs = 0;
+static int64_t gLastSyncUs = 0;
+
+static uint16_t dateToDays(uint16_t y, uint8_t m, uint8_t d) {
+  if (y >= 2000) y -= 2000;
+  static const uint8_t daysInMonth[] = {
+      31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  uint16_t days = d;
+  for (uint8_t i = 1; i < m; ++i) {
+    days += daysInMonth[i - 1];
+  }
+  if (m > 2 && (y % 4) == 0) {
+    days += 1;
+  }
+  return days + 365 * y + (y + 3) / 4 - 1;
+}
+
+static uint32_t toEpoch(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
+                        uint8_t minute, uint8_t second) {
+  const uint32_t SECONDS_FROM_1970_TO_2000 = 946684800UL;
+  uint16_t days = dateToDays(year, month, day);
+  uint32_t t = ((uint32_t)days * 24UL + hour) * 3600UL +
+               (uint32_t)minute * 60UL + second;
+  return t + SECONDS_FROM_1970_TO_2000;
+}
+
+static bool readRtcEpoch(uint32_t &outEpoch) {
+  RTC_TimeTypeDef t;
+  RTC_DateTypeDef d;
+  M5.Rtc.GetTime(&t);
+  M5.Rtc.GetDate(&d);
+  metricAdd(METRIC_RTC_READS);
+
+  uint16_t year = d.Year;
+  if (year < 100) year += 2000;
+  if (year < 2024) return false;
+
+  outEpoch = toEpoch(year, d.Month, d.Date, t.Hours, t.Minutes, t.Seconds);
+  return true;
+}
+
+static uint8_t monthFromStr(const char *m) {
+  if (!m) return 1;
+  if (m[0] == 'J' && m[1] == 'a') return 1;
+  if (m[0] == 'F') return 2;
+  if (m[0] == 'M' && m[2] == 'r') return 3;
+  if (m[0] == 'A' && m[1] == 'p') return 4;
+  if (m[0] == 'M' && m[2] == 'y') return 5;
+  if (m[0] == 'J' && m[2] == 'n') return 6;
+  if (m[0] == 'J' && m[2] == 'l') return 7;
+  if (m[0] == 'A' && m[1] == 'u') return 8;
+  if (m[0] == 'S') return 9;
+  if (m[0] == 'O') return 10;
+  if (m[0] == 'N') return 11;
+  if (m[0] == 'D') return 12;
+  return 1;
+}
+
+static void setRtcToBuildTime() {
+  char monthStr[4] = {0};
+  int day = 1;
+  int year = 2024;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+
+  sscanf(__DATE__, "%3s %d %d", monthStr, &day, &year);
+  sscanf(__TIME__, "%d:%d:%d", &hour, &minute, &second);
+
+  RTC_TimeTypeDef t;
+  RTC_DateTypeDef d;
+  t.Hours = hour;
+  t.Minutes = minute;
+  t.Seconds = second;
+
+  if (sizeof(d.Year) == 1 && year >= 2000) {
+    d.Year = year - 2000;
+  } else {
+    d.Year = year;
+  }
+  d.Month = monthFromStr(monthStr);
+  d.Date = day;
+
+  M5.Rtc.SetTime(&t);
+  M5.Rtc.SetDate(&d);
+}
+
+static uint32_t extrapolateEpoch(int64_t nowUs) {
+  return gBaseEpoch + (uint32_t)((nowUs - gBaseUs) / 1000000LL);
+}
+
+static void syncFromRtc(int64_t nowUs) {
+  gClockStarted = true;
+  gLastSyncUs = nowUs;
+
+  uint32_t rtcEpoch = 0;
+  if (!readRtcEpoch(rtcEpoch)) {
+    setRtcToBuildTime();
+    if (!readRtcEpoch(rtcEpoch)) {
+      gClock.valid = false;
+      return;
+    }
+  }
+
+  if (gClock.valid) {
+    uint32_t predicted = extrapolateEpoch(nowUs);
+    if (rtcEpoch < predicted && predicted - rtcEpoch <= CLOCK_MAX_HOLD_SECONDS) {
+      return;
+    }
+  }
+
+  gBaseEpoch = rtcEpoch;
+  gBaseUs = nowUs;
+  gClock.valid = true;
+}
+
+static void fillSnapshot(uint32_t epoch) {
+  gClock.epoch = epoch;
+  gClock.minuteOfDay = static_cast<uint16_t>((epoch / 60) % (24 * 60));
+  gClock.hour = static_cast<uint8_t>(gClock.minuteOfDay / 60);
+  gClock.minute = static_cast<uint8_t>(gClock.minuteOfDay % 60);
+}
+
+/** @copydoc clockNow */
+const ClockSnapshot &clockNow() {
+  int64_t nowUs = esp_timer_get_time();
+  if (!gClockStarted || nowUs - gLastSyncUs >= CLOCK_RESYNC_US) {
+    syncFromRtc(nowUs);
+  }
+
+  if (gClock.valid) {
+    fillSnapshot(extrapolateEpoch(nowUs));
+  }
+  return gClock;
+}
+
+/** @copydoc clockMsUntil */
+uint32_t clockMsUntil(uint32_t epoch) {
+  if (!gClock.valid) return 0;
+  const int64_t targetUs =
+      gBaseUs + ((int64_t)epoch - (int64_t)gBaseEpoch) * 1000000LL;
+  const int64_t leftUs = targetUs - esp_timer_get_time();
+  if (leftUs <= 0) return 0;
+  return (uint32_t)((leftUs + 999) / 1000);
+}
+
+/** @copydoc clockResync */
+void clockResync() { gClockStarted = false; }
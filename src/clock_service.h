@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file clock_service.h
+ * @brief Cached wall-clock time backed by the BM8563 RTC.
+ *
+ * The RTC is read once, then time is extrapolated from the monotonic
+ * `esp_timer` and re-anchored to the RTC every few minutes. Asking for the
+ * time costs a subtraction instead of two I2C transactions.
+ */
+
+/** @brief One consistent reading of wall-clock time. */
+struct ClockSnapshot {
+  /** @brief Whether the RTC produced a plausible time at the last sync. */
+  bool valid;
+  /** @brief Seconds since the Unix epoch (RTC local time treated as UTC). */
+  uint32_t epoch;
+  /** @brief Minutes since midnight, 0-1439. */
+  uint16_t minuteOfDay;
+  /** @brief Hour of day, 0-23. */
+  uint8_t hour;
+  /** @brief Minute of hour, 0-59. */
+  uint8_t minute;
+};
+
+/**
+ * @brief Current time from the cached clock, resyncing with the RTC when due.
+ *
+ * On the first call (or an unset RTC) the RTC is seeded from the firmware
+ * build time, exactly like the old direct reads did.
+ * @return Snapshot valid until the next call.
+ */
+const ClockSnapshot &clockNow();
+
+/**
+ * @brief Milliseconds until the extrapolated clock reaches `epoch`.
+ * @param epoch Target time, seconds since the Unix epoch.
+ * @return 0 if it has passed or the clock is not valid.
+ */
+uint32_t clockMsUntil(uint32_t epoch);
+
+/**
+ * @brief Force the next `clockNow()` to re-read the RTC.
+ *
+ * Use after anything that may have moved the RTC or stopped the timer.
+ */
+void clockResync();
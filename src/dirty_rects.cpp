@@ -0,0 +1,106 @@
+#include "dirty_rects.h"
+
+/**
+ * @file dirty_rects.cpp
+ * @brief Damage rectangle merging.
+ */
+
+static int16_t minI16(int16_t a, int16_t b) { return a < b ? a : b; }
+static int16_t maxI16(int16_t a, int16_t b) { return a > b ? a : b; }
+
+static uint32_t rectArea(const DirtyRect &r) {
+  return (uint32_t)r.w * (uint32_t)r.h;
+}
+
+static DirtyRect rectUnion(const DirtyRect &a, const DirtyRect &b) {
+  DirtyRect u;
+  u.x = minI16(a.x, b.x);
+  u.y = minI16(a.y, b.y);
+  u.w = static_cast<int16_t>(maxI16(a.x + a.w, b.x + b.w) - u.x);
+  u.h = static_cast<int16_t>(maxI16(a.y + a.h, b.y + b.h) - u.y);
+  return u;
+}
+
+static bool rectsNear(const DirtyRect &a, const DirtyRect &b) {
+  return a.x <= b.x + b.w + DIRTY_MERGE_SLACK &&
+         b.x <= a.x + a.w + DIRTY_MERGE_SLACK &&
+         a.y <= b.y + b.h + DIRTY_MERGE_SLACK &&
+         b.y <= a.y + a.h + DIRTY_MERGE_SLACK;
+}
+
+static void removeRect(DirtyRects &dirty, uint8_t index) {
+  dirty.rects[index] = dirty.rects[--dirty.count];
+}
+
+/** @copydoc dirtyClear */
+void dirtyClear(DirtyRects &dirty) { dirty.count = 0; }
+
+/** @copydoc dirtyAdd */
+void dirtyAdd(DirtyRects &dirty, DirtyRect rect, int16_t screenW,
+              int16_t screenH) {
+  int16_t x0 = maxI16(rect.x, 0);
+  int16_t y0 = maxI16(rect.y, 0);
+  int16_t x1 = minI16(static_cast<int16_t>(rect.x + rect.w), screenW);
+  int16_t y1 = minI16(static_cast<int16_t>(rect.y + rect.h), screenH);
+  if (x1 <= x0 || y1 <= y0) return;
+
+  x0 = static_cast<int16_t>(x0 - x0 % DIRTY_ALIGN_X);
+  x1 = static_cast<int16_t>((x1 + DIRTY_ALIGN_X - 1) / DIRTY_ALIGN_X *
+                            DIRTY_ALIGN_X);
+  DirtyRect r = {x0, y0, static_cast<int16_t>(minI16(x1, screenW) - x0),
+                 static_cast<int16_t>(y1 - y0)};
+
+  // Swallow every neighbour; the union may reach further ones, so rescan.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (uint8_t i = 0; i < dirty.count; ++i) {
+      if (rectsNear(r, dirty.rects[i])) {
+        r = rectUnion(r, dirty.rects[i]);
+        removeRect(dirty, i);
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (dirty.count < DIRTY_MAX_RECTS) {
+    dirty.rects[dirty.count++] = r;
+    return;
+  }
+
+  // Full: merge whichever existing rectangle grows the least by taking r.
+  uint8_t best = 0;
+  uint32_t bestWaste = UINT32_MAX;
+  for (uint8_t i = 0; i < dirty.count; ++i) {
+    uint32_t area = rectArea(rectUnion(r, dirty.rects[i]));
+    uint32_t parts = rectArea(r) + rectArea(dirty.rects[i]);
+    uint32_t waste = area > parts ? area - parts : 0;
+    if (waste < bestWaste) {
+      bestWaste = waste;
+      best = i;
+    }
+  }
+  DirtyRect u = rectUnion(r, dirty.rects[best]);
+  removeRect(dirty, best);
+  dirtyAdd(dirty, u, screenW, screenH);
+}
+
+/** @copydoc dirtyArea */
+uint32_t dirtyArea(const DirtyRects &dirty) {
+  uint32_t area = 0;
+  for (uint8_t i = 0; i < dirty.count; ++i) {
+    area += rectArea(dirty.rects[i]);
+  }
+  return area;
+}
+
+/** @copydoc drawKeyMix */
+uint32_t drawKeyMix(uint32_t hash, const void *data, uint32_t len) {
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  for (uint32_t i = 0; i < len; ++i) {
+    hash ^= p[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file dirty_rects.h
+ * @brief Which parts of the screen a frame actually changed.
+ *
+ * The boxes of the widgets a frame redrew are the damage; everything else
+ * stayed as it was on the panel. The damage is merged into a few byte-aligned
+ * rectangles, each becoming one partial refresh window.
+ *
+ * Pure code: no Arduino, safe to build on the host.
+ */
+
+/** @brief Most rectangles a frame is merged into; each costs one panel update. */
+static const uint8_t DIRTY_MAX_RECTS = 3;
+/** @brief Horizontal alignment of refresh windows (one byte of 1bpp pixels). */
+static const int16_t DIRTY_ALIGN_X = 8;
+/** @brief Rectangles closer than this are merged even if they do not overlap. */
+static const int16_t DIRTY_MERGE_SLACK = 8;
+
+/** @brief Screen-space rectangle; empty when `w` or `h` is not positive. */
+struct DirtyRect {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+};
+
+/** @brief Damage of one frame. */
+struct DirtyRects {
+  /** @brief Rectangles in use. */
+  uint8_t count;
+  /** @brief Disjoint-ish, byte-aligned, clipped rectangles. */
+  DirtyRect rects[DIRTY_MAX_RECTS];
+};
+
+/**
+ * @brief Forget all damage.
+ * @param dirty List to reset.
+ */
+void dirtyClear(DirtyRects &dirty);
+/**
+ * @brief Add a damaged rectangle, merging it with the ones already there.
+ *
+ * The rectangle is clipped to the screen and widened to `DIRTY_ALIGN_X`.
+ * Overlapping or nearby rectangles are merged; when the list is full the pair
+ * whose union wastes the fewest pixels is merged.
+ * @param dirty Damage so far.
+ * @param rect Damaged rectangle.
+ * @param screenW Screen width (a multiple of `DIRTY_ALIGN_X`).
+ * @param screenH Screen height.
+ */
+void dirtyAdd(DirtyRects &dirty, DirtyRect rect, int16_t screenW,
+              int16_t screenH);
+/**
+ * @brief Total pixels covered by the rectangles.
+ * @param dirty Damage to measure.
+ * @return Sum of rectangle areas.
+ */
+uint32_t dirtyArea(const DirtyRects &dirty);
+/**
+ * @brief Mix values into a widget or tile key (FNV-1a).
+ * @param hash Running hash; start with `DRAW_KEY_SEED`.
+ * @param data Bytes to mix in.
+ * @param len Number of bytes.
+ * @return Updated hash.
+ */
+uint32_t drawKeyMix(uint32_t hash, const void *data, uint32_t len);
+
+/** @brief Initial value for `drawKeyMix()`. */
+static const uint32_t DRAW_KEY_SEED = 2166136261UL;
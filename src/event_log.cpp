@@ -0,0 +1,352 @@
+#include "event_log.h"
+
+#include "checksum.h"
+
+#include <string.h>
+
+/**
+ * @file event_log.cpp
+ * @brief Buffered, chunked, sector-rotating event log.
+ */
+
+static const uint32_t LOG_MAGIC = 0x474C4554; // "TELG"
+static const uint32_t SECTOR_HEADER_BYTES = 12;
+static const uint32_t CHUNK_HEADER_BYTES = 6;
+static const uint32_t CHUNK_CRC_BYTES = 2;
+static const uint16_t CHUNK_END = 0xFFFF;
+/** @brief RAM buffer size; also the largest chunk payload. */
+static const uint16_t LOG_BUFFER_BYTES = 240;
+/** @brief Type byte plus two 5-byte varints. */
+static const uint8_t MAX_RECORD_BYTES = 11;
+
+EventLogStats gEventLogStats;
+
+static const EventLogFlash *gFlash = nullptr;
+static uint32_t gSector = 0;
+static uint32_t gOffset = 0;
+static uint32_t gSequence = 0;
+
+static uint8_t gBuffer[LOG_BUFFER_BYTES];
+static uint16_t gBufferLen = 0;
+static uint16_t gBufferRecords = 0;
+static uint32_t gBufferBase = 0;
+static uint32_t gBufferLast = 0;
+
+static uint32_t readLe32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void writeLe32(uint8_t *p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+static uint16_t readLe16(const uint8_t *p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static void writeLe16(uint8_t *p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+static uint8_t putVarint(uint8_t *out, uint32_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = static_cast<uint8_t>(v);
+  return n;
+}
+
+static bool getVarint(const uint8_t *data, uint16_t len, uint16_t &pos,
+                      uint32_t &v) {
+  v = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (pos >= len) return false;
+    uint8_t b = data[pos++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+  return static_cast<int32_t>((v >> 1) ^ (0U - (v & 1U)));
+}
+
+static bool sequenceNewer(uint32_t a, uint32_t b) {
+  return static_cast<int32_t>(a - b) > 0;
+}
+
+static bool readSectorHeader(const EventLogFlash &flash, uint32_t sector,
+                             uint32_t &sequence) {
+  uint8_t header[SECTOR_HEADER_BYTES];
+  if (!flash.read(flash.ctx, sector * flash.sectorSize, header, sizeof(header))) {
+    return false;
+  }
+  if (readLe32(header) != LOG_MAGIC) return false;
+  if (crc32Le(0, header, 8) != readLe32(header + 8)) return false;
+  sequence = readLe32(header + 4);
+  return true;
+}
+
+/**
+ * Load the chunk at `offset` of `sector` into `payload`.
+ * @return Chunk size on flash, or 0 at the end of the sector or on damage.
+ */
+static uint32_t readChunk(const EventLogFlash &flash, uint32_t sector,
+                          uint32_t offset, uint8_t *payload, uint16_t &len,
+                          uint32_t &baseEpoch) {
+  uint8_t header[CHUNK_HEADER_BYTES];
+  if (offset + CHUNK_HEADER_BYTES + CHUNK_CRC_BYTES > flash.sectorSize) return 0;
+  const uint32_t addr = sector * flash.sectorSize + offset;
+  if (!flash.read(flash.ctx, addr, header, sizeof(header))) return 0;
+
+  len = readLe16(header);
+  if (len == CHUNK_END || len == 0 || len > LOG_BUFFER_BYTES) return 0;
+  const uint32_t size = CHUNK_HEADER_BYTES + len + CHUNK_CRC_BYTES;
+  if (offset + size > flash.sectorSize) return 0;
+
+  uint8_t crcBytes[CHUNK_CRC_BYTES];
+  if (!flash.read(flash.ctx, addr + CHUNK_HEADER_BYTES, payload, len) ||
+      !flash.read(flash.ctx, addr + CHUNK_HEADER_BYTES + len, crcBytes,
+                  sizeof(crcBytes))) {
+    return 0;
+  }
+  uint16_t crc = crc16Le(0, header, sizeof(header));
+  crc = crc16Le(crc, payload, len);
+  if (crc != readLe16(crcBytes)) return 0;
+
+  baseEpoch = readLe32(header + 2);
+  return size;
+}
+
+/** Whether the bytes at the writer's position are still erased. */
+static bool sectorEndIsClean(const EventLogFlash &flash, uint32_t sector,
+                             uint32_t offset) {
+  uint8_t lenBytes[2];
+  if (offset + sizeof(lenBytes) > flash.sectorSize) return true;
+  if (!flash.read(flash.ctx, sector * flash.sectorSize + offset, lenBytes,
+                  sizeof(lenBytes))) {
+    return false;
+  }
+  return readLe16(lenBytes) == CHUNK_END;
+}
+
+static bool startSector(uint32_t sector, uint32_t sequence) {
+  const EventLogFlash &flash = *gFlash;
+  if (!flash.erase(flash.ctx, sector)) return false;
+  ++gEventLogStats.sectorErases;
+
+  uint8_t header[SECTOR_HEADER_BYTES];
+  writeLe32(header, LOG_MAGIC);
+  writeLe32(header + 4, sequence);
+  writeLe32(header + 8, crc32Le(0, header, 8));
+  if (!flash.write(flash.ctx, sector * flash.sectorSize, header, sizeof(header))) {
+    return false;
+  }
+  gEventLogStats.bytesWritten += sizeof(header);
+
+  gSector = sector;
+  gSequence = sequence;
+  gOffset = SECTOR_HEADER_BYTES;
+  return true;
+}
+
+static bool rotateSector() {
+  return startSector((gSector + 1) % gFlash->sectorCount, gSequence + 1);
+}
+
+/** @copydoc eventLogMount */
+bool eventLogMount(const EventLogFlash *flash) {
+  gFlash = nullptr;
+  gBufferLen = 0;
+  gBufferRecords = 0;
+  if (!flash || flash->sectorCount < 2 ||
+      flash->sectorSize < SECTOR_HEADER_BYTES + CHUNK_HEADER_BYTES +
+                              LOG_BUFFER_BYTES + CHUNK_CRC_BYTES) {
+    return false;
+  }
+
+  bool found = false;
+  uint32_t newest = 0;
+  uint32_t newestSequence = 0;
+  for (uint32_t i = 0; i < flash->sectorCount; ++i) {
+    uint32_t sequence = 0;
+    if (!readSectorHeader(*flash, i, sequence)) continue;
+    if (!found || sequenceNewer(sequence, newestSequence)) {
+      found = true;
+      newest = i;
+      newestSequence = sequence;
+    }
+  }
+
+  gFlash = flash;
+  if (!found) {
+    if (startSector(0, 1)) return true;
+    gFlash = nullptr;
+    return false;
+  }
+
+  gSector = newest;
+  gSequence = newestSequence;
+  uint32_t offset = SECTOR_HEADER_BYTES;
+  uint8_t payload[LOG_BUFFER_BYTES];
+  uint16_t len = 0;
+  uint32_t base = 0;
+  while (uint32_t size = readChunk(*flash, newest, offset, payload, len, base)) {
+    offset += size;
+  }
+  gOffset = offset;
+
+  // Anything but erased flash after the last good chunk is a torn write.
+  if (!sectorEndIsClean(*flash, newest, offset) && !rotateSector()) {
+    gFlash = nullptr;
+    return false;
+  }
+  return true;
+}
+
+/** @copydoc eventLogFlush */
+bool eventLogFlush() {
+  if (gBufferLen == 0) return true;
+  if (!gFlash) {
+    gEventLogStats.dropped += gBufferRecords;
+    gBufferLen = 0;
+    gBufferRecords = 0;
+    return false;
+  }
+
+  const uint32_t size = CHUNK_HEADER_BYTES + gBufferLen + CHUNK_CRC_BYTES;
+  bool ok = true;
+  if (gOffset + size > gFlash->sectorSize) {
+    ok = rotateSector();
+  }
+
+  if (ok) {
+    uint8_t chunk[CHUNK_HEADER_BYTES + LOG_BUFFER_BYTES + CHUNK_CRC_BYTES];
+    writeLe16(chunk, gBufferLen);
+    writeLe32(chunk + 2, gBufferBase);
+    memcpy(chunk + CHUNK_HEADER_BYTES, gBuffer, gBufferLen);
+    writeLe16(chunk + CHUNK_HEADER_BYTES + gBufferLen,
+              crc16Le(0, chunk, CHUNK_HEADER_BYTES + gBufferLen));
+    ok = gFlash->write(gFlash->ctx, gSector * gFlash->sectorSize + gOffset,
+                       chunk, size);
+  }
+
+  if (ok) {
+    gOffset += size;
+    ++gEventLogStats.chunks;
+    gEventLogStats.bytesWritten += size;
+  } else {
+    gEventLogStats.dropped += gBufferRecords;
+    // Whatever reached this sector is suspect; continue in a fresh one.
+    gOffset = gFlash->sectorSize;
+  }
+  gBufferLen = 0;
+  gBufferRecords = 0;
+  return ok;
+}
+
+/** @copydoc eventLogAppend */
+void eventLogAppend(EventType type, uint32_t epoch, uint32_t value) {
+  if (!gFlash) {
+    ++gEventLogStats.dropped;
+    return;
+  }
+  if (gBufferLen + MAX_RECORD_BYTES > LOG_BUFFER_BYTES) {
+    eventLogFlush();
+  }
+  if (gBufferLen == 0) {
+    gBufferBase = epoch;
+    gBufferLast = epoch;
+  }
+
+  uint8_t *out = gBuffer + gBufferLen;
+  uint8_t n = 0;
+  out[n++] = static_cast<uint8_t>(type);
+  n += putVarint(out + n, zigzag(static_cast<int32_t>(epoch - gBufferLast)));
+  n += putVarint(out + n, value);
+  gBufferLen += n;
+  gBufferLast = epoch;
+  ++gBufferRecords;
+  ++gEventLogStats.appended;
+}
+
+/** @copydoc eventLogReaderBegin */
+void eventLogReaderBegin(EventLogReader &reader) {
+  memset(&reader, 0, sizeof(reader));
+  if (!gFlash) return;
+  reader.sectorsLeft = gFlash->sectorCount;
+  reader.sector = (gSector + 1) % gFlash->sectorCount;
+}
+
+/** Move to the next chunk; returns false when the log is exhausted. */
+static bool readerLoadChunk(EventLogReader &reader) {
+  const EventLogFlash &flash = *gFlash;
+  while (reader.sectorsLeft > 0) {
+    if (reader.offset == 0) {
+      uint32_t sequence = 0;
+      if (!readSectorHeader(flash, reader.sector, sequence)) {
+        reader.offset = flash.sectorSize;
+      } else {
+        reader.offset = SECTOR_HEADER_BYTES;
+      }
+    }
+
+    uint16_t len = 0;
+    uint32_t base = 0;
+    uint32_t size = reader.offset < flash.sectorSize
+                        ? readChunk(flash, reader.sector, reader.offset,
+                                    reader.chunk, len, base)
+                        : 0;
+    if (size > 0) {
+      reader.offset += size;
+      reader.chunkLen = len;
+      reader.chunkPos = 0;
+      reader.epoch = base;
+      return true;
+    }
+
+    --reader.sectorsLeft;
+    reader.sector = (reader.sector + 1) % flash.sectorCount;
+    reader.offset = 0;
+  }
+  return false;
+}
+
+/** @copydoc eventLogReaderNext */
+bool eventLogReaderNext(EventLogReader &reader, EventRecord &record) {
+  if (!gFlash) return false;
+
+  while (true) {
+    if (reader.chunkPos >= reader.chunkLen && !readerLoadChunk(reader)) {
+      return false;
+    }
+
+    uint16_t pos = reader.chunkPos;
+    uint32_t delta = 0;
+    uint32_t value = 0;
+    uint8_t type = reader.chunk[pos++];
+    if (getVarint(reader.chunk, reader.chunkLen, pos, delta) &&
+        getVarint(reader.chunk, reader.chunkLen, pos, value)) {
+      reader.chunkPos = pos;
+      reader.epoch += static_cast<uint32_t>(unzigzag(delta));
+      record.type = type;
+      record.epoch = reader.epoch;
+      record.value = value;
+      return true;
+    }
+    // Malformed tail: skip the rest of this chunk.
+    reader.chunkPos = reader.chunkLen;
+  }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file event_log.h
+ * @brief Append-only lifetime history in a raw flash partition.
+ *
+ * Events are encoded into a small RAM buffer as `[type][zigzag varint time
+ * delta][varint value]` and written out as one CRC-protected chunk whenever
+ * the game saves (or the buffer fills). Chunks are appended to the current
+ * flash sector; when it is full the next sector in the ring is erased and
+ * takes over, so every sector wears at the same rate and the oldest history
+ * is the first to go.
+ *
+ * Flash access goes through `EventLogFlash`, so the same code runs against
+ * the `evlog` partition on the device and a RAM image on the host.
+ *
+ * On-flash layout, all little-endian:
+ * - sector: `u32 magic, u32 sequence, u32 crc32(magic, sequence)`, chunks...
+ * - chunk: `u16 length, u32 base epoch, records[length], u16 crc16_le`
+ * - erased space reads as `0xFF`, so a length of `0xFFFF` ends a sector.
+ */
+
+/** @brief Kinds of history records. Values are stored, so never renumber. */
+enum EventType {
+  /** @brief Value: the neglected `AttentionReason`. */
+  EVENT_CARE_MISTAKE = 1,
+  /** @brief Value: the new `Stage`. */
+  EVENT_EVOLVED = 2,
+  EVENT_SICK = 3,
+  /** @brief Value: `1` when the medicine guarantee kicked in. */
+  EVENT_CURED = 4,
+  EVENT_TANTRUM_STARTED = 5,
+  EVENT_TANTRUM_RESOLVED = 6,
+  EVENT_TANTRUM_IGNORED = 7,
+  /** @brief Value: the `ItemType` bought. */
+  EVENT_PURCHASE = 8,
+  /** @brief The player started a new pet. Value: age of the old one in minutes. */
+  EVENT_RESET = 9
+};
+
+/** @brief One decoded history record. */
+struct EventRecord {
+  /** @brief `EventType` value. */
+  uint8_t type;
+  /** @brief When it happened. */
+  uint32_t epoch;
+  /** @brief Type-specific value. */
+  uint32_t value;
+};
+
+/** @brief Raw flash the log lives in, addressed from the partition start. */
+struct EventLogFlash {
+  /** @brief Erase unit in bytes (4096 on the ESP32). */
+  uint32_t sectorSize;
+  /** @brief Number of sectors the log may use; at least 2. */
+  uint32_t sectorCount;
+  /** @brief Read `len` bytes at `offset`. */
+  bool (*read)(void *ctx, uint32_t offset, void *dst, size_t len);
+  /** @brief Program `len` bytes at `offset` (bits can only go from 1 to 0). */
+  bool (*write)(void *ctx, uint32_t offset, const void *src, size_t len);
+  /** @brief Erase one whole sector back to `0xFF`. */
+  bool (*erase)(void *ctx, uint32_t sector);
+  /** @brief Passed to the callbacks. */
+  void *ctx;
+};
+
+/** @brief Event log counters. */
+struct EventLogStats {
+  /** @brief Records accepted into the RAM buffer. */
+  uint32_t appended;
+  /** @brief Records lost because no log is mounted or a write failed. */
+  uint32_t dropped;
+  /** @brief Chunks written to flash. */
+  uint32_t chunks;
+  /** @brief Bytes written to flash, headers included. */
+  uint32_t bytesWritten;
+  /** @brief Sectors erased by rotation. */
+  uint32_t sectorErases;
+};
+
+/** @brief Streaming reader state; holds one chunk at a time. */
+struct EventLogReader {
+  /** @brief Sectors left to visit, oldest first. */
+  uint32_t sectorsLeft;
+  uint32_t sector;
+  uint32_t offset;
+  uint32_t epoch;
+  uint16_t chunkLen;
+  uint16_t chunkPos;
+  uint8_t chunk[256];
+};
+
+/** @brief Global event log counters. */
+extern EventLogStats gEventLogStats;
+
+/**
+ * @brief Attach the log to its flash and find where to continue writing.
+ *
+ * Blank flash gets formatted; a torn chunk at the end of the newest sector
+ * makes the writer move on to a fresh sector.
+ * @param flash Flash to use; must outlive the log. `nullptr` unmounts.
+ * @return `true` when the log is ready to append.
+ */
+bool eventLogMount(const EventLogFlash *flash);
+/**
+ * @brief Mount the log on the `evlog` data partition (device only).
+ * @return `true` when the partition exists and the log is ready.
+ */
+bool eventLogMountPartition();
+/**
+ * @brief Queue a record; flushes on its own if the buffer is full.
+ * @param type What happened.
+ * @param epoch When it happened.
+ * @param value Type-specific value.
+ */
+void eventLogAppend(EventType type, uint32_t epoch, uint32_t value);
+/**
+ * @brief Write buffered records to flash as one chunk.
+ * @return `true` when nothing was pending or the chunk was written.
+ */
+bool eventLogFlush();
+/**
+ * @brief Start reading the whole log from the oldest record.
+ * @param reader Reader to initialise.
+ */
+void eventLogReaderBegin(EventLogReader &reader);
+/**
+ * @brief Read the next record.
+ *
+ * Records still in the RAM buffer are not included; flush first.
+ * @param reader Reader from `eventLogReaderBegin()`.
+ * @param record Output record.
+ * @return `false` once the log is exhausted.
+ */
+bool eventLogReaderNext(EventLogReader &reader, EventRecord &record);
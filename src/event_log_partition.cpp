@@ -0,0 +1,50 @@
+#include "event_log.h"
+
+#include <esp_partition.h>
+
+/**
+ * @file event_log_partition.cpp
+ * @brief Binds the event log to the `evlog` raw data partition.
+ */
+
+/** @brief Custom data subtype of the `evlog` entry in `partitions.csv`. */
+static const esp_partition_subtype_t EVENT_LOG_SUBTYPE =
+    static_cast<esp_partition_subtype_t>(0x99);
+/** @brief Flash erase unit. */
+static const uint32_t EVENT_LOG_SECTOR_BYTES = 4096;
+
+static bool partitionRead(void *ctx, uint32_t offset, void *dst, size_t len) {
+  const esp_partition_t *part = static_cast<const esp_partition_t *>(ctx);
+  return esp_partition_read(part, offset, dst, len) == ESP_OK;
+}
+
+static bool partitionWrite(void *ctx, uint32_t offset, const void *src,
+                           size_t len) {
+  const esp_partition_t *part = static_cast<const esp_partition_t *>(ctx);
+  return esp_partition_write(part, offset, src, len) == ESP_OK;
+}
+
+static bool partitionErase(void *ctx, uint32_t sector) {
+  const esp_partition_t *part = static_cast<const esp_partition_t *>(ctx);
+  return esp_partition_erase_range(part, sector * EVENT_LOG_SECTOR_BYTES,
+                                   EVENT_LOG_SECTOR_BYTES) == ESP_OK;
+}
+
+static EventLogFlash gPartitionFlash;
+
+/** @copydoc eventLogMountPartition */
+bool eventLogMountPartition() {
+  const esp_partition_t *part = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, EVENT_LOG_SUBTYPE, "evlog");
+  if (!part) {
+    return eventLogMount(nullptr);
+  }
+
+  gPartitionFlash.sectorSize = EVENT_LOG_SECTOR_BYTES;
+  gPartitionFlash.sectorCount = part->size / EVENT_LOG_SECTOR_BYTES;
+  gPartitionFlash.read = partitionRead;
+  gPartitionFlash.write = partitionWrite;
+  gPartitionFlash.erase = partitionErase;
+  gPartitionFlash.ctx = const_cast<esp_partition_t *>(part);
+  return eventLogMount(&gPartitionFlash);
+}
@@ -0,0 +1,78 @@
+#include "frame_tiles.h"
+
+/**
+ * @file frame_tiles.cpp
+ * @brief Tile hashing and comparison.
+ */
+
+static uint32_t hashTile(const uint8_t *frame, int16_t rowBytes, int16_t x0,
+                         int16_t y0, int16_t x1, int16_t y1) {
+  uint32_t hash = DRAW_KEY_SEED;
+  for (int16_t y = y0; y < y1; ++y) {
+    hash = drawKeyMix(hash, frame + y * rowBytes + x0 / 8, (x1 - x0) / 8);
+  }
+  return hash;
+}
+
+/** @copydoc frameTilesReset */
+void frameTilesReset(FrameTiles &tiles) { tiles.valid = false; }
+
+/** @copydoc frameTilesUpdate */
+uint16_t frameTilesUpdate(FrameTiles &tiles, const uint8_t *frame,
+                          int16_t width, int16_t height,
+                          const DirtyRects *within, DirtyRects &changed) {
+  dirtyClear(changed);
+  const uint8_t cols = static_cast<uint8_t>((width + FRAME_TILE_PX - 1) / FRAME_TILE_PX);
+  const uint8_t rows = static_cast<uint8_t>((height + FRAME_TILE_PX - 1) / FRAME_TILE_PX);
+  if ((uint16_t)cols * rows > FRAME_TILE_MAX) {
+    DirtyRect all = {0, 0, width, height};
+    dirtyAdd(changed, all, width, height);
+    return 1;
+  }
+
+  const bool stale = !tiles.valid || tiles.cols != cols || tiles.rows != rows;
+  const bool everything = stale || !within;
+  bool considered[FRAME_TILE_MAX];
+  for (uint16_t i = 0; i < (uint16_t)cols * rows; ++i) {
+    considered[i] = everything;
+  }
+  if (!everything) {
+    for (uint8_t r = 0; r < within->count; ++r) {
+      const DirtyRect &rect = within->rects[r];
+      int16_t tx1 = static_cast<int16_t>((rect.x + rect.w + FRAME_TILE_PX - 1) / FRAME_TILE_PX);
+      int16_t ty1 = static_cast<int16_t>((rect.y + rect.h + FRAME_TILE_PX - 1) / FRAME_TILE_PX);
+      for (int16_t ty = rect.y / FRAME_TILE_PX; ty < ty1 && ty < rows; ++ty) {
+        for (int16_t tx = rect.x / FRAME_TILE_PX; tx < tx1 && tx < cols; ++tx) {
+          considered[ty * cols + tx] = true;
+        }
+      }
+    }
+  }
+
+  const int16_t rowBytes = static_cast<int16_t>(width / 8);
+  uint16_t count = 0;
+  for (uint8_t ty = 0; ty < rows; ++ty) {
+    for (uint8_t tx = 0; tx < cols; ++tx) {
+      uint16_t index = static_cast<uint16_t>(ty * cols + tx);
+      if (!considered[index]) continue;
+
+      int16_t x0 = static_cast<int16_t>(tx * FRAME_TILE_PX);
+      int16_t y0 = static_cast<int16_t>(ty * FRAME_TILE_PX);
+      int16_t x1 = static_cast<int16_t>(x0 + FRAME_TILE_PX > width ? width : x0 + FRAME_TILE_PX);
+      int16_t y1 = static_cast<int16_t>(y0 + FRAME_TILE_PX > height ? height : y0 + FRAME_TILE_PX);
+      uint32_t hash = hashTile(frame, rowBytes, x0, y0, x1, y1);
+      if (!stale && hash == tiles.hash[index]) continue;
+
+      tiles.hash[index] = hash;
+      DirtyRect tile = {x0, y0, static_cast<int16_t>(x1 - x0),
+                        static_cast<int16_t>(y1 - y0)};
+      dirtyAdd(changed, tile, width, height);
+      ++count;
+    }
+  }
+
+  tiles.valid = true;
+  tiles.cols = cols;
+  tiles.rows = rows;
+  return count;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "dirty_rects.h"
+
+/**
+ * @file frame_tiles.h
+ * @brief Per-tile hashes of the 1bpp framebuffer.
+ *
+ * A frame can differ in its draw calls and still come out pixel-identical
+ * (a redrawn label, a bar at the same width). Hashing the framebuffer in
+ * 16x16 tiles after drawing and comparing with the hashes of what the panel
+ * shows turns "something was drawn" into "these tiles look different", so
+ * identical frames are never pushed and changed frames push only their tiles.
+ *
+ * Pure code: no Arduino, safe to build on the host.
+ */
+
+/** @brief Tile edge in pixels; a multiple of 8 so tiles are whole bytes wide. */
+static const int16_t FRAME_TILE_PX = 16;
+/** @brief Tiles tracked; enough for the 200x200 panel (13 x 13). */
+static const uint16_t FRAME_TILE_MAX = 13 * 13;
+
+/** @brief Hashes of the frame the panel shows. */
+struct FrameTiles {
+  /** @brief Whether `hash` describes the panel; cleared by `frameTilesReset()`. */
+  bool valid;
+  uint8_t cols;
+  uint8_t rows;
+  uint32_t hash[FRAME_TILE_MAX];
+};
+
+/**
+ * @brief Forget the panel contents; the next update treats every tile as changed.
+ * @param tiles Hashes to reset.
+ */
+void frameTilesReset(FrameTiles &tiles);
+/**
+ * @brief Rehash tiles and report the ones that no longer match.
+ *
+ * Only tiles overlapping `within` are hashed; the rest cannot have changed.
+ * Stored hashes are updated, so the caller must bring the reported tiles to
+ * the panel.
+ * @param tiles Hashes of the panel contents.
+ * @param frame Framebuffer, rows of `width / 8` bytes.
+ * @param width Frame width; a multiple of 8.
+ * @param height Frame height.
+ * @param within Regions that may have changed, or `nullptr` for everywhere.
+ * @param changed Receives the changed tiles, merged into rectangles.
+ * @return Number of changed tiles.
+ */
+uint16_t frameTilesUpdate(FrameTiles &tiles, const uint8_t *frame,
+                          int16_t width, int16_t height,
+                          const DirtyRects *within, DirtyRects &changed);
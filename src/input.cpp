@@ -0,0 +1,188 @@
+#include "input.h"
+
+#if defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#else
+#define IRAM_ATTR
+#endif
+
+/**
+ * @file input.cpp
+ * @brief Debounce, the edge ring and gesture recognition.
+ *
+ * The producer side runs in the edge interrupt, which may fire while the
+ * flash cache is off (NVS writes), so it lives in IRAM.
+ */
+
+/** @copydoc inputDebounceReset */
+void inputDebounceReset(InputDebounce &d, uint8_t downMask, uint32_t nowUs) {
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    d.down[i] = (downMask >> i) & 1u;
+    d.lastEdgeUs[i] = nowUs;
+  }
+}
+
+/** @copydoc inputDebounceEdge */
+bool IRAM_ATTR inputDebounceEdge(InputDebounce &d, InputButton button,
+                                 bool levelDown, uint32_t nowUs,
+                                 InputEdge &edge) {
+  const bool quiet = nowUs - d.lastEdgeUs[button] >= INPUT_DEBOUNCE_US;
+  d.lastEdgeUs[button] = nowUs;
+  if (!quiet || levelDown == d.down[button]) return false;
+  d.down[button] = levelDown;
+  edge.timeUs = nowUs;
+  edge.button = button;
+  edge.down = levelDown;
+  return true;
+}
+
+/** @copydoc inputDebounceSync */
+bool IRAM_ATTR inputDebounceSync(InputDebounce &d, InputButton button,
+                                 bool levelDown, uint32_t nowUs,
+                                 InputEdge &edge) {
+  if (nowUs - d.lastEdgeUs[button] < INPUT_DEBOUNCE_US) return false;
+  if (levelDown == d.down[button]) return false;
+  d.down[button] = levelDown;
+  d.lastEdgeUs[button] = nowUs;
+  edge.timeUs = nowUs;
+  edge.button = button;
+  edge.down = levelDown;
+  return true;
+}
+
+/** @copydoc inputDebounceSettled */
+bool inputDebounceSettled(const InputDebounce &d, uint32_t nowUs) {
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    if (nowUs - d.lastEdgeUs[i] < INPUT_DEBOUNCE_US) return false;
+  }
+  return true;
+}
+
+/** @copydoc inputQueuePush */
+bool IRAM_ATTR inputQueuePush(InputQueue &q, const InputEdge &edge) {
+  const uint32_t head = q.head;
+  if (head - __atomic_load_n(&q.tail, __ATOMIC_ACQUIRE) >= INPUT_QUEUE_EDGES) {
+    ++q.dropped;
+    return false;
+  }
+  q.edges[head & (INPUT_QUEUE_EDGES - 1)] = edge;
+  __atomic_store_n(&q.head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+/** @copydoc inputQueuePop */
+bool inputQueuePop(InputQueue &q, InputEdge &edge) {
+  const uint32_t tail = q.tail;
+  if (__atomic_load_n(&q.head, __ATOMIC_ACQUIRE) == tail) return false;
+  edge = q.edges[tail & (INPUT_QUEUE_EDGES - 1)];
+  __atomic_store_n(&q.tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+/** @copydoc inputQueuePending */
+bool inputQueuePending(const InputQueue &q) {
+  return __atomic_load_n(&q.head, __ATOMIC_ACQUIRE) !=
+         __atomic_load_n(&q.tail, __ATOMIC_ACQUIRE);
+}
+
+static InputEvent makeEvent(InputEventKind kind, uint8_t button,
+                            uint8_t heldMask, uint32_t timeUs) {
+  InputEvent event;
+  event.kind = kind;
+  event.button = static_cast<InputButton>(button);
+  event.heldMask = heldMask;
+  event.timeUs = timeUs;
+  return event;
+}
+
+/** Long presses of held buttons due by `nowUs`, oldest press first. */
+static uint8_t emitLongPresses(InputGestures &g, uint32_t nowUs,
+                               InputEvent *out) {
+  uint8_t count = 0;
+  for (;;) {
+    int8_t oldest = -1;
+    for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+      const uint8_t bit = 1u << i;
+      if (!(g.heldMask & bit) || (g.longSentMask & bit)) continue;
+      if (nowUs - g.pressUs[i] < INPUT_LONG_PRESS_US) continue;
+      if (oldest < 0 || (int32_t)(g.pressUs[i] - g.pressUs[oldest]) < 0) {
+        oldest = static_cast<int8_t>(i);
+      }
+    }
+    if (oldest < 0) return count;
+    // A long press replaces the deferred press it started with.
+    g.longSentMask |= 1u << oldest;
+    g.pendingMask &= ~(1u << oldest);
+    out[count++] = makeEvent(INPUT_LONG_PRESS, oldest, g.heldMask,
+                             g.pressUs[oldest] + INPUT_LONG_PRESS_US);
+  }
+}
+
+/** Press (or chord) of button `i` at `timeUs`, then a double press if due. */
+static uint8_t emitPress(InputGestures &g, uint8_t i, InputEventKind kind,
+                         uint8_t heldMask, uint32_t timeUs, InputEvent *out) {
+  const uint8_t bit = 1u << i;
+  uint8_t count = 0;
+  out[count++] = makeEvent(kind, i, heldMask, timeUs);
+  if ((g.doubleArmedMask & bit) &&
+      timeUs - g.lastPressUs[i] <= INPUT_DOUBLE_PRESS_US) {
+    // A third quick press starts a new pair rather than another double.
+    g.doubleArmedMask &= ~bit;
+    out[count++] = makeEvent(INPUT_DOUBLE_PRESS, i, heldMask, timeUs);
+  } else {
+    g.doubleArmedMask |= bit;
+    g.lastPressUs[i] = timeUs;
+  }
+  return count;
+}
+
+/**
+ * Report the deferred press still waiting, if any. There is at most one:
+ * a press is only deferred while no other button is down.
+ */
+static uint8_t flushPending(InputGestures &g, InputEvent *out) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT && g.pendingMask; ++i) {
+    const uint8_t bit = 1u << i;
+    if (!(g.pendingMask & bit)) continue;
+    g.pendingMask &= ~bit;
+    count += emitPress(g, i, INPUT_PRESS, bit, g.pressUs[i], out + count);
+  }
+  return count;
+}
+
+/** @copydoc inputGesturesFeed */
+uint8_t inputGesturesFeed(InputGestures &g, const InputEdge &edge,
+                          InputEvent out[INPUT_EVENTS_PER_EDGE]) {
+  uint8_t count = emitLongPresses(g, edge.timeUs, out);
+  const uint8_t i = edge.button;
+  const uint8_t bit = 1u << i;
+
+  if (!edge.down) {
+    // Let go before the long press: the deferred press happened after all.
+    if (g.pendingMask & bit) count += flushPending(g, out + count);
+    g.heldMask &= ~bit;
+    g.longSentMask &= ~bit;
+    return count;
+  }
+
+  // A deferred press that another button joins is reported first, so the
+  // chord follows it the way it would without deferring.
+  count += flushPending(g, out + count);
+  const uint8_t others = g.heldMask & ~bit;
+  g.heldMask |= bit;
+  g.longSentMask &= ~bit;
+  g.pressUs[i] = edge.timeUs;
+  if (!others && (g.deferMask & bit)) {
+    g.pendingMask |= bit;
+    return count;
+  }
+  return count + emitPress(g, i, others ? INPUT_CHORD : INPUT_PRESS,
+                           g.heldMask, edge.timeUs, out + count);
+}
+
+/** @copydoc inputGesturesPoll */
+uint8_t inputGesturesPoll(InputGestures &g, uint32_t nowUs,
+                          InputEvent out[INPUT_BUTTON_COUNT]) {
+  return emitLongPresses(g, nowUs, out);
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file input.h
+ * @brief Button edges from interrupt to gesture: debounce, a lock-free queue
+ * and long-press, double-press and chord recognition.
+ *
+ * The edge interrupt runs `inputDebounceEdge()` and pushes every accepted
+ * edge, with its `micros()` timestamp, into an `InputQueue`. The loop pops
+ * them in order and feeds `inputGesturesFeed()`, which turns edges into
+ * `InputEvent`s for the dispatcher in logic.cpp; `inputGesturesPoll()` adds
+ * long presses once a button has been held long enough. Nothing is sampled
+ * per loop, so presses made while the loop is blocked (a panel push, an NVS
+ * write) are neither merged nor reordered.
+ *
+ * Timestamps are 32-bit microseconds and wrap every 71 minutes; only
+ * differences are used.
+ *
+ * Pure code: no Arduino, safe to build on the host. The queue is safe for
+ * one producer (the interrupt) and one consumer (the loop); the rest is not
+ * thread-safe.
+ */
+
+/** @brief The five buttons; bit `1 << InputButton` in masks. */
+enum InputButton : uint8_t {
+  INPUT_BUTTON_A,
+  INPUT_BUTTON_B,
+  INPUT_BUTTON_C,
+  /** @brief Top hardware button (GPIO 5). */
+  INPUT_BUTTON_TOP,
+  /** @brief Side hardware button (GPIO 27). */
+  INPUT_BUTTON_SIDE,
+  INPUT_BUTTON_COUNT
+};
+
+/** @brief Edges closer than this to the previous one are contact bounce. */
+static const uint32_t INPUT_DEBOUNCE_US = 20UL * 1000UL;
+/** @brief Hold time that makes a press a long press. */
+static const uint32_t INPUT_LONG_PRESS_US = 800UL * 1000UL;
+/** @brief Largest gap between two presses of a double press. */
+static const uint32_t INPUT_DOUBLE_PRESS_US = 400UL * 1000UL;
+/** @brief Edges buffered between loop iterations; a power of two. */
+static const uint8_t INPUT_QUEUE_EDGES = 64;
+/**
+ * @brief Most events one edge can produce: long presses or deferred presses
+ * of held buttons, then press or chord, then double press.
+ */
+static const uint8_t INPUT_EVENTS_PER_EDGE = INPUT_BUTTON_COUNT + 2;
+
+/** @brief One debounced state change of one button. */
+struct InputEdge {
+  /** @brief `micros()` when the change started. */
+  uint32_t timeUs;
+  InputButton button;
+  /** @brief `true` for press, `false` for release. */
+  bool down;
+};
+
+/** @brief Single-producer, single-consumer ring of edges. */
+struct InputQueue {
+  InputEdge edges[INPUT_QUEUE_EDGES];
+  /** @brief Next slot to write; only the producer stores it. */
+  uint32_t head;
+  /** @brief Next slot to read; only the consumer stores it. */
+  uint32_t tail;
+  /** @brief Edges lost because the ring was full. */
+  uint32_t dropped;
+};
+
+/** @brief Per-button debounce state for the producer. */
+struct InputDebounce {
+  bool down[INPUT_BUTTON_COUNT];
+  uint32_t lastEdgeUs[INPUT_BUTTON_COUNT];
+};
+
+/** @brief What a button did. */
+enum InputEventKind : uint8_t {
+  /**
+   * @brief Went down while no other button was held. For buttons in
+   * `InputGestures::deferMask`, reported once the press turns out not to be
+   * a long one (on release, or when another button joins it), dated to the
+   * press.
+   */
+  INPUT_PRESS,
+  /**
+   * @brief Second press within `INPUT_DOUBLE_PRESS_US` of the first; follows
+   * its press.
+   */
+  INPUT_DOUBLE_PRESS,
+  /** @brief Still down `INPUT_LONG_PRESS_US` after the press; once per hold. */
+  INPUT_LONG_PRESS,
+  /**
+   * @brief Went down while other buttons were held; dispatchers treat chords
+   * they have no use for as a press.
+   */
+  INPUT_CHORD
+};
+
+/** @brief One event for the dispatcher. */
+struct InputEvent {
+  InputEventKind kind;
+  /** @brief Button the event is about. */
+  InputButton button;
+  /** @brief Chord: every button down, this one included. */
+  uint8_t heldMask;
+  /** @brief `micros()` of the edge behind it (long press: press + hold time). */
+  uint32_t timeUs;
+};
+
+/** @brief Gesture recognizer state for the consumer. */
+struct InputGestures {
+  /**
+   * @brief Buttons whose long press means something else than their press,
+   * so the press waits until the hold cannot become a long press. Set by
+   * the consumer; everything else starts zeroed.
+   */
+  uint8_t deferMask;
+  uint8_t heldMask;
+  /** @brief Buttons whose current hold already produced a long press. */
+  uint8_t longSentMask;
+  /** @brief Deferred presses not reported yet. */
+  uint8_t pendingMask;
+  uint32_t pressUs[INPUT_BUTTON_COUNT];
+  /** @brief Last press that can still start a double press, per button. */
+  uint32_t lastPressUs[INPUT_BUTTON_COUNT];
+  uint8_t doubleArmedMask;
+};
+
+/**
+ * @brief Start debouncing from known button levels.
+ * @param d State to reset.
+ * @param downMask Buttons down right now.
+ * @param nowUs Current `micros()`.
+ */
+void inputDebounceReset(InputDebounce &d, uint8_t downMask, uint32_t nowUs);
+/**
+ * @brief Filter one raw edge: the first edge after a quiet spell moves the
+ * button to the level read with it, the bounce right after it is ignored.
+ *
+ * An edge whose level matches the state the button is already in changes
+ * nothing. That drops the spurious edges ADC1 causes on GPIO 36/39 (ESP32
+ * errata 3.11); a real edge read mid-bounce is caught up by
+ * `inputDebounceSync()` once the button is quiet.
+ * @param d Debounce state.
+ * @param button Button that saw an edge.
+ * @param levelDown Its level, read in the interrupt.
+ * @param nowUs Current `micros()`.
+ * @param edge Receives the state change when there is one.
+ * @return `true` when `edge` is a real state change.
+ */
+bool inputDebounceEdge(InputDebounce &d, InputButton button, bool levelDown,
+                       uint32_t nowUs, InputEdge &edge);
+/**
+ * @brief Catch up with a level that no edge reported (the edge interrupt
+ * was off during light sleep, or bounce left the state inverted).
+ * @param d Debounce state.
+ * @param button Button sampled.
+ * @param levelDown Its level right now.
+ * @param nowUs Current `micros()`.
+ * @param edge Receives the state change when there is one.
+ * @return `true` when the button was quiet and its state was wrong.
+ */
+bool inputDebounceSync(InputDebounce &d, InputButton button, bool levelDown,
+                       uint32_t nowUs, InputEdge &edge);
+
+/**
+ * @brief Whether every button has been quiet for `INPUT_DEBOUNCE_US`, so
+ * `inputDebounceSync()` would see settled levels.
+ * @param d Debounce state.
+ * @param nowUs Current `micros()`.
+ * @return `false` while an edge is still inside its debounce window.
+ */
+bool inputDebounceSettled(const InputDebounce &d, uint32_t nowUs);
+
+/**
+ * @brief Append an edge (producer side).
+ * @param q Queue.
+ * @param edge Edge to add.
+ * @return `false` if the ring was full; `q.dropped` counts it.
+ */
+bool inputQueuePush(InputQueue &q, const InputEdge &edge);
+/**
+ * @brief Take the oldest edge (consumer side).
+ * @param q Queue.
+ * @param edge Receives it.
+ * @return `false` when empty.
+ */
+bool inputQueuePop(InputQueue &q, InputEdge &edge);
+/**
+ * @brief Whether edges are waiting (either side).
+ * @param q Queue.
+ * @return `true` when at least one edge can be popped.
+ */
+bool inputQueuePending(const InputQueue &q);
+
+/**
+ * @brief Turn one edge into events, in the order they happened.
+ *
+ * Long presses that fell due before the edge come first, so a hold that
+ * ended while the loop was blocked still counts as one.
+ * @param g Recognizer state.
+ * @param edge Next edge from the queue.
+ * @param out Receives up to `INPUT_EVENTS_PER_EDGE` events.
+ * @return Number of events written.
+ */
+uint8_t inputGesturesFeed(InputGestures &g, const InputEdge &edge,
+                          InputEvent out[INPUT_EVENTS_PER_EDGE]);
+/**
+ * @brief Emit a long press for every button held past `INPUT_LONG_PRESS_US`.
+ * @param g Recognizer state.
+ * @param nowUs Current `micros()`.
+ * @param out Receives up to `INPUT_BUTTON_COUNT` events.
+ * @return Number of events written.
+ */
+uint8_t inputGesturesPoll(InputGestures &g, uint32_t nowUs,
+                          InputEvent out[INPUT_BUTTON_COUNT]);
@@ -1,60 +1,23 @@
 #include "logic.h"
+#include "event_log.h"
+#include "metrics.h"
+#include "trace.h"
+#include "ui.h"
 
-#include <esp_system.h>
+#include <stdio.h>
 
 /**
  * @file logic.cpp
  * @brief Input processing and gameplay action routing.
  */
 
-template <typename T>
-static auto btnAImpl(T &m5, int) -> decltype((m5.BtnUP)) { return m5.BtnUP; }
-template <typename T>
-static auto btnAImpl(T &m5, long) -> decltype((m5.BtnA)) { return m5.BtnA; }
-template <typename T>
-static auto btnBImpl(T &m5, int) -> decltype((m5.BtnMID)) { return m5.BtnMID; }
-template <typename T>
-static auto btnBImpl(T &m5, long) -> decltype((m5.BtnB)) { return m5.BtnB; }
-template <typename T>
-static auto btnCImpl(T &m5, int) -> decltype((m5.BtnDOWN)) { return m5.BtnDOWN; }
-template <typename T>
-static auto btnCImpl(T &m5, long) -> decltype((m5.BtnC)) { return m5.BtnC; }
-
-static auto btnA() -> decltype(btnAImpl(M5, 0)) { return btnAImpl(M5, 0); }
-static auto btnB() -> decltype(btnBImpl(M5, 0)) { return btnBImpl(M5, 0); }
-static auto btnC() -> decltype(btnCImpl(M5, 0)) { return btnCImpl(M5, 0); }
-
-static const uint8_t GPIO_TOP_HOME = 5;    // top hardware button
-static const uint8_t GPIO_SIDE_QUICK = 27; // side hardware button
 static const uint32_t DEV_SEQUENCE_WINDOW_MS = 5000;
 static const uint32_t MED_GUARANTEE_WINDOW_SECONDS = 30 * 60;
 static const uint8_t DEV_SEQUENCE[] = {0, 0, 2, 1, 2, 1, 0}; // A A C B C B A
 
-static bool gGpioButtonsInit = false;
-static bool gTopWasDown = false;
-static bool gSideWasDown = false;
-
-static void initGpioButtons() {
-  if (gGpioButtonsInit) return;
-
-  pinMode(GPIO_TOP_HOME, INPUT_PULLUP);
-  pinMode(GPIO_SIDE_QUICK, INPUT_PULLUP);
-  gTopWasDown = (digitalRead(GPIO_TOP_HOME) == LOW);
-  gSideWasDown = (digitalRead(GPIO_SIDE_QUICK) == LOW);
-  gGpioButtonsInit = true;
-}
-
-static bool readGpioPressed(uint8_t pin, bool &wasDown) {
-  bool isDown = (digitalRead(pin) == LOW);
-  bool pressed = isDown && !wasDown;
-  wasDown = isDown;
-  return pressed;
-}
-
 static uint32_t nowEpochOrLastKnown() {
-  uint32_t nowEpoch = 0;
-  if (getCurrentEpoch(nowEpoch)) return nowEpoch;
-  return gState.lastEpoch;
+  const ClockSnapshot &now = clockNow();
+  return now.valid ? now.epoch : gState.lastEpoch;
 }
 
 static void resetDevSequenceState() {
@@ -62,8 +25,7 @@ static void resetDevSequenceState() {
   gRun.devSeqStartedMs = 0;
 }
 
-static bool updateDevSequence(uint8_t key) {
-  uint32_t now = millis();
+static bool updateDevSequence(uint8_t key, uint32_t now) {
   if (gRun.devSeqLen > 0 &&
       now - gRun.devSeqStartedMs > DEV_SEQUENCE_WINDOW_MS) {
     resetDevSequenceState();
@@ -84,6 +46,7 @@ static bool updateDevSequence(uint8_t key) {
     if (gRun.devSeqLen == sizeof(DEV_SEQUENCE)) {
       gRun.devModeUnlocked = true;
       gRun.debugOverlay = false;
+      gRun.debugPage = 0;
       resetDevSequenceState();
       showMessage("DEV MODE", 1500);
       return true;
@@ -155,7 +118,7 @@ static void doMedicine() {
                     (nowEpoch - gState.lastMedicineEpoch <=
                      MED_GUARANTEE_WINDOW_SECONDS);
 
-  bool cured = guaranteed || ((esp_random() % 100) < 85);
+  bool cured = guaranteed || (rngBelow(gState.rng, 100) < 85);
 
   if (nowEpoch != 0) {
     gState.lastMedicineEpoch = nowEpoch;
@@ -164,6 +127,7 @@ static void doMedicine() {
   if (cured) {
     gState.sick = false;
     gState.medGuaranteePending = false;
+    eventLogAppend(EVENT_CURED, nowEpoch, guaranteed ? 1 : 0);
     showMessage("Recovered", 1300);
   } else {
     gState.medGuaranteePending = true;
@@ -173,6 +137,7 @@ static void doMedicine() {
 
 static void doScold() {
   if (resolveTantrumByScold()) {
+    eventLogAppend(EVENT_TANTRUM_RESOLVED, nowEpochOrLastKnown(), 0);
     gState.discipline = clampU8(gState.discipline + 15);
     gState.happiness = clampU8(gState.happiness - 8);
     showMessage("Scolded", 1200);
@@ -189,6 +154,7 @@ static void doLightToggle() {
 }
 
 static void doGameReset() {
+  eventLogAppend(EVENT_RESET, nowEpochOrLastKnown(), gState.ageMinutes);
   defaultState();
   gRun.menuIndex = 0;
   gRun.inventoryIndex = 0;
@@ -197,10 +163,11 @@ static void doGameReset() {
   gRun.mgTarget = 0;
   gRun.mgDeadlineMs = 0;
   gRun.debugOverlay = false;
+  gRun.debugPage = 0;
   resetDevSequenceState();
   gRun.screen = SCREEN_HOME;
   showMessage("Game reset", 1600);
-  saveState(true);
+  flushSave();
 }
 
 static void applyInventoryUse(ItemType item) {
@@ -267,6 +234,7 @@ static void buyItem(ItemType item) {
     return;
   }
   gState.coins -= kItems[item].cost;
+  eventLogAppend(EVENT_PURCHASE, nowEpochOrLastKnown(), item);
   uint8_t count = inventoryCount(item);
   if (count < 99) {
     setInventoryCount(item, count + 1);
@@ -283,12 +251,12 @@ static void handleInventorySelect() {
     buyItem(item);
   }
   markDirty();
-  saveState(true);
+  requestSave(SAVE_USER);
 }
 
 static void startMiniGame() {
   gRun.mgActive = true;
-  gRun.mgTarget = esp_random() % 3;
+  gRun.mgTarget = rngBelow(gState.rng, 3);
   gRun.mgDeadlineMs = millis() + 5000;
 }
 
@@ -302,7 +270,7 @@ static void resolveMiniGame(bool success) {
     gState.happiness = clampU8(gState.happiness - 5);
     showMessage("Missed it", 1200);
   }
-  saveState(true);
+  requestSave(SAVE_USER);
 }
 
 static void handleMenuSelect() {
@@ -353,50 +321,34 @@ static void handleMenuSelect() {
       break;
   }
   markDirty();
-  saveState(true);
+  requestSave(SAVE_USER);
 }
 
-/** @copydoc handleButtons */
-void handleButtons() {
-  initGpioButtons();
-
-  bool a = btnA().wasPressed();
-  bool b = btnB().wasPressed();
-  bool c = btnC().wasPressed();
-  bool top = readGpioPressed(GPIO_TOP_HOME, gTopWasDown);
-  bool side = readGpioPressed(GPIO_SIDE_QUICK, gSideWasDown);
-
-  if (top) {
+/** Act on one press of `button` made at `atMs` (`millis()` time). */
+static void dispatchPress(InputButton button, uint32_t atMs) {
+  if (button == INPUT_BUTTON_TOP) {
     goHomeShortcut();
     return;
   }
-  if (side) {
+  if (button == INPUT_BUTTON_SIDE) {
     sideQuickAction();
     return;
   }
 
-  if (a && updateDevSequence(0)) return;
-  if (b && updateDevSequence(1)) return;
-  if (c && updateDevSequence(2)) return;
+  if (updateDevSequence(button, atMs)) return;
 
   if (gRun.screen == SCREEN_MINIGAME && gRun.mgActive) {
-    if (a) {
-      resolveMiniGame(gRun.mgTarget == 0);
-      markDirty();
-    } else if (b) {
-      resolveMiniGame(gRun.mgTarget == 1);
-      markDirty();
-    } else if (c) {
-      resolveMiniGame(gRun.mgTarget == 2);
-      markDirty();
-    } else if (millis() > gRun.mgDeadlineMs) {
+    // Judged by when the press happened, not when the loop got to it.
+    if (static_cast<int32_t>(atMs - gRun.mgDeadlineMs) > 0) {
       resolveMiniGame(false);
-      markDirty();
+    } else {
+      resolveMiniGame(gRun.mgTarget == button);
     }
+    markDirty();
     return;
   }
 
-  if (a) {
+  if (button == INPUT_BUTTON_A) {
     switch (gRun.screen) {
       case SCREEN_HOME:
         gRun.screen = SCREEN_MENU;
@@ -430,7 +382,7 @@ void handleButtons() {
     markDirty();
   }
 
-  if (b) {
+  if (button == INPUT_BUTTON_B) {
     switch (gRun.screen) {
       case SCREEN_HOME:
         if (gState.asleep)
@@ -443,8 +395,22 @@ void handleButtons() {
         break;
       case SCREEN_STATUS:
         if (gRun.devModeUnlocked) {
-          gRun.debugOverlay = !gRun.debugOverlay;
-          showMessage(gRun.debugOverlay ? "Debug ON" : "Debug OFF", 1100);
+          // Off -> page 1 -> ... -> last page -> off.
+          if (!gRun.debugOverlay) {
+            gRun.debugOverlay = true;
+            gRun.debugPage = 0;
+          } else if (++gRun.debugPage >= DEBUG_OVERLAY_PAGES) {
+            gRun.debugOverlay = false;
+            gRun.debugPage = 0;
+          }
+          if (gRun.debugOverlay) {
+            char msg[16];
+            snprintf(msg, sizeof(msg), "Debug %u/%u", gRun.debugPage + 1,
+                     DEBUG_OVERLAY_PAGES);
+            showMessage(msg, 1100);
+          } else {
+            showMessage("Debug OFF", 1100);
+          }
         } else {
           gRun.screen = SCREEN_INVENTORY;
         }
@@ -472,7 +438,7 @@ void handleButtons() {
     markDirty();
   }
 
-  if (c) {
+  if (button == INPUT_BUTTON_C) {
     switch (gRun.screen) {
       case SCREEN_HOME:
         gRun.screen = SCREEN_STATUS;
@@ -506,6 +472,85 @@ void handleButtons() {
   }
 }
 
+/**
+ * Jump to the first (`last == false`) or last entry of the current list.
+ * @return `false` when the screen has no list.
+ */
+static bool jumpToListEnd(bool last) {
+  switch (gRun.screen) {
+    case SCREEN_MENU:
+      gRun.menuIndex = last ? kMenuCount - 1 : 0;
+      break;
+    case SCREEN_INVENTORY:
+      gRun.inventoryIndex = last ? ITEM_COUNT - 1 : 0;
+      break;
+    default:
+      return false;
+  }
+  markDirty();
+  return true;
+}
+
+/**
+ * Act on one input event. Besides plain presses: holding A or C jumps to the
+ * first or last entry of a list (elsewhere it is a press), tapping the top
+ * button twice opens Status, and pressing top and side together asks for a
+ * save, which the scheduler writes once the buttons are quiet. Any other
+ * chord is just a press.
+ */
+static void dispatchInput(const InputEvent &event, uint32_t atMs) {
+  switch (event.kind) {
+    case INPUT_PRESS:
+      dispatchPress(event.button, atMs);
+      break;
+    case INPUT_CHORD:
+      if (event.heldMask ==
+          ((1u << INPUT_BUTTON_TOP) | (1u << INPUT_BUTTON_SIDE))) {
+        requestSave(SAVE_USER);
+        showMessage("Saving", 900);
+      } else {
+        dispatchPress(event.button, atMs);
+      }
+      break;
+    case INPUT_DOUBLE_PRESS:
+      if (event.button == INPUT_BUTTON_TOP) {
+        gRun.screen = SCREEN_STATUS;
+        markDirty();
+      }
+      break;
+    case INPUT_LONG_PRESS:
+      // Their press was held back for this; off a list it is just a press,
+      // made when the button went down.
+      if ((LOGIC_LONG_PRESS_BUTTONS & (1u << event.button)) &&
+          !jumpToListEnd(event.button == INPUT_BUTTON_C)) {
+        dispatchPress(event.button, atMs - INPUT_LONG_PRESS_US / 1000);
+      }
+      break;
+  }
+}
+
+/** @copydoc handleMiniGameTimeout */
+void handleMiniGameTimeout(bool pressHeld) {
+  if (gRun.screen != SCREEN_MINIGAME || !gRun.mgActive || pressHeld) return;
+  if (millis() > gRun.mgDeadlineMs) {
+    resolveMiniGame(false);
+    markDirty();
+  }
+}
+
+/** @copydoc handleInputEvents */
+void handleInputEvents(const InputEvent *events, uint8_t count) {
+  // The same instant on both clocks, to date each event in `millis()` time.
+  const uint32_t nowUs = micros();
+  const uint32_t nowMs = millis();
+  if (count > 0) gRun.lastUiActionMs = nowMs;
+  for (uint8_t i = 0; i < count; ++i) {
+    TRACE_SCOPE("dispatchInput");
+    metricObserve(METRIC_INPUT_US, nowUs - events[i].timeUs);
+    dispatchInput(events[i], nowMs - (nowUs - events[i].timeUs) / 1000);
+  }
+}
+
 /** @copydoc handleMessageTimeout */
 void handleMessageTimeout() {
   if (gRun.screen != SCREEN_MESSAGE) return;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "input.h"
 #include "pet.h"
 
 /**
@@ -10,9 +11,29 @@
  */
 
 /**
- * @brief Process hardware/input button events and trigger game actions.
+ * @brief Buttons with a long-press binding (A and C jump to the ends of a
+ * list). Their press must wait for the release, or the press would leave
+ * the list before the long press arrives; the input task sets this as
+ * `InputGestures::deferMask`.
  */
-void handleButtons();
+static const uint8_t LOGIC_LONG_PRESS_BUTTONS =
+    (1u << INPUT_BUTTON_A) | (1u << INPUT_BUTTON_C);
+
+/**
+ * @brief Act on presses, long presses, double presses and chords (see
+ * input.h) in the order they happened.
+ * @param events Events from the input task, oldest first.
+ * @param count Number of events.
+ */
+void handleInputEvents(const InputEvent *events, uint8_t count);
+
+/**
+ * @brief Lose the running mini-game round once its deadline has passed.
+ * @param pressHeld A press of a `LOGIC_LONG_PRESS_BUTTONS` button is held
+ * and not reported yet. It may have been made in time, so the round waits
+ * for it and lets its timestamp decide.
+ */
+void handleMiniGameTimeout(bool pressHeld);
 
 /**
  * @brief Dismiss message screen when its timeout expires.
@@ -1,18 +1,25 @@
 #include <M5CoreInk.h>
 #include <esp_system.h>
 
-#include "logic.h"
+#include "app_tasks.h"
+#include "event_log.h"
 #include "pet.h"
 #include "sound.h"
+#include "trace.h"
 #include "ui.h"
+#include "wake.h"
 
 /**
  * @brief Firmware initialization entry point.
  *
- * Boots hardware, restores state, and gently informs the pet that time is real.
+ * Boots hardware, restores state, and hands over to the tasks, which gently
+ * inform the pet that time is real.
  */
 void setup() {
+  TRACE_SCOPE("setup");
   M5.begin();
+  Serial.begin(115200);
+  wakeSourcesBegin();
 
   if (!M5.M5Ink.isInit()) {
     while (1) {
@@ -20,25 +27,30 @@ void setup() {
     }
   }
 
+  // Back from deep sleep the panel still shows the pet; the first frame
+  // redraws it without a blank flash or a tune in between.
+  const WakeBoot boot = wakeBootReason();
   createSpriteCompat(gSprite, 0, 0, SCREEN_W, SCREEN_H, true, 0);
   clearSpriteCompat(gSprite, 0);
-  pushSpriteCompat(gSprite, 0);
-
-  playStartupTune();
+  if (boot == WAKE_BOOT_COLD) {
+    pushSpriteCompat(gSprite, 0);
+    playStartupTune();
+  }
 
   randomSeed(esp_random());
 
+  eventLogMountPartition();
+
   bool loaded = loadState();
   if (!loaded) {
     defaultState();
   }
 
-  applyOfflineProgress();
   gRun.screen = SCREEN_HOME;
   gRun.lastScreen = SCREEN_HOME;
-  gRun.lastUiActionMs = millis();
-  gRun.lastSaveMs = millis();
-  gRun.lastTickMs = millis();
+  // A timer wake had nobody at the buttons, so it may deep-sleep again at once.
+  gRun.lastUiActionMs =
+      millis() - (boot == WAKE_BOOT_TIMER ? WAKE_DEEP_IDLE_MS : 0);
   gRun.menuIndex = 0;
   gRun.inventoryIndex = 0;
   gRun.helpScroll = 0;
@@ -49,22 +61,17 @@ void setup() {
   gRun.devSeqStartedMs = 0;
   gRun.dirty = true;
 
-  saveState(true);
+  // A wake from deep sleep restored the pet from the RTC mirror, which
+  // already queued anything NVS has not seen.
+  if (boot == WAKE_BOOT_COLD) requestSave(SAVE_USER);
+  // The game task starts by catching up with the time spent off.
+  appTasksStart();
 }
 
 /**
- * @brief Main firmware loop.
+ * @brief Arduino loop task, unused.
  *
- * Poll input, run simulation, render if needed, repeat forever because deadlines.
+ * Everything runs on the tasks `appTasksStart()` started; this one deletes
+ * itself.
  */
-void loop() {
-  M5.update();
-
-  handleButtons();
-  handleMessageTimeout();
-  advanceTime();
-  handleIdle();
-  renderScreen();
-
-  delay(10);
-}
+void loop() { vTaskDelete(nullptr); }
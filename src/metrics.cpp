@@ -0,0 +1,114 @@
+#include "metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @file metrics.cpp
+ * @brief The metric table and its text forms.
+ */
+
+const uint32_t kMetricBucketBounds[METRIC_BUCKETS - 1] = {100, 1000, 10000,
+                                                          100000, 1000000};
+
+static const MetricDef kMetricDefs[METRIC_COUNT] = {
+    {"nvs.writes", "NVS W", METRIC_COUNTER},
+    {"nvs.bytes", "NVS B", METRIC_COUNTER},
+    {"frames.rendered", "FR R", METRIC_COUNTER},
+    {"frames.pushed", "FR P", METRIC_COUNTER},
+    {"refresh.full", "RF F", METRIC_COUNTER},
+    {"refresh.partial", "RF P", METRIC_COUNTER},
+    {"rtc.reads", "RTC", METRIC_COUNTER},
+    {"sim.minutes", "SIM M", METRIC_COUNTER},
+    {"catchup.us", "CATCH", METRIC_HISTOGRAM},
+    {"loop.us", "LOOP", METRIC_HISTOGRAM},
+    {"sleep.ms", "SLEEP", METRIC_HISTOGRAM},
+    {"input.us", "INPUT", METRIC_HISTOGRAM},
+    {"input.dropped", "IN DRP", METRIC_GAUGE},
+    {"heap.free", "HEAP", METRIC_GAUGE},
+    {"heap.min", "HEAPMN", METRIC_GAUGE},
+};
+
+static MetricValue gMetrics[METRIC_COUNT];
+
+/** @copydoc metricDef */
+const MetricDef &metricDef(MetricId id) { return kMetricDefs[id]; }
+
+/** @copydoc metricValue */
+const MetricValue &metricValue(MetricId id) { return gMetrics[id]; }
+
+/** @copydoc metricRead */
+uint32_t metricRead(MetricId id) {
+  return __atomic_load_n(&gMetrics[id].value, __ATOMIC_RELAXED);
+}
+
+/** @copydoc metricAdd */
+void metricAdd(MetricId id, uint32_t amount) {
+  // One writer per metric, so a plain read-modify-write is enough; the store
+  // is atomic for readers on other tasks.
+  __atomic_store_n(&gMetrics[id].value, gMetrics[id].value + amount,
+                   __ATOMIC_RELAXED);
+}
+
+/** @copydoc metricSet */
+void metricSet(MetricId id, uint32_t value) {
+  __atomic_store_n(&gMetrics[id].value, value, __ATOMIC_RELAXED);
+}
+
+/** @copydoc metricObserve */
+void metricObserve(MetricId id, uint32_t sample) {
+  MetricValue &m = gMetrics[id];
+  ++m.value;
+  m.sum += sample;
+  if (sample > m.max) m.max = sample;
+  uint8_t bucket = 0;
+  while (bucket < METRIC_BUCKETS - 1 && sample > kMetricBucketBounds[bucket]) {
+    ++bucket;
+  }
+  ++m.buckets[bucket];
+}
+
+/** @copydoc metricsReset */
+void metricsReset() { memset(gMetrics, 0, sizeof(gMetrics)); }
+
+/** @copydoc metricFormat */
+void metricFormat(MetricId id, char *buf, uint8_t len) {
+  const MetricDef &def = kMetricDefs[id];
+  const MetricValue &m = gMetrics[id];
+  if (def.kind != METRIC_HISTOGRAM) {
+    snprintf(buf, len, "%-6s %lu", def.label, (unsigned long)metricRead(id));
+    return;
+  }
+  unsigned long avg = m.value ? (unsigned long)(m.sum / m.value) : 0;
+  snprintf(buf, len, "%-6s n%lu a%lu m%lu", def.label, (unsigned long)m.value,
+           avg, (unsigned long)m.max);
+}
+
+/** @copydoc metricsWrite */
+void metricsWrite(void (*write)(const char *text, void *ctx), void *ctx) {
+  static const char *const kKindNames[] = {"counter", "gauge", "histogram"};
+  char line[160];
+  for (uint8_t i = 0; i < METRIC_COUNT; ++i) {
+    const MetricDef &def = kMetricDefs[i];
+    const MetricValue &m = gMetrics[i];
+    int used = snprintf(line, sizeof(line), "%s %s %lu", def.name,
+                        kKindNames[def.kind],
+                        (unsigned long)metricRead(static_cast<MetricId>(i)));
+    if (def.kind == METRIC_HISTOGRAM) {
+      used += snprintf(line + used, sizeof(line) - used, " sum=%llu max=%lu",
+                       (unsigned long long)m.sum, (unsigned long)m.max);
+      for (uint8_t b = 0; b < METRIC_BUCKETS; ++b) {
+        if (b < METRIC_BUCKETS - 1) {
+          used += snprintf(line + used, sizeof(line) - used, " le%lu=%lu",
+                           (unsigned long)kMetricBucketBounds[b],
+                           (unsigned long)m.buckets[b]);
+        } else {
+          used += snprintf(line + used, sizeof(line) - used, " inf=%lu",
+                           (unsigned long)m.buckets[b]);
+        }
+      }
+    }
+    snprintf(line + used, sizeof(line) - used, "\n");
+    write(line, ctx);
+  }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file metrics.h
+ * @brief Counters, gauges and histograms for quantifying changes on real
+ * units.
+ *
+ * Every metric is declared up front in `MetricId` and lives in a static
+ * table, so recording never allocates and costs an array index plus an add.
+ * The table is shown as extra pages of the dev-mode debug overlay and can be
+ * dumped over serial.
+ *
+ * Pure code: no Arduino, safe to build on the host. Each metric must be
+ * recorded by one task only (the render task owns the frame and refresh
+ * metrics, the input task `METRIC_INPUT_DROPPED`, the game task the rest).
+ * Counter and gauge values are stored atomically, so any task may read them
+ * with `metricRead()`; dumps from another task may show a histogram
+ * mid-update.
+ */
+
+/** @brief How a metric's value behaves. */
+enum MetricKind : uint8_t {
+  /** @brief Only goes up; `metricAdd()`. */
+  METRIC_COUNTER,
+  /** @brief Last value set; `metricSet()`. */
+  METRIC_GAUGE,
+  /** @brief Distribution over `kMetricBucketBounds`; `metricObserve()`. */
+  METRIC_HISTOGRAM
+};
+
+/** @brief Every metric there is, in display order. */
+enum MetricId : uint8_t {
+  /** @brief Save slots written to NVS. */
+  METRIC_NVS_WRITES,
+  /** @brief Bytes written to NVS by those saves. */
+  METRIC_NVS_BYTES,
+  METRIC_FRAMES_RENDERED,
+  /** @brief Frames that sent anything to the panel. */
+  METRIC_FRAMES_PUSHED,
+  METRIC_REFRESH_FULL,
+  METRIC_REFRESH_PARTIAL,
+  /** @brief Times the RTC was read over I2C. */
+  METRIC_RTC_READS,
+  METRIC_SIM_MINUTES,
+  /** @brief Microseconds per `simulateMinutes()` call. */
+  METRIC_CATCHUP_US,
+  /** @brief Microseconds of work per game-task pass (the idle wait excluded). */
+  METRIC_LOOP_US,
+  /** @brief Milliseconds per light sleep between game-task passes. */
+  METRIC_SLEEP_MS,
+  /** @brief Microseconds from a button edge to its event being handled. */
+  METRIC_INPUT_US,
+  /** @brief Button edges lost to a full input queue. */
+  METRIC_INPUT_DROPPED,
+  /** @brief Free heap in bytes. */
+  METRIC_HEAP_FREE,
+  /** @brief Lowest free heap since boot, in bytes. */
+  METRIC_HEAP_MIN,
+  METRIC_COUNT
+};
+
+/** @brief Histogram buckets: `value <= bound`, plus one for anything larger. */
+static const uint8_t METRIC_BUCKETS = 6;
+
+/** @brief Upper bounds of all but the last histogram bucket. */
+extern const uint32_t kMetricBucketBounds[METRIC_BUCKETS - 1];
+
+/** @brief Static description of a metric. */
+struct MetricDef {
+  /** @brief Name in serial dumps, e.g. `nvs.writes`. */
+  const char *name;
+  /** @brief Label of at most 6 characters for the overlay. */
+  const char *label;
+  MetricKind kind;
+};
+
+/** @brief Current value of a metric. */
+struct MetricValue {
+  /** @brief Counter total, gauge value, or histogram sample count. */
+  uint32_t value;
+  /** @brief Histogram: sum of samples. */
+  uint64_t sum;
+  /** @brief Histogram: largest sample. */
+  uint32_t max;
+  /** @brief Histogram: samples per bucket. */
+  uint32_t buckets[METRIC_BUCKETS];
+};
+
+/**
+ * @brief Describe a metric.
+ * @param id Metric.
+ * @return Its static description.
+ */
+const MetricDef &metricDef(MetricId id);
+/**
+ * @brief Read a metric.
+ * @param id Metric.
+ * @return Its current value.
+ */
+const MetricValue &metricValue(MetricId id);
+/**
+ * @brief Read a counter or gauge, from any task.
+ * @param id Metric.
+ * @return Its current value (a histogram's sample count).
+ */
+uint32_t metricRead(MetricId id);
+/**
+ * @brief Increase a counter.
+ * @param id Counter.
+ * @param amount Increment.
+ */
+void metricAdd(MetricId id, uint32_t amount = 1);
+/**
+ * @brief Set a gauge.
+ * @param id Gauge.
+ * @param value New value.
+ */
+void metricSet(MetricId id, uint32_t value);
+/**
+ * @brief Record one histogram sample.
+ * @param id Histogram.
+ * @param sample Sample value.
+ */
+void metricObserve(MetricId id, uint32_t sample);
+/** @brief Zero every metric. */
+void metricsReset();
+/**
+ * @brief One-line summary for the overlay, at most 32 characters.
+ * @param id Metric.
+ * @param buf Receives the text.
+ * @param len Size of `buf`.
+ */
+void metricFormat(MetricId id, char *buf, uint8_t len);
+/**
+ * @brief Write every metric as `name kind value...` lines, histograms with
+ * count, sum, max and per-bucket counts.
+ * @param write Receives each line.
+ * @param ctx Passed to `write`.
+ */
+void metricsWrite(void (*write)(const char *text, void *ctx), void *ctx);
@@ -4,28 +4,39 @@
 #include <Preferences.h>
 #include <stdint.h>
 
+#include "clock_service.h"
+#include "sim.h"
+
 /**
  * @file pet.h
  * @brief Shared game state and persistence contracts.
  *
- * This is the single source of truth for the pet, the runtime, and every
- * questionable decision that must survive a reboot.
+ * The pet itself lives in sim.h; this adds the runtime, the hardware, and
+ * every questionable decision that must survive a reboot.
  */
 
 /** @brief Screen size for M5 Core Ink. */
 static const int SCREEN_W = 200;
 static const int SCREEN_H = 200;
 
-/**
- * @brief Save metadata and timing constants.
- *
- * Yes, these are magic values. No, they are not self-healing.
- */
-static const uint32_t MAGIC = 0x54414D41; // "TAMA"
-static const uint16_t STATE_VERSION = 2;
+/** @brief Runtime timing constants. */
 static const uint32_t SAVE_INTERVAL_MS = 2 * 60 * 1000;
+/** @brief A burst of player actions is written once it has been quiet this long. */
+static const uint32_t SAVE_QUIET_MS = 4 * 1000;
+/** @brief Pending changes never wait longer than this for a write. */
+static const uint32_t SAVE_MAX_LATENCY_MS = SAVE_INTERVAL_MS;
+/** @brief Battery level at or below which pending changes are written at once. */
+static const uint8_t SAVE_LOW_BATTERY_PERCENT = 5;
+/** @brief How often the save scheduler samples the battery. */
+static const uint32_t SAVE_BATTERY_CHECK_MS = 60 * 1000;
 static const uint32_t TICK_INTERVAL_MS = 60 * 1000;
-static const uint32_t MAX_OFFLINE_MINUTES = 7 * 24 * 60; // one week
+/** @brief How often `getBatteryPercent()` reads the ADC. */
+static const uint32_t BATTERY_SAMPLE_MS = 60 * 1000;
+/**
+ * @brief Most minutes one `advanceTime()` or `applyOfflineProgress()` call
+ * simulates; a longer catch-up answers buttons between slices.
+ */
+static const uint32_t SIM_SLICE_MINUTES = 24 * 60;
 
 /** @brief UI screens the player can navigate through before returning to home anyway. */
 enum Screen {
@@ -39,140 +50,31 @@ enum Screen {
   SCREEN_RESET_CONFIRM
 };
 
-/** @brief High-level mood buckets derived from the stat apocalypse. */
-enum Mood {
-  MOOD_HAPPY,
-  MOOD_OK,
-  MOOD_SAD,
-  MOOD_SLEEPY,
-  MOOD_SICK
-};
-
-/** @brief Growth stages as time and care quality do their thing. */
-enum Stage {
-  STAGE_EGG,
-  STAGE_BABY,
-  STAGE_CHILD,
-  STAGE_TEEN,
-  STAGE_ADULT,
-  STAGE_ELDER
-};
-
-/** @brief Inventory item types available for buying or consuming. */
-enum ItemType {
-  ITEM_FOOD,
-  ITEM_SNACK,
-  ITEM_MED,
-  ITEM_TOY,
-  ITEM_COUNT
-};
-
-/** @brief Attention reasons that can generate care mistakes. */
-enum AttentionReason {
-  ATTN_HUNGER,
-  ATTN_HAPPINESS,
-  ATTN_POOP,
-  ATTN_SICK,
-  ATTN_LIGHTS,
-  ATTN_TANTRUM,
-  ATTN_COUNT
-};
-
-/** @brief Shop/inventory definition for a single item type. */
-struct ItemDef {
-  /** @brief Display name shown in inventory and shop UI. */
-  const char *name;
-  /** @brief Coin cost per purchase. */
-  uint8_t cost;
-};
-
-/** @brief Human-readable labels for each pet stage. */
-extern const char *const kStageNames[];
-/** @brief Human-readable labels for each mood state. */
-extern const char *const kMoodNames[];
-/** @brief Static catalog used by the inventory/shop screen. */
-extern const ItemDef kItems[ITEM_COUNT];
 /** @brief Main menu labels in visual order. */
 extern const char *const kMenuItems[];
 /** @brief Number of entries in `kMenuItems`. */
 extern const uint8_t kMenuCount;
 
-/**
- * @brief Serialized persistent pet state.
- *
- * If this changes, old saves may panic and politely stop loading.
- */
-struct PetState {
-  /** @brief Save signature. */
-  uint32_t magic;
-  /** @brief Save format version. */
-  uint16_t version;
-  /** @brief CRC16 checksum over the struct with this field zeroed. */
-  uint16_t crc;
-
-  /** @brief Last known RTC epoch used for offline progression. */
-  uint32_t lastEpoch;
-  /** @brief Total lifetime in in-game minutes. */
-  uint32_t ageMinutes;
-
-  /** @brief Currency used for purchases. */
-  uint16_t coins;
-  /** @brief Current growth stage encoded as `Stage`. */
-  uint8_t stage;
-
-  uint8_t hunger;      // 0-100
-  uint8_t happiness;   // 0-100
-  uint8_t cleanliness; // 0-100
-  uint8_t energy;      // hidden/internal (legacy)
-  uint8_t health;      // 0-100
-  uint8_t discipline;  // 0-100
-  uint8_t weight;      // 0-100
-
-  uint8_t poop;
-  bool asleep;
-  bool sick;
-  bool lightsOn;
-  bool medGuaranteePending;
-
-  uint8_t invFood;
-  uint8_t invSnack;
-  uint8_t invMed;
-  uint8_t invToy;
-
-  /** @brief Care mistakes accumulated over the pet lifetime. */
-  uint16_t careMistakes;
-  /** @brief Snapshot of `careMistakes` at stage start for stage scoring. */
-  uint16_t stageStartMistakes;
-  /** @brief Sickness chance multiplier in permille (1000 = 1.0x). */
-  uint16_t sicknessRiskPermille;
-
-  /** @brief Minutes spent with low hunger for sickness checks. */
-  uint16_t lowHungerMinutes;
-  /** @brief Minutes spent with low happiness for sickness checks. */
-  uint16_t lowHappinessMinutes;
-
-  /** @brief Per-minute drift accumulators to avoid truncation dead zones. */
-  int16_t hungerAcc;
-  int16_t happinessAcc;
-  int16_t disciplineAcc;
-  int16_t cleanlinessAcc;
-  int16_t healthAcc;
-
-  /** @brief Time accumulators for periodic events. */
-  uint16_t poopMinuteAcc;
-  uint16_t coinMinuteAcc;
-
-  /** @brief Medicine timing and guarantee tracking. */
-  uint32_t lastMedicineEpoch;
-
-  /** @brief Tantrum scheduler and state. */
-  uint32_t nextTantrumEpoch;
-  uint32_t tantrumUntilEpoch;         // 0 when inactive
-  uint32_t tantrumCooldownUntilEpoch; // block retrigger after failure
+/** @brief Who changed the pet, which decides how soon the save is written. */
+enum SaveUrgency {
+  /** @brief Simulation ticks; written within `SAVE_MAX_LATENCY_MS`. */
+  SAVE_BACKGROUND,
+  /** @brief Player actions; written after `SAVE_QUIET_MS` of quiet. */
+  SAVE_USER
+};
 
-  /** @brief Per-reason attention state for care-mistake timing. */
-  uint32_t attentionSinceEpoch[ATTN_COUNT];
-  uint32_t attentionCooldownUntilEpoch[ATTN_COUNT];
+/** @brief Counters for the save scheduler. */
+struct SaveStats {
+  /** @brief Calls to `requestSave()`. */
+  uint32_t requests;
+  /** @brief NVS writes actually performed. */
+  uint32_t writes;
+  /** @brief Requests absorbed into an already pending write. */
+  uint32_t writesAvoided;
+  /** @brief Writes made by `flushSave()` or the low-battery path. */
+  uint32_t forcedWrites;
+  /** @brief Boots that restored the pet from the RTC memory mirror. */
+  uint32_t mirrorRestores;
 };
 
 /**
@@ -185,12 +87,8 @@ struct RuntimeState {
   Screen screen;
   /** @brief Previous screen used when closing transient message overlays. */
   Screen lastScreen;
-  /** @brief Last user interaction timestamp (`millis`). */
+  /** @brief Last button event (`millis`); deep sleep waits for it to age. */
   uint32_t lastUiActionMs;
-  /** @brief Last save timestamp (`millis`). */
-  uint32_t lastSaveMs;
-  /** @brief Last simulation tick timestamp (`millis`). */
-  uint32_t lastTickMs;
   /** @brief Whether screen content needs redraw. */
   bool dirty;
 
@@ -219,6 +117,8 @@ struct RuntimeState {
   bool devModeUnlocked;
   /** @brief Runtime debug overlay visibility toggle. */
   bool debugOverlay;
+  /** @brief Debug overlay page shown, below `DEBUG_OVERLAY_PAGES`. */
+  uint8_t debugPage;
   /** @brief Input ring buffer for the developer sequence. */
   uint8_t devSeqBuf[7];
   /** @brief Number of valid entries currently in `devSeqBuf`. */
@@ -227,35 +127,29 @@ struct RuntimeState {
   uint32_t devSeqStartedMs;
 };
 
-/** @brief Global persistent pet state instance. */
-extern PetState gState;
 /** @brief Global runtime/UI state instance. */
 extern RuntimeState gRun;
 /** @brief NVS preferences storage handle. */
 extern Preferences prefs;
 /** @brief Shared draw sprite bound to the e-ink display. */
 extern Ink_Sprite gSprite;
+/** @brief Save scheduler counters. */
+extern SaveStats gSaveStats;
 
-/**
- * @brief Clamp a stat value into the only acceptable emotional range.
- * @param v Input value.
- * @return Value clamped to [0, 100].
- */
-uint8_t clampU8(int v);
 /**
  * @brief Estimate battery charge percent from the ADC reading.
+ *
+ * The ADC is read at most once per `BATTERY_SAMPLE_MS`; calls in between
+ * return the last reading. Game task only.
  * @return Battery percentage clamped to [0, 100].
  */
 uint8_t getBatteryPercent();
-/**
- * @brief Read current RTC epoch if available.
- * @param outEpoch Output epoch seconds.
- * @return `true` when RTC time is valid.
- */
-bool getCurrentEpoch(uint32_t &outEpoch);
 /**
  * @brief Mark runtime state as needing a redraw and refresh idle timer.
  *
+ * Also refreshes the alert cache, since every action that touches the pet
+ * ends here.
+ *
  * Because nothing says "responsive UI" like a dirty flag.
  */
 void markDirty();
@@ -276,41 +170,68 @@ bool resolveTantrumByScold();
  */
 bool isTantrumActive();
 /**
- * @brief Compute currently active attention reasons as bitmask.
+ * @brief Currently active attention reasons, from the alert cache.
  * @return Bitmask using `AttentionReason` ordinals.
  */
 uint8_t getActiveAlertMask();
 /**
- * @brief Compute count of currently active attention reasons.
+ * @brief Count of currently active attention reasons, from the alert cache.
  * @return Number of active alerts.
  */
 uint8_t getActiveAlertCount();
 /**
- * @brief Compute the pet mood from current stats.
- * @return Derived mood bucket.
+ * @brief Restore the pet from the RTC memory mirror, or else the newest
+ * valid save slot in NVS.
+ * @return `true` if a valid save was loaded; otherwise `false`.
  */
-Mood currentMood();
+bool loadState();
 /**
- * @brief Reset persistent state to a fresh new life.
+ * @brief Mark the pet as changed so the save scheduler writes it later.
  *
- * Fresh meaning "minutes from existential decline."
+ * Player changes are coalesced into one write after `SAVE_QUIET_MS` without
+ * further changes; background changes (simulated minutes) just wait. Either
+ * way nothing stays unsaved longer than `SAVE_MAX_LATENCY_MS`. The RTC memory
+ * mirror is refreshed right away.
+ * @param urgency Who made the change.
  */
-void defaultState();
+void requestSave(SaveUrgency urgency);
 /**
- * @brief Load state from NVS and validate checksum/version.
- * @return `true` if a valid save was loaded; otherwise `false`.
+ * @brief Write pending changes when the quiet window or deadline has passed.
+ *
+ * Call once per loop. Also flushes right away on low battery.
  */
-bool loadState();
+void serviceSaves();
 /**
- * @brief Persist current state to NVS.
- * @param force When `true`, bypasses save interval throttling.
+ * @brief When `serviceSaves()` will next write.
+ * @param dueMs Receives the `millis()` deadline.
+ * @return `false` when nothing is pending.
+ */
+bool saveDueMs(uint32_t &dueMs);
+/**
+ * @brief Write the state to NVS now, whether or not anything is pending.
+ *
+ * For game reset, low battery and before the device powers off.
+ */
+void flushSave();
+/**
+ * @brief Get ready for deep sleep without writing NVS.
+ *
+ * Refreshes the RTC mirror, which carries the pet through the sleep, and
+ * writes out buffered history, which it does not. A pending NVS write is
+ * left to `serviceSaves()`: the mirror marks it unsaved, so the next boot
+ * queues it again.
  */
-void saveState(bool force);
+void mirrorForDeepSleep();
 /**
- * @brief Apply elapsed RTC time to simulate offline progression.
+ * @brief Apply elapsed RTC time to simulate offline progression, at most
+ * `SIM_SLICE_MINUTES` per call and `MAX_OFFLINE_MINUTES` per absence (see
+ * `simCatchUpSlice()`).
+ * @return `true` while more minutes are left; call again.
  */
-void applyOfflineProgress();
+bool applyOfflineProgress();
 /**
- * @brief Advance simulation based on elapsed runtime ticks.
+ * @brief Simulate the whole minutes the clock has moved past `lastEpoch`, at
+ * most `SIM_SLICE_MINUTES` per call and `MAX_OFFLINE_MINUTES` in all.
+ * @return `true` while more minutes are left; call again.
  */
-void advanceTime();
+bool advanceTime();
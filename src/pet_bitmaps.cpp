@@ -0,0 +1,340 @@
+#include "pet_bitmaps.h"
+
+#include <string.h>
+
+/**
+ * @file pet_bitmaps.cpp
+ * @brief Rasterises the pet drawings into bitmaps, once.
+ *
+ * The drawings below are the ones the renderer used to issue as primitives;
+ * the primitives follow the classic Adafruit GFX rasterisation so the baked
+ * pets look the way they always did.
+ */
+
+static const uint8_t STAGE_COUNT = STAGE_ELDER + 1;
+static const uint8_t MOOD_COUNT = MOOD_SICK + 1;
+
+// Boxes cover every drawing with a little room to spare; see bakePetBitmaps().
+static const uint8_t AVATAR_W = 40;
+static const uint8_t AVATAR_H = 44;
+static const int8_t AVATAR_ORIGIN_X = -16;
+static const int8_t AVATAR_ORIGIN_Y = -21;
+static const uint8_t ICON_W = 32;
+static const uint8_t ICON_H = 28;
+static const int8_t ICON_ORIGIN_X = -16;
+static const int8_t ICON_ORIGIN_Y = -14;
+
+/** @brief Bitmap being rasterised; coordinates are relative to its anchor. */
+struct Canvas {
+  uint8_t *bits;
+  uint8_t w;
+  uint8_t h;
+  int8_t originX;
+  int8_t originY;
+  /** @brief Pixels that missed the bitmap. */
+  uint32_t clipped;
+};
+
+static void canvasPixel(Canvas &c, int x, int y) {
+  x -= c.originX;
+  y -= c.originY;
+  if (x < 0 || y < 0 || x >= c.w || y >= c.h) {
+    ++c.clipped;
+    return;
+  }
+  c.bits[y * (c.w / 8) + x / 8] |= static_cast<uint8_t>(0x80 >> (x & 7));
+}
+
+static void canvasLine(Canvas &c, int x0, int y0, int x1, int y1) {
+  int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+  int dy = y1 > y0 ? y0 - y1 : y1 - y0;
+  int sx = x0 < x1 ? 1 : -1;
+  int sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  while (true) {
+    canvasPixel(c, x0, y0);
+    if (x0 == x1 && y0 == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+static void canvasRect(Canvas &c, int x, int y, int w, int h) {
+  canvasLine(c, x, y, x + w - 1, y);
+  canvasLine(c, x, y + h - 1, x + w - 1, y + h - 1);
+  canvasLine(c, x, y, x, y + h - 1);
+  canvasLine(c, x + w - 1, y, x + w - 1, y + h - 1);
+}
+
+static void canvasCircle(Canvas &c, int x0, int y0, int r) {
+  int f = 1 - r;
+  int ddx = 1;
+  int ddy = -2 * r;
+  int x = 0;
+  int y = r;
+  canvasPixel(c, x0, y0 + r);
+  canvasPixel(c, x0, y0 - r);
+  canvasPixel(c, x0 + r, y0);
+  canvasPixel(c, x0 - r, y0);
+  while (x < y) {
+    if (f >= 0) {
+      --y;
+      ddy += 2;
+      f += ddy;
+    }
+    ++x;
+    ddx += 2;
+    f += ddx;
+    canvasPixel(c, x0 + x, y0 + y);
+    canvasPixel(c, x0 - x, y0 + y);
+    canvasPixel(c, x0 + x, y0 - y);
+    canvasPixel(c, x0 - x, y0 - y);
+    canvasPixel(c, x0 + y, y0 + x);
+    canvasPixel(c, x0 - y, y0 + x);
+    canvasPixel(c, x0 + y, y0 - x);
+    canvasPixel(c, x0 - y, y0 - x);
+  }
+}
+
+static int scaleSignedRounded(int value, int numer, int denom) {
+  int mag = value >= 0 ? value : -value;
+  int scaled = (mag * numer + denom / 2) / denom;
+  return value >= 0 ? scaled : -scaled;
+}
+
+static int scaleDimRounded(int value, int numer, int denom) {
+  int scaled = (value * numer + denom / 2) / denom;
+  return scaled < 1 ? 1 : scaled;
+}
+
+static const int STAGE_DRAW_BASE = 24;
+static const int STAGE_DRAW_TARGET = STAGE_DRAW_BASE - 5;
+
+static int stageOffset(int value) {
+  return scaleSignedRounded(value, STAGE_DRAW_TARGET, STAGE_DRAW_BASE);
+}
+
+static int stageRadius(int value) {
+  return scaleDimRounded(value, STAGE_DRAW_TARGET, STAGE_DRAW_BASE);
+}
+
+static int stageDim(int value) {
+  return scaleDimRounded(value, STAGE_DRAW_TARGET, STAGE_DRAW_BASE);
+}
+
+static void drawStageIcon(Canvas &c, int cx, int cy, Stage stage) {
+  switch (stage) {
+    case STAGE_EGG:
+      canvasCircle(c, cx, cy + stageOffset(2), stageRadius(10));
+      canvasCircle(c, cx, cy + stageOffset(-4), stageRadius(8));
+      canvasLine(c, cx + stageOffset(-4), cy + stageOffset(2),
+                 cx + stageOffset(-1), cy + stageOffset(5));
+      canvasLine(c, cx + stageOffset(-1), cy + stageOffset(5),
+                 cx + stageOffset(2), cy + stageOffset(2));
+      canvasLine(c, cx + stageOffset(2), cy + stageOffset(2),
+                 cx + stageOffset(5), cy + stageOffset(5));
+      break;
+    case STAGE_BABY:
+      canvasCircle(c, cx, cy + stageOffset(-4), stageRadius(7));
+      canvasCircle(c, cx, cy + stageOffset(8), stageRadius(6));
+      canvasCircle(c, cx, cy + stageOffset(2), stageRadius(2));
+      canvasLine(c, cx + stageOffset(-3), cy + stageOffset(4),
+                 cx + stageOffset(3), cy + stageOffset(4));
+      break;
+    case STAGE_CHILD:
+      canvasCircle(c, cx, cy + stageOffset(-4), stageRadius(8));
+      canvasRect(c, cx + stageOffset(-6), cy + stageOffset(4),
+                 stageDim(12), stageDim(10));
+      canvasLine(c, cx + stageOffset(-10), cy + stageOffset(6),
+                 cx + stageOffset(-6), cy + stageOffset(8));
+      canvasLine(c, cx + stageOffset(6), cy + stageOffset(8),
+                 cx + stageOffset(10), cy + stageOffset(6));
+      break;
+    case STAGE_TEEN:
+      canvasCircle(c, cx, cy + stageOffset(-4), stageRadius(8));
+      canvasLine(c, cx + stageOffset(-6), cy + stageOffset(-12),
+                 cx + stageOffset(-2), cy + stageOffset(-8));
+      canvasLine(c, cx + stageOffset(0), cy + stageOffset(-12),
+                 cx + stageOffset(2), cy + stageOffset(-8));
+      canvasLine(c, cx + stageOffset(6), cy + stageOffset(-12),
+                 cx + stageOffset(2), cy + stageOffset(-8));
+      canvasRect(c, cx + stageOffset(-5), cy + stageOffset(4),
+                 stageDim(10), stageDim(12));
+      break;
+    case STAGE_ADULT:
+      canvasCircle(c, cx, cy + stageOffset(-5), stageRadius(9));
+      canvasRect(c, cx + stageOffset(-8), cy + stageOffset(4),
+                 stageDim(16), stageDim(12));
+      canvasLine(c, cx + stageOffset(-12), cy + stageOffset(6),
+                 cx + stageOffset(-8), cy + stageOffset(10));
+      canvasLine(c, cx + stageOffset(8), cy + stageOffset(10),
+                 cx + stageOffset(12), cy + stageOffset(6));
+      break;
+    case STAGE_ELDER:
+      canvasCircle(c, cx, cy + stageOffset(-5), stageRadius(8));
+      canvasCircle(c, cx + stageOffset(-4), cy + stageOffset(-5), stageRadius(2));
+      canvasCircle(c, cx + stageOffset(4), cy + stageOffset(-5), stageRadius(2));
+      canvasLine(c, cx + stageOffset(-2), cy + stageOffset(-5),
+                 cx + stageOffset(2), cy + stageOffset(-5));
+      canvasRect(c, cx + stageOffset(-6), cy + stageOffset(4),
+                 stageDim(12), stageDim(10));
+      canvasLine(c, cx + stageOffset(10), cy + stageOffset(2),
+                 cx + stageOffset(10), cy + stageOffset(14));
+      canvasLine(c, cx + stageOffset(8), cy + stageOffset(14),
+                 cx + stageOffset(12), cy + stageOffset(14));
+      break;
+    default:
+      break;
+  }
+}
+
+static void drawMoodFace(Canvas &c, int cx, int cy, Mood mood, int eyeDx,
+                         int eyeDy, int eyeR, int mouthHalf, int mouthDy) {
+  if (mood == MOOD_SLEEPY) {
+    canvasLine(c, cx - eyeDx - 2, cy + eyeDy, cx - eyeDx + 2, cy + eyeDy);
+    canvasLine(c, cx + eyeDx - 2, cy + eyeDy, cx + eyeDx + 2, cy + eyeDy);
+  } else if (mood == MOOD_SICK) {
+    canvasLine(c, cx - eyeDx - 2, cy + eyeDy - 2, cx - eyeDx + 2, cy + eyeDy + 2);
+    canvasLine(c, cx - eyeDx - 2, cy + eyeDy + 2, cx - eyeDx + 2, cy + eyeDy - 2);
+    canvasLine(c, cx + eyeDx - 2, cy + eyeDy - 2, cx + eyeDx + 2, cy + eyeDy + 2);
+    canvasLine(c, cx + eyeDx - 2, cy + eyeDy + 2, cx + eyeDx + 2, cy + eyeDy - 2);
+  } else {
+    canvasCircle(c, cx - eyeDx, cy + eyeDy, eyeR);
+    canvasCircle(c, cx + eyeDx, cy + eyeDy, eyeR);
+  }
+
+  int mouthY = cy + mouthDy;
+  if (mood == MOOD_HAPPY) {
+    canvasLine(c, cx - mouthHalf, mouthY - 2, cx, mouthY + 2);
+    canvasLine(c, cx, mouthY + 2, cx + mouthHalf, mouthY - 2);
+  } else if (mood == MOOD_SAD || mood == MOOD_SICK) {
+    canvasLine(c, cx - mouthHalf, mouthY + 2, cx, mouthY - 2);
+    canvasLine(c, cx, mouthY - 2, cx + mouthHalf, mouthY + 2);
+  } else {
+    canvasLine(c, cx - mouthHalf, mouthY, cx + mouthHalf, mouthY);
+  }
+}
+
+static void drawPetAvatar(Canvas &c, int cx, int cy, Stage stage, Mood mood) {
+  switch (stage) {
+    case STAGE_EGG:
+      canvasCircle(c, cx, cy + 5, 15);
+      canvasCircle(c, cx, cy - 4, 11);
+      canvasLine(c, cx - 7, cy + 4, cx - 3, cy + 8);
+      canvasLine(c, cx - 3, cy + 8, cx + 1, cy + 4);
+      canvasLine(c, cx + 1, cy + 4, cx + 6, cy + 8);
+      drawMoodFace(c, cx, cy + 1, mood, 4, -1, 1, 3, 3);
+      break;
+    case STAGE_BABY:
+      canvasCircle(c, cx, cy - 6, 12);
+      canvasCircle(c, cx, cy + 10, 10);
+      canvasCircle(c, cx, cy + 2, 2);
+      drawMoodFace(c, cx, cy - 6, mood, 4, -2, 1, 3, 4);
+      break;
+    case STAGE_CHILD:
+      canvasCircle(c, cx, cy - 8, 11);
+      canvasRect(c, cx - 10, cy + 2, 20, 16);
+      canvasLine(c, cx - 13, cy + 6, cx - 10, cy + 9);
+      canvasLine(c, cx + 10, cy + 9, cx + 13, cy + 6);
+      drawMoodFace(c, cx, cy - 8, mood, 4, -2, 1, 4, 4);
+      break;
+    case STAGE_TEEN:
+      canvasCircle(c, cx, cy - 8, 11);
+      canvasLine(c, cx - 7, cy -18, cx - 3, cy -13);
+      canvasLine(c, cx, cy -18, cx + 2, cy -13);
+      canvasLine(c, cx + 7, cy -18, cx + 3, cy -13);
+      canvasRect(c, cx - 9, cy + 2, 18, 18);
+      drawMoodFace(c, cx, cy - 8, mood, 4, -2, 1, 4, 4);
+      break;
+    case STAGE_ADULT:
+      canvasCircle(c, cx, cy - 8, 12);
+      canvasRect(c, cx - 11, cy + 2, 22, 20);
+      canvasLine(c, cx - 15, cy + 6, cx - 11, cy + 11);
+      canvasLine(c, cx + 11, cy + 11, cx + 15, cy + 6);
+      drawMoodFace(c, cx, cy - 8, mood, 4, -2, 1, 4, 4);
+      break;
+    case STAGE_ELDER:
+      canvasCircle(c, cx, cy - 8, 11);
+      canvasRect(c, cx - 9, cy + 2, 18, 16);
+      canvasLine(c, cx + 13, cy + 2, cx + 13, cy + 18);
+      canvasLine(c, cx + 11, cy + 18, cx + 15, cy + 18);
+      drawMoodFace(c, cx, cy - 8, mood, 4, -2, 1, 4, 4);
+      break;
+    default:
+      break;
+  }
+}
+
+static uint8_t gAvatarBits[STAGE_COUNT][MOOD_COUNT][AVATAR_W / 8 * AVATAR_H];
+static uint8_t gIconBits[STAGE_COUNT][ICON_W / 8 * ICON_H];
+static PetBitmap gAvatars[STAGE_COUNT][MOOD_COUNT];
+static PetBitmap gIcons[STAGE_COUNT];
+static bool gAvatarBaked[STAGE_COUNT][MOOD_COUNT];
+static bool gIconBaked[STAGE_COUNT];
+
+static Canvas startBitmap(PetBitmap &bitmap, uint8_t *bits, uint8_t w,
+                          uint8_t h, int8_t originX, int8_t originY,
+                          uint16_t id) {
+  memset(bits, 0, (size_t)(w / 8) * h);
+  bitmap.w = w;
+  bitmap.h = h;
+  bitmap.originX = originX;
+  bitmap.originY = originY;
+  bitmap.id = id;
+  bitmap.bits = bits;
+  Canvas c = {bits, w, h, originX, originY, 0};
+  return c;
+}
+
+static uint32_t bakeAvatar(uint8_t stage, uint8_t mood) {
+  Canvas c = startBitmap(gAvatars[stage][mood], gAvatarBits[stage][mood],
+                         AVATAR_W, AVATAR_H, AVATAR_ORIGIN_X, AVATAR_ORIGIN_Y,
+                         static_cast<uint16_t>(stage * MOOD_COUNT + mood));
+  drawPetAvatar(c, 0, 0, static_cast<Stage>(stage), static_cast<Mood>(mood));
+  gAvatarBaked[stage][mood] = true;
+  return c.clipped;
+}
+
+static uint32_t bakeIcon(uint8_t stage) {
+  Canvas c = startBitmap(gIcons[stage], gIconBits[stage], ICON_W, ICON_H,
+                         ICON_ORIGIN_X, ICON_ORIGIN_Y,
+                         static_cast<uint16_t>(0x100 + stage));
+  drawStageIcon(c, 0, 0, static_cast<Stage>(stage));
+  gIconBaked[stage] = true;
+  return c.clipped;
+}
+
+/** @copydoc petAvatarBitmap */
+const PetBitmap &petAvatarBitmap(Stage stage, Mood mood) {
+  uint8_t s = stage < STAGE_COUNT ? static_cast<uint8_t>(stage) : 0;
+  uint8_t m = mood < MOOD_COUNT ? static_cast<uint8_t>(mood)
+                                : static_cast<uint8_t>(MOOD_OK);
+  if (!gAvatarBaked[s][m]) bakeAvatar(s, m);
+  return gAvatars[s][m];
+}
+
+/** @copydoc stageIconBitmap */
+const PetBitmap &stageIconBitmap(Stage stage) {
+  uint8_t s = stage < STAGE_COUNT ? static_cast<uint8_t>(stage) : 0;
+  if (!gIconBaked[s]) bakeIcon(s);
+  return gIcons[s];
+}
+
+/** @copydoc bakePetBitmaps */
+uint32_t bakePetBitmaps() {
+  uint32_t clipped = 0;
+  for (uint8_t s = 0; s < STAGE_COUNT; ++s) {
+    for (uint8_t m = 0; m < MOOD_COUNT; ++m) {
+      clipped += bakeAvatar(s, m);
+    }
+    clipped += bakeIcon(s);
+  }
+  return clipped;
+}
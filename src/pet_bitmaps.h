@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sim.h"
+
+/**
+ * @file pet_bitmaps.h
+ * @brief Pet avatars and stage icons as packed 1bpp bitmaps.
+ *
+ * The pet used to be rebuilt from a dozen circles and lines (and, for the
+ * stage icons, a pile of rounding arithmetic) on every frame. Each stage and
+ * mood is now rasterised once, the first time it is needed, and the renderer
+ * only blits it. Bitmaps use the usual `drawBitmap` layout: rows of
+ * `(w + 7) / 8` bytes, most significant bit leftmost, set bits are ink.
+ *
+ * Pure code: no Arduino, safe to build on the host.
+ */
+
+/** @brief A packed 1bpp image drawn relative to an anchor point. */
+struct PetBitmap {
+  /** @brief Width in pixels; a multiple of 8. */
+  uint8_t w;
+  /** @brief Height in pixels. */
+  uint8_t h;
+  /** @brief Offset of the left edge from the anchor. */
+  int8_t originX;
+  /** @brief Offset of the top edge from the anchor. */
+  int8_t originY;
+  /** @brief Identifies the image, e.g. for draw-call keys. */
+  uint16_t id;
+  /** @brief `h` rows of `w / 8` bytes. */
+  const uint8_t *bits;
+};
+
+/**
+ * @brief The pet for a stage and mood, anchored where the avatar centre was.
+ * @param stage Growth stage; out-of-range values show the egg.
+ * @param mood Mood; out-of-range values show `MOOD_OK`.
+ * @return Baked bitmap.
+ */
+const PetBitmap &petAvatarBitmap(Stage stage, Mood mood);
+/**
+ * @brief The small stage icon of the Status screen, anchored at its centre.
+ * @param stage Growth stage; out-of-range values show the egg.
+ * @return Baked bitmap.
+ */
+const PetBitmap &stageIconBitmap(Stage stage);
+/**
+ * @brief Bake every bitmap now instead of on first use.
+ * @return Pixels that fell outside their bitmap; `0` unless a drawing grew.
+ */
+uint32_t bakePetBitmaps();
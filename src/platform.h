@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sim.h"
+
+/**
+ * @file platform.h
+ * @brief The short list of things the simulation needs from its host.
+ *
+ * The firmware implements these in pet.cpp; host builds bring their own.
+ */
+
+/**
+ * @brief Hardware entropy used to seed new random streams.
+ * @return 32 unpredictable bits.
+ */
+uint32_t platformEntropy();
+
+/**
+ * @brief Receive a notable simulation transition.
+ * @param event What happened.
+ * @param epoch Simulated epoch of the minute it happened in.
+ * @param detail Event-specific value (see `SimEvent`), otherwise `0`.
+ */
+void platformSimEvent(SimEvent event, uint32_t epoch, uint32_t detail);
+
+/**
+ * @brief Free-running 32-bit counter for timing probes (see trace.h), the
+ * same on every core.
+ * @return `esp_timer` microseconds on the device (each core's cycle counter
+ * runs on its own); any steady fine-grained tick on a host.
+ */
+uint32_t platformCycleCount();
+
+/**
+ * @brief Rate of `platformCycleCount()`.
+ * @return Ticks per microsecond.
+ */
+uint32_t platformCyclesPerUs();
+
+/**
+ * @brief Enter the critical section around the probe ring, which every task
+ * records into. Not reentrant; hold it for a few stores at most.
+ */
+void platformLock();
+
+/** @brief Leave the section entered by `platformLock()`. */
+void platformUnlock();
+
+/**
+ * @brief Core the caller runs on, to keep each core's probes on their own
+ * trace row.
+ * @return 0 or 1 on the device; 0 on a host.
+ */
+uint8_t platformCoreId();
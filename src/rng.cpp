@@ -0,0 +1,64 @@
+#include "rng.h"
+
+/**
+ * @file rng.cpp
+ * @brief xoshiro128** generator with splitmix32 seeding.
+ */
+
+static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+static uint32_t splitmix32(uint32_t &x) {
+  uint32_t z = (x += 0x9E3779B9U);
+  z = (z ^ (z >> 16)) * 0x85EBCA6BU;
+  z = (z ^ (z >> 13)) * 0xC2B2AE35U;
+  return z ^ (z >> 16);
+}
+
+/** @copydoc rngSeed */
+void rngSeed(SimRng &rng, uint32_t seed) {
+  uint32_t x = seed;
+  for (int i = 0; i < 4; ++i) {
+    rng.s[i] = splitmix32(x);
+  }
+  if (!rngIsSeeded(rng)) rng.s[0] = 1;
+}
+
+/** @copydoc rngIsSeeded */
+bool rngIsSeeded(const SimRng &rng) {
+  return (rng.s[0] | rng.s[1] | rng.s[2] | rng.s[3]) != 0;
+}
+
+/** @copydoc rngNext */
+uint32_t rngNext(SimRng &rng) {
+  uint32_t *s = rng.s;
+  const uint32_t result = rotl(s[1] * 5, 7) * 9;
+  const uint32_t t = s[1] << 9;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 11);
+
+  return result;
+}
+
+/** @copydoc rngBelow */
+uint32_t rngBelow(SimRng &rng, uint32_t bound) {
+  // Multiply-shift range reduction: one widening multiply, no division.
+  return static_cast<uint32_t>(((uint64_t)rngNext(rng) * bound) >> 32);
+}
+
+/** @copydoc rngBetween */
+uint32_t rngBetween(SimRng &rng, uint32_t minInclusive, uint32_t maxInclusive) {
+  if (maxInclusive <= minInclusive) return minInclusive;
+  uint32_t range = maxInclusive - minInclusive + 1;
+  if (range == 0) return rngNext(rng);
+  return minInclusive + rngBelow(rng, range);
+}
+
+/** @copydoc rngUnit */
+double rngUnit(SimRng &rng) {
+  return ((double)rngNext(rng) + 1.0) / 4294967296.0;
+}
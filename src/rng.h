@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file rng.h
+ * @brief Seedable random stream for every gameplay roll.
+ *
+ * xoshiro128**: four words of state, a few shifts per draw, and exactly the
+ * same misfortune every time you replay the same seed.
+ */
+
+/** @brief Generator state. Persisted with the pet so the stream survives reboots. */
+struct SimRng {
+  /** @brief xoshiro128** state words; all-zero means "not seeded". */
+  uint32_t s[4];
+};
+
+/**
+ * @brief Expand a 32-bit seed into a full generator state.
+ * @param rng Generator to seed.
+ * @param seed Any value, including zero.
+ */
+void rngSeed(SimRng &rng, uint32_t seed);
+/**
+ * @brief Whether the generator holds a usable (non-zero) state.
+ * @param rng Generator to inspect.
+ * @return `true` once seeded.
+ */
+bool rngIsSeeded(const SimRng &rng);
+/**
+ * @brief Draw the next 32 random bits.
+ * @param rng Generator to advance.
+ * @return Uniform 32-bit value.
+ */
+uint32_t rngNext(SimRng &rng);
+/**
+ * @brief Draw a value in `[0, bound)`.
+ * @param rng Generator to advance.
+ * @param bound Exclusive upper bound; `0` yields `0`.
+ * @return Uniform value below `bound`.
+ */
+uint32_t rngBelow(SimRng &rng, uint32_t bound);
+/**
+ * @brief Draw a value in `[minInclusive, maxInclusive]`.
+ * @param rng Generator to advance.
+ * @param minInclusive Lower bound.
+ * @param maxInclusive Upper bound; values below `minInclusive` yield `minInclusive`.
+ * @return Uniform value in range.
+ */
+uint32_t rngBetween(SimRng &rng, uint32_t minInclusive, uint32_t maxInclusive);
+/**
+ * @brief Draw a uniform real in `(0, 1]`, safe to feed into `log()`.
+ * @param rng Generator to advance.
+ * @return Uniform value in `(0, 1]`.
+ */
+double rngUnit(SimRng &rng);
@@ -0,0 +1,92 @@
+#include "rtc_mirror.h"
+
+#include "checksum.h"
+
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @file rtc_mirror.cpp
+ * @brief `RTC_NOINIT_ATTR` mirror of `PetState`, CRC32-checked.
+ */
+
+static const uint32_t MIRROR_MAGIC = 0x4D525254; // "TRRM"
+
+/** @brief Everything the mirror keeps; the CRC covers all fields before it. */
+struct RtcMirror {
+  uint32_t magic;
+  /** @brief Identifies the firmware build that wrote the mirror. */
+  uint32_t buildId;
+  /** @brief Bumped on every update. */
+  uint32_t generation;
+  /** @brief `generation` at the last NVS write. */
+  uint32_t savedGeneration;
+  SaveSlotState slots;
+  PetState state;
+  uint32_t crc;
+};
+
+RTC_NOINIT_ATTR static RtcMirror gMirror;
+
+/** A struct layout only means something to the firmware that wrote it. */
+static uint32_t buildId() {
+  static const char kBuild[] = __DATE__ " " __TIME__;
+  static uint32_t id = 0;
+  if (id == 0) {
+    id = crc32Le(0, reinterpret_cast<const uint8_t *>(kBuild), sizeof(kBuild)) ^
+         (uint32_t)sizeof(RtcMirror) ^ ((uint32_t)STATE_VERSION << 24);
+  }
+  return id;
+}
+
+static uint32_t mirrorCrc() {
+  return crc32Le(0, reinterpret_cast<const uint8_t *>(&gMirror),
+                 offsetof(RtcMirror, crc));
+}
+
+static bool memoryKept() {
+  switch (esp_reset_reason()) {
+    case ESP_RST_DEEPSLEEP:
+    case ESP_RST_SW:
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** @copydoc rtcMirrorRestore */
+bool rtcMirrorRestore(PetState &state, SaveSlotState &slots, bool &unsaved) {
+  if (!memoryKept()) return false;
+  if (gMirror.magic != MIRROR_MAGIC || gMirror.buildId != buildId()) {
+    return false;
+  }
+  if (gMirror.crc != mirrorCrc()) return false;
+
+  state = gMirror.state;
+  slots = gMirror.slots;
+  unsaved = gMirror.generation != gMirror.savedGeneration;
+  return true;
+}
+
+/** @copydoc rtcMirrorUpdate */
+void rtcMirrorUpdate(const PetState &state, const SaveSlotState &slots,
+                     bool saved) {
+  if (gMirror.magic != MIRROR_MAGIC || gMirror.buildId != buildId() ||
+      gMirror.crc != mirrorCrc()) {
+    memset(&gMirror, 0, sizeof(gMirror));
+    gMirror.magic = MIRROR_MAGIC;
+    gMirror.buildId = buildId();
+  }
+
+  ++gMirror.generation;
+  if (saved) gMirror.savedGeneration = gMirror.generation;
+  gMirror.slots = slots;
+  gMirror.state = state;
+  gMirror.crc = mirrorCrc();
+}
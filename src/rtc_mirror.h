@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "save_slots.h"
+#include "sim.h"
+
+/**
+ * @file rtc_mirror.h
+ * @brief Copy of the pet in RTC slow memory for fast wake-ups.
+ *
+ * RTC slow memory survives deep sleep and software resets, so those boots
+ * can restore the pet with a `memcpy` and a CRC instead of reading NVS. The
+ * mirror is refreshed on every save request, so it is never older than the
+ * NVS copy; cold boots and any mismatch fall back to the save slots.
+ */
+
+/**
+ * @brief Restore the pet from the mirror if this boot kept RTC memory.
+ * @param state Restored state; untouched on failure.
+ * @param slots Save slot bookkeeping as of the last NVS write.
+ * @param unsaved Set when the mirror holds changes NVS has not seen yet.
+ * @return `true` when the mirror was valid and used.
+ */
+bool rtcMirrorRestore(PetState &state, SaveSlotState &slots, bool &unsaved);
+/**
+ * @brief Refresh the mirror from the live state.
+ * @param state Current pet.
+ * @param slots Current save slot bookkeeping.
+ * @param saved `true` right after the state was written to NVS.
+ */
+void rtcMirrorUpdate(const PetState &state, const SaveSlotState &slots,
+                     bool saved);
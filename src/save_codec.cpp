@@ -0,0 +1,417 @@
+#include "save_codec.h"
+#include "checksum.h"
+
+#include <string.h>
+
+/**
+ * @file save_codec.cpp
+ * @brief Bit-packed save encoder plus one decoder per save version.
+ */
+
+// Packed layout: u16 SAVE_PACKED_MAGIC, u8 version, u8 body length, body,
+// u16 CRC16 over everything before it. All multi-byte values little-endian.
+static const size_t PACKED_HEADER_BYTES = 4;
+static const size_t PACKED_CRC_BYTES = 2;
+
+/** @brief Minute offset that stands for "epoch not set" (`0`). */
+static const int16_t EPOCH_UNSET = INT16_MIN;
+
+static uint16_t readLe16(const uint8_t *p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static void writeLe16(uint8_t *p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+// Bit streams, least significant bit first.
+
+struct BitWriter {
+  uint8_t *data;
+  size_t capacityBits;
+  size_t bit;
+  bool overflow;
+};
+
+static void putBits(BitWriter &w, uint32_t value, uint8_t bits) {
+  for (uint8_t i = 0; i < bits; ++i, ++w.bit) {
+    if (w.bit >= w.capacityBits) {
+      w.overflow = true;
+      return;
+    }
+    uint8_t mask = static_cast<uint8_t>(1U << (w.bit & 7));
+    if ((value >> i) & 1U) {
+      w.data[w.bit >> 3] |= mask;
+    } else {
+      w.data[w.bit >> 3] &= static_cast<uint8_t>(~mask);
+    }
+  }
+}
+
+/** Write an unsigned value, saturating at the largest value `bits` can hold. */
+static void putClamped(BitWriter &w, uint32_t value, uint8_t bits) {
+  uint32_t max = bits >= 32 ? UINT32_MAX : (1UL << bits) - 1;
+  putBits(w, value > max ? max : value, bits);
+}
+
+static void putSigned(BitWriter &w, int32_t value, uint8_t bits) {
+  int32_t max = (1L << (bits - 1)) - 1;
+  int32_t min = -max - 1;
+  if (value > max) value = max;
+  if (value < min) value = min;
+  putBits(w, static_cast<uint32_t>(value), bits);
+}
+
+struct BitReader {
+  const uint8_t *data;
+  size_t lengthBits;
+  size_t bit;
+  bool overrun;
+};
+
+static uint32_t getBits(BitReader &r, uint8_t bits) {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < bits; ++i, ++r.bit) {
+    if (r.bit >= r.lengthBits) {
+      r.overrun = true;
+      return 0;
+    }
+    if ((r.data[r.bit >> 3] >> (r.bit & 7)) & 1U) {
+      value |= 1UL << i;
+    }
+  }
+  return value;
+}
+
+static int32_t getSigned(BitReader &r, uint8_t bits) {
+  uint32_t raw = getBits(r, bits);
+  if (bits < 32 && (raw & (1UL << (bits - 1)))) {
+    raw |= ~((1UL << bits) - 1);
+  }
+  return static_cast<int32_t>(raw);
+}
+
+/** Epoch as whole minutes after `base`, rounded up onto the minute grid. */
+static int16_t epochToOffset(uint32_t epoch, uint32_t base) {
+  if (epoch == 0) return EPOCH_UNSET;
+  int64_t diff = (int64_t)epoch - (int64_t)base;
+  int64_t minutes = diff >= 0 ? (diff + SECONDS_PER_MINUTE - 1) / SECONDS_PER_MINUTE
+                              : -(-diff / SECONDS_PER_MINUTE);
+  if (minutes > INT16_MAX) minutes = INT16_MAX;
+  if (minutes < -INT16_MAX) minutes = -INT16_MAX;
+  return static_cast<int16_t>(minutes);
+}
+
+static uint32_t offsetToEpoch(int16_t offset, uint32_t base) {
+  if (offset == EPOCH_UNSET) return 0;
+  int64_t epoch = (int64_t)base + (int64_t)offset * SECONDS_PER_MINUTE;
+  if (epoch <= 0) return 1;
+  if (epoch > (int64_t)UINT32_MAX) return UINT32_MAX;
+  return static_cast<uint32_t>(epoch);
+}
+
+// Version 4: first packed format.
+
+static void encodeBodyV4(BitWriter &w, const PetState &s) {
+  putBits(w, s.lastEpoch, 32);
+  putBits(w, s.ageMinutes, 32);
+  putClamped(w, s.coins, 10);
+  putClamped(w, s.stage, 3);
+
+  putClamped(w, s.hunger, 7);
+  putClamped(w, s.happiness, 7);
+  putClamped(w, s.cleanliness, 7);
+  putClamped(w, s.energy, 7);
+  putClamped(w, s.health, 7);
+  putClamped(w, s.discipline, 7);
+  putClamped(w, s.weight, 7);
+  putClamped(w, s.poop, 7);
+
+  putBits(w, s.asleep, 1);
+  putBits(w, s.sick, 1);
+  putBits(w, s.lightsOn, 1);
+  putBits(w, s.medGuaranteePending, 1);
+
+  putBits(w, s.invFood, 8);
+  putBits(w, s.invSnack, 8);
+  putBits(w, s.invMed, 8);
+  putBits(w, s.invToy, 8);
+
+  putBits(w, s.careMistakes, 16);
+  putBits(w, s.stageStartMistakes, 16);
+  putBits(w, s.sicknessRiskPermille, 16);
+  putBits(w, s.lowHungerMinutes, 16);
+  putBits(w, s.lowHappinessMinutes, 16);
+
+  putSigned(w, s.hungerAcc, 8);
+  putSigned(w, s.happinessAcc, 8);
+  putSigned(w, s.disciplineAcc, 8);
+  putSigned(w, s.cleanlinessAcc, 8);
+  putSigned(w, s.healthAcc, 8);
+  putClamped(w, s.poopMinuteAcc, 8);
+  putClamped(w, s.coinMinuteAcc, 4);
+
+  const uint32_t base = s.lastEpoch;
+  putSigned(w, epochToOffset(s.lastMedicineEpoch, base), 16);
+  putSigned(w, epochToOffset(s.nextTantrumEpoch, base), 16);
+  putSigned(w, epochToOffset(s.tantrumUntilEpoch, base), 16);
+  putSigned(w, epochToOffset(s.tantrumCooldownUntilEpoch, base), 16);
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    putSigned(w, epochToOffset(s.attentionSinceEpoch[i], base), 16);
+    putSigned(w, epochToOffset(s.attentionCooldownUntilEpoch[i], base), 16);
+  }
+
+  for (uint8_t i = 0; i < 4; ++i) {
+    putBits(w, s.rng.s[i], 32);
+  }
+  putClamped(w, s.sickChancePpm, 20);
+  putBits(w, s.sickMinutesLeft, 32);
+}
+
+static void decodeBodyV4(BitReader &r, PetState &s) {
+  s.lastEpoch = getBits(r, 32);
+  s.ageMinutes = getBits(r, 32);
+  s.coins = static_cast<uint16_t>(getBits(r, 10));
+  s.stage = static_cast<uint8_t>(getBits(r, 3));
+
+  s.hunger = static_cast<uint8_t>(getBits(r, 7));
+  s.happiness = static_cast<uint8_t>(getBits(r, 7));
+  s.cleanliness = static_cast<uint8_t>(getBits(r, 7));
+  s.energy = static_cast<uint8_t>(getBits(r, 7));
+  s.health = static_cast<uint8_t>(getBits(r, 7));
+  s.discipline = static_cast<uint8_t>(getBits(r, 7));
+  s.weight = static_cast<uint8_t>(getBits(r, 7));
+  s.poop = static_cast<uint8_t>(getBits(r, 7));
+
+  s.asleep = getBits(r, 1) != 0;
+  s.sick = getBits(r, 1) != 0;
+  s.lightsOn = getBits(r, 1) != 0;
+  s.medGuaranteePending = getBits(r, 1) != 0;
+
+  s.invFood = static_cast<uint8_t>(getBits(r, 8));
+  s.invSnack = static_cast<uint8_t>(getBits(r, 8));
+  s.invMed = static_cast<uint8_t>(getBits(r, 8));
+  s.invToy = static_cast<uint8_t>(getBits(r, 8));
+
+  s.careMistakes = static_cast<uint16_t>(getBits(r, 16));
+  s.stageStartMistakes = static_cast<uint16_t>(getBits(r, 16));
+  s.sicknessRiskPermille = static_cast<uint16_t>(getBits(r, 16));
+  s.lowHungerMinutes = static_cast<uint16_t>(getBits(r, 16));
+  s.lowHappinessMinutes = static_cast<uint16_t>(getBits(r, 16));
+
+  s.hungerAcc = static_cast<int16_t>(getSigned(r, 8));
+  s.happinessAcc = static_cast<int16_t>(getSigned(r, 8));
+  s.disciplineAcc = static_cast<int16_t>(getSigned(r, 8));
+  s.cleanlinessAcc = static_cast<int16_t>(getSigned(r, 8));
+  s.healthAcc = static_cast<int16_t>(getSigned(r, 8));
+  s.poopMinuteAcc = static_cast<uint16_t>(getBits(r, 8));
+  s.coinMinuteAcc = static_cast<uint16_t>(getBits(r, 4));
+
+  const uint32_t base = s.lastEpoch;
+  s.lastMedicineEpoch = offsetToEpoch(getSigned(r, 16), base);
+  s.nextTantrumEpoch = offsetToEpoch(getSigned(r, 16), base);
+  s.tantrumUntilEpoch = offsetToEpoch(getSigned(r, 16), base);
+  s.tantrumCooldownUntilEpoch = offsetToEpoch(getSigned(r, 16), base);
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    s.attentionSinceEpoch[i] = offsetToEpoch(getSigned(r, 16), base);
+    s.attentionCooldownUntilEpoch[i] = offsetToEpoch(getSigned(r, 16), base);
+  }
+
+  for (uint8_t i = 0; i < 4; ++i) {
+    s.rng.s[i] = getBits(r, 32);
+  }
+  s.sickChancePpm = getBits(r, 20);
+  s.sickMinutesLeft = getBits(r, 32);
+}
+
+/** @copydoc encodeSave */
+size_t encodeSave(const PetState &state, uint8_t *out, size_t capacity) {
+  if (capacity < PACKED_HEADER_BYTES + PACKED_CRC_BYTES) return 0;
+
+  size_t bodyCapacity = capacity - PACKED_HEADER_BYTES - PACKED_CRC_BYTES;
+  if (bodyCapacity > UINT8_MAX) bodyCapacity = UINT8_MAX;
+  memset(out, 0, PACKED_HEADER_BYTES + bodyCapacity);
+  BitWriter w = {out + PACKED_HEADER_BYTES, bodyCapacity * 8, 0, false};
+  encodeBodyV4(w, state);
+  if (w.overflow) return 0;
+
+  const size_t bodyLen = (w.bit + 7) / 8;
+  writeLe16(out, SAVE_PACKED_MAGIC);
+  out[2] = static_cast<uint8_t>(STATE_VERSION);
+  out[3] = static_cast<uint8_t>(bodyLen);
+
+  const size_t crcAt = PACKED_HEADER_BYTES + bodyLen;
+  writeLe16(out + crcAt, crc16Modbus(out, crcAt));
+  return crcAt + PACKED_CRC_BYTES;
+}
+
+// Raw struct images written by versions 2 and 3, frozen here so PetState can
+// keep changing. Version 2 is the same layout without the fields from `rng` on.
+
+struct LegacyStateV3 {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t crc;
+  uint32_t lastEpoch;
+  uint32_t ageMinutes;
+  uint16_t coins;
+  uint8_t stage;
+  uint8_t hunger;
+  uint8_t happiness;
+  uint8_t cleanliness;
+  uint8_t energy;
+  uint8_t health;
+  uint8_t discipline;
+  uint8_t weight;
+  uint8_t poop;
+  bool asleep;
+  bool sick;
+  bool lightsOn;
+  bool medGuaranteePending;
+  uint8_t invFood;
+  uint8_t invSnack;
+  uint8_t invMed;
+  uint8_t invToy;
+  uint16_t careMistakes;
+  uint16_t stageStartMistakes;
+  uint16_t sicknessRiskPermille;
+  uint16_t lowHungerMinutes;
+  uint16_t lowHappinessMinutes;
+  int16_t hungerAcc;
+  int16_t happinessAcc;
+  int16_t disciplineAcc;
+  int16_t cleanlinessAcc;
+  int16_t healthAcc;
+  uint16_t poopMinuteAcc;
+  uint16_t coinMinuteAcc;
+  uint32_t lastMedicineEpoch;
+  uint32_t nextTantrumEpoch;
+  uint32_t tantrumUntilEpoch;
+  uint32_t tantrumCooldownUntilEpoch;
+  uint32_t attentionSinceEpoch[6];
+  uint32_t attentionCooldownUntilEpoch[6];
+  uint32_t rng[4];
+  uint32_t sickChancePpm;
+  uint32_t sickMinutesLeft;
+};
+
+static const size_t LEGACY_V2_SIZE = offsetof(LegacyStateV3, rng);
+static const size_t LEGACY_V3_SIZE = sizeof(LegacyStateV3);
+
+static void migrateLegacy(const LegacyStateV3 &in, PetState &s) {
+  s.lastEpoch = in.lastEpoch;
+  s.ageMinutes = in.ageMinutes;
+  s.coins = in.coins;
+  s.stage = in.stage;
+  s.hunger = in.hunger;
+  s.happiness = in.happiness;
+  s.cleanliness = in.cleanliness;
+  s.energy = in.energy;
+  s.health = in.health;
+  s.discipline = in.discipline;
+  s.weight = in.weight;
+  s.poop = in.poop;
+  s.asleep = in.asleep;
+  s.sick = in.sick;
+  s.lightsOn = in.lightsOn;
+  s.medGuaranteePending = in.medGuaranteePending;
+  s.invFood = in.invFood;
+  s.invSnack = in.invSnack;
+  s.invMed = in.invMed;
+  s.invToy = in.invToy;
+  s.careMistakes = in.careMistakes;
+  s.stageStartMistakes = in.stageStartMistakes;
+  s.sicknessRiskPermille = in.sicknessRiskPermille;
+  s.lowHungerMinutes = in.lowHungerMinutes;
+  s.lowHappinessMinutes = in.lowHappinessMinutes;
+  s.hungerAcc = in.hungerAcc;
+  s.happinessAcc = in.happinessAcc;
+  s.disciplineAcc = in.disciplineAcc;
+  s.cleanlinessAcc = in.cleanlinessAcc;
+  s.healthAcc = in.healthAcc;
+  s.poopMinuteAcc = in.poopMinuteAcc;
+  s.coinMinuteAcc = in.coinMinuteAcc;
+  s.lastMedicineEpoch = in.lastMedicineEpoch;
+  s.nextTantrumEpoch = in.nextTantrumEpoch;
+  s.tantrumUntilEpoch = in.tantrumUntilEpoch;
+  s.tantrumCooldownUntilEpoch = in.tantrumCooldownUntilEpoch;
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    s.attentionSinceEpoch[i] = in.attentionSinceEpoch[i];
+    s.attentionCooldownUntilEpoch[i] = in.attentionCooldownUntilEpoch[i];
+  }
+  for (uint8_t i = 0; i < 4; ++i) {
+    s.rng.s[i] = in.rng[i];
+  }
+  s.sickChancePpm = in.sickChancePpm;
+  s.sickMinutesLeft = in.sickMinutesLeft;
+}
+
+/** Version 2 and 3: the raw struct, CRC over the blob with `crc` zeroed. */
+static bool decodeLegacy(const uint8_t *data, size_t len, PetState &out,
+                         uint16_t &version) {
+  LegacyStateV3 tmp;
+  memset(&tmp, 0, sizeof(tmp));
+  memcpy(&tmp, data, len);
+
+  if (len == LEGACY_V2_SIZE) {
+    version = 2;
+  } else if (len == LEGACY_V3_SIZE) {
+    version = 3;
+  } else {
+    return false;
+  }
+  if (tmp.magic != MAGIC || tmp.version != version) return false;
+
+  uint16_t saved = tmp.crc;
+  tmp.crc = 0;
+  if (crc16Modbus(reinterpret_cast<const uint8_t *>(&tmp), len) != saved) {
+    return false;
+  }
+
+  migrateLegacy(tmp, out);
+  return true;
+}
+
+static bool decodePacked(const uint8_t *data, size_t len, PetState &out,
+                         uint16_t &version) {
+  if (len < PACKED_HEADER_BYTES + PACKED_CRC_BYTES) return false;
+
+  const size_t bodyLen = data[3];
+  const size_t crcAt = PACKED_HEADER_BYTES + bodyLen;
+  if (crcAt + PACKED_CRC_BYTES != len) return false;
+  if (crc16Modbus(data, crcAt) != readLe16(data + crcAt)) return false;
+
+  version = data[2];
+  BitReader r = {data + PACKED_HEADER_BYTES, bodyLen * 8, 0, false};
+  switch (version) {
+    case 4:
+      decodeBodyV4(r, out);
+      break;
+    default:
+      return false;
+  }
+  return !r.overrun;
+}
+
+/** @copydoc decodeSave */
+bool decodeSave(const uint8_t *data, size_t len, PetState &out,
+                uint16_t *fromVersion) {
+  if (!data || len < 4) return false;
+
+  PetState tmp;
+  memset(&tmp, 0, sizeof(tmp));
+  uint16_t version = 0;
+
+  bool ok = false;
+  if (readLe16(data) == SAVE_PACKED_MAGIC) {
+    ok = decodePacked(data, len, tmp, version);
+  } else if (len <= sizeof(LegacyStateV3)) {
+    ok = decodeLegacy(data, len, tmp, version);
+  }
+  if (!ok) return false;
+
+  out = tmp;
+  if (fromVersion) *fromVersion = version;
+  return true;
+}
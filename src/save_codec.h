@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+/**
+ * @file save_codec.h
+ * @brief Packed, versioned encoding of `PetState` for NVS.
+ *
+ * New saves are a bit-packed body behind a small header: bools as single
+ * bits, 0-100 stats in 7 bits, and every timer epoch as a signed 16-bit
+ * minute offset from `lastEpoch`. Each format version has its own decoder,
+ * and older saves (including the raw struct images written before the packed
+ * format) are migrated forward on load instead of being thrown away.
+ *
+ * Pure code: no Arduino, no NVS, safe to build on the host.
+ */
+
+/** @brief Signature of packed saves ("TP"). Raw legacy saves start with `MAGIC`. */
+static const uint16_t SAVE_PACKED_MAGIC = 0x5054;
+/** @brief Buffer size that fits any encoded or legacy save blob. */
+static const size_t SAVE_MAX_BLOB_BYTES = 192;
+
+/**
+ * @brief Encode `state` in the current packed format (`STATE_VERSION`).
+ *
+ * Sub-minute parts of timer epochs are rounded up to the next minute after
+ * `lastEpoch`; the simulation only looks at them on those minute boundaries,
+ * so replaying a decoded save gives the same result.
+ * @param state State to encode.
+ * @param out Destination buffer.
+ * @param capacity Size of `out`; `SAVE_MAX_BLOB_BYTES` is always enough.
+ * @return Encoded length in bytes, or `0` if `out` is too small.
+ */
+size_t encodeSave(const PetState &state, uint8_t *out, size_t capacity);
+
+/**
+ * @brief Decode any supported save blob and migrate it to the current layout.
+ * @param data Blob as read from NVS.
+ * @param len Blob length in bytes.
+ * @param out Decoded state; left untouched on failure.
+ * @param fromVersion Optional; receives the version the blob was written in.
+ * @return `true` when the blob was recognised and its checksum matched.
+ */
+bool decodeSave(const uint8_t *data, size_t len, PetState &out,
+                uint16_t *fromVersion);
@@ -0,0 +1,138 @@
+#include "save_slots.h"
+
+#include "checksum.h"
+#include "metrics.h"
+#include "save_codec.h"
+
+#include <string.h>
+
+/**
+ * @file save_slots.cpp
+ * @brief A/B slot selection and writing on top of the save codec.
+ */
+
+static const char *const kSlotKeys[SAVE_SLOT_COUNT] = {"slotA", "slotB"};
+/** @brief Single key used before slots existed. */
+static const char *const LEGACY_KEY = "state";
+static const size_t SLOT_MAX_BYTES = SAVE_MAX_BLOB_BYTES + SAVE_SLOT_OVERHEAD;
+
+static uint32_t readLe32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void writeLe32(uint8_t *p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+/** @copydoc slotSequenceNewer */
+bool slotSequenceNewer(uint32_t a, uint32_t b) {
+  return static_cast<int32_t>(a - b) > 0;
+}
+
+/** @copydoc chooseNewestSlot */
+int8_t chooseNewestSlot(const bool valid[SAVE_SLOT_COUNT],
+                        const uint32_t sequence[SAVE_SLOT_COUNT]) {
+  int8_t best = -1;
+  for (uint8_t i = 0; i < SAVE_SLOT_COUNT; ++i) {
+    if (!valid[i]) continue;
+    if (best < 0 || slotSequenceNewer(sequence[i], sequence[best])) {
+      best = static_cast<int8_t>(i);
+    }
+  }
+  return best;
+}
+
+/** Read one key into `buf`; returns its length, or 0 when missing or too big. */
+static size_t readKey(Preferences &prefs, const char *key, uint8_t *buf,
+                      size_t capacity) {
+  size_t len = prefs.getBytesLength(key);
+  if (len == 0 || len > capacity) return 0;
+  return prefs.getBytes(key, buf, len) == len ? len : 0;
+}
+
+/** Validate a slot record and decode the save inside it. */
+static bool decodeSlot(const uint8_t *rec, size_t len, uint32_t &sequence,
+                       PetState &state, uint16_t &fromVersion) {
+  if (len <= SAVE_SLOT_OVERHEAD) return false;
+  const size_t crcAt = len - 4;
+  if (crc32Le(0, rec, crcAt) != readLe32(rec + crcAt)) return false;
+
+  sequence = readLe32(rec);
+  return decodeSave(rec + 4, crcAt - 4, state, &fromVersion);
+}
+
+/** @copydoc loadNewestSlot */
+bool loadNewestSlot(Preferences &prefs, PetState &out, SaveSlotState &slots,
+                    SlotScan *scan) {
+  SlotScan local;
+  memset(&local, 0, sizeof(local));
+  PetState decoded[SAVE_SLOT_COUNT];
+  uint16_t versions[SAVE_SLOT_COUNT] = {0, 0};
+  uint8_t rec[SLOT_MAX_BYTES];
+
+  prefs.begin(SAVE_NAMESPACE, true);
+  for (uint8_t i = 0; i < SAVE_SLOT_COUNT; ++i) {
+    size_t len = readKey(prefs, kSlotKeys[i], rec, sizeof(rec));
+    local.valid[i] = len > 0 && decodeSlot(rec, len, local.sequence[i],
+                                           decoded[i], versions[i]);
+  }
+  size_t legacyLen = readKey(prefs, LEGACY_KEY, rec, sizeof(rec));
+  prefs.end();
+
+  slots.legacyKey = legacyLen > 0;
+  int8_t best = chooseNewestSlot(local.valid, local.sequence);
+  bool loaded = false;
+  if (best >= 0) {
+    out = decoded[best];
+    local.fromVersion = versions[best];
+    slots.current = best;
+    slots.sequence = local.sequence[best];
+    loaded = true;
+  } else if (legacyLen > 0 && decodeSave(rec, legacyLen, out, &local.fromVersion)) {
+    local.fromLegacyKey = true;
+    slots.current = -1;
+    slots.sequence = 0;
+    loaded = true;
+  } else {
+    slots.current = -1;
+    slots.sequence = 0;
+  }
+
+  if (scan) *scan = local;
+  return loaded;
+}
+
+/** @copydoc writeNextSlot */
+bool writeNextSlot(Preferences &prefs, const PetState &state,
+                   SaveSlotState &slots) {
+  uint8_t rec[SLOT_MAX_BYTES];
+  size_t blobLen = encodeSave(state, rec + 4, SAVE_MAX_BLOB_BYTES);
+  if (blobLen == 0) return false;
+
+  const uint32_t sequence = slots.sequence + 1;
+  const uint8_t target = slots.current == 0 ? 1 : 0;
+  writeLe32(rec, sequence);
+  const size_t crcAt = 4 + blobLen;
+  writeLe32(rec + crcAt, crc32Le(0, rec, crcAt));
+  const size_t len = crcAt + 4;
+
+  prefs.begin(SAVE_NAMESPACE, false);
+  bool ok = prefs.putBytes(kSlotKeys[target], rec, len) == len;
+  if (ok && slots.legacyKey) {
+    prefs.remove(LEGACY_KEY);
+    slots.legacyKey = false;
+  }
+  prefs.end();
+
+  if (ok) {
+    slots.current = static_cast<int8_t>(target);
+    slots.sequence = sequence;
+    metricAdd(METRIC_NVS_WRITES);
+    metricAdd(METRIC_NVS_BYTES, len);
+  }
+  return ok;
+}
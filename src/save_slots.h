@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Preferences.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+/**
+ * @file save_slots.h
+ * @brief Two alternating NVS save slots, so a torn write never loses the pet.
+ *
+ * Each slot holds `[u32 sequence][save blob][u32 CRC32]`. Loading reads both
+ * slots once and keeps the valid one with the newest sequence; saving always
+ * overwrites the other one. A brownout mid-write can only damage the stale
+ * copy.
+ *
+ * Only touches storage through `Preferences`, so the host build runs the same
+ * code against the file-backed stand-in in `host/Preferences.h`.
+ */
+
+/** @brief NVS namespace holding the slots. */
+static const char *const SAVE_NAMESPACE = "tama";
+/** @brief Number of alternating slots. */
+static const uint8_t SAVE_SLOT_COUNT = 2;
+/** @brief Slot record overhead: sequence number plus trailing CRC32. */
+static const size_t SAVE_SLOT_OVERHEAD = 8;
+
+/** @brief Where the last load or save left the slots. */
+struct SaveSlotState {
+  /** @brief Slot holding the newest valid save, or `-1` when there is none. */
+  int8_t current;
+  /** @brief Sequence number of that save; the next write uses one more. */
+  uint32_t sequence;
+  /** @brief Whether the pre-slot `"state"` key still exists and should be removed. */
+  bool legacyKey;
+};
+
+/** @brief What `loadNewestSlot()` found, for diagnostics. */
+struct SlotScan {
+  /** @brief Per-slot validity. */
+  bool valid[SAVE_SLOT_COUNT];
+  /** @brief Per-slot sequence number (meaningful when valid). */
+  uint32_t sequence[SAVE_SLOT_COUNT];
+  /** @brief Save version the chosen blob was written in; `0` if nothing loaded. */
+  uint16_t fromVersion;
+  /** @brief Whether the state came from the pre-slot single `"state"` key. */
+  bool fromLegacyKey;
+};
+
+/**
+ * @brief Whether sequence `a` is newer than `b`, tolerating wrap-around.
+ * @param a Candidate sequence.
+ * @param b Sequence to compare against.
+ * @return `true` if `a` was written after `b`.
+ */
+bool slotSequenceNewer(uint32_t a, uint32_t b);
+/**
+ * @brief Pick the slot to load from per-slot validity and sequence numbers.
+ * @param valid Per-slot validity.
+ * @param sequence Per-slot sequence numbers.
+ * @return Index of the newest valid slot, or `-1` if none is valid.
+ */
+int8_t chooseNewestSlot(const bool valid[SAVE_SLOT_COUNT],
+                        const uint32_t sequence[SAVE_SLOT_COUNT]);
+/**
+ * @brief Load the newest valid save, falling back to the legacy single key.
+ * @param prefs Storage handle (not yet begun).
+ * @param out Decoded state; untouched when nothing valid was found.
+ * @param slots Updated so the next `writeNextSlot()` targets the stale slot.
+ * @param scan Optional; receives what each slot contained.
+ * @return `true` when a save was loaded.
+ */
+bool loadNewestSlot(Preferences &prefs, PetState &out, SaveSlotState &slots,
+                    SlotScan *scan);
+/**
+ * @brief Write `state` into the slot not holding the current save.
+ *
+ * `slots` only advances once the write reported success, so a failed write
+ * leaves the current slot as the one to load.
+ * @param prefs Storage handle (not yet begun).
+ * @param state State to save.
+ * @param slots Slot bookkeeping from the last load or write.
+ * @return `true` when the full record was written.
+ */
+bool writeNextSlot(Preferences &prefs, const PetState &state,
+                   SaveSlotState &slots);
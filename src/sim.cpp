@@ -0,0 +1,975 @@
+#include "sim.h"
+
+#include "metrics.h"
+#include "platform.h"
+#include "trace.h"
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+/**
+ * @file sim.cpp
+ * @brief Platform-free pet simulation: drift, sickness, attention, tantrums,
+ * evolution, and the sleep schedule.
+ *
+ * Everything here is plain arithmetic over `gState`; hardware arrives only
+ * through platform.h, which keeps the whole thing runnable on a laptop.
+ */
+
+PetState gState;
+SimStats gSimStats;
+AlertCache gAlerts;
+
+const char *const kStageNames[] = {
+    "Egg", "Baby", "Child", "Teen", "Adult", "Elder"};
+
+const char *const kMoodNames[] = {
+    "Happy", "Ok", "Sad", "Sleepy", "Sick"};
+
+const ItemDef kItems[ITEM_COUNT] = {
+    {"Food", 3},
+    {"Snack", 5},
+    {"Med", 8},
+    {"Toy", 6}};
+
+static const uint32_t SECONDS_PER_HOUR = 60 * SECONDS_PER_MINUTE;
+static const uint32_t MINUTES_PER_DAY = 24 * 60;
+
+static const uint32_t ATTENTION_DELAY_SECONDS = 15 * SECONDS_PER_MINUTE;
+static const uint32_t ATTENTION_COOLDOWN_SECONDS = 30 * SECONDS_PER_MINUTE;
+static const uint32_t TANTRUM_MIN_SECONDS = 3 * SECONDS_PER_HOUR;
+static const uint32_t TANTRUM_MAX_SECONDS = 6 * SECONDS_PER_HOUR;
+static const uint32_t TANTRUM_DURATION_SECONDS = 10 * SECONDS_PER_MINUTE;
+
+static const uint8_t LOW_STAT_THRESHOLD = 20;
+static const uint8_t GOOD_STAT_THRESHOLD = 60;
+static const int DISCIPLINE_DRAIN_PER_HOUR = 2;
+static const uint16_t POOP_INTERVAL_MINUTES = 50;
+static const uint16_t COIN_INTERVAL_MINUTES = 10;
+static const uint16_t SICK_LOW_HUNGER_MINUTES = 30;
+static const uint16_t SICK_LOW_HAPPINESS_MINUTES = 60;
+
+/** @copydoc clampU8 */
+uint8_t clampU8(int v) {
+  if (v < 0) return 0;
+  if (v > 100) return 100;
+  return static_cast<uint8_t>(v);
+}
+
+static uint32_t randomTantrumOffsetSeconds() {
+  return rngBetween(gState.rng, TANTRUM_MIN_SECONDS, TANTRUM_MAX_SECONDS);
+}
+
+/** @copydoc countAlerts */
+uint8_t countAlerts(uint8_t mask) {
+  uint8_t count = 0;
+  while (mask) {
+    count += (mask & 1U);
+    mask >>= 1U;
+  }
+  return count;
+}
+
+static uint32_t stageEndAgeMinutes(Stage stage) {
+  switch (stage) {
+    case STAGE_EGG:
+      return 15;
+    case STAGE_BABY:
+      return 24 * 60;
+    case STAGE_CHILD:
+      return 72 * 60;
+    case STAGE_TEEN:
+      return 144 * 60;
+    case STAGE_ADULT:
+      return 288 * 60;
+    default:
+      return UINT32_MAX;
+  }
+}
+
+static Stage stageForAgeMinutes(uint32_t ageMinutes) {
+  uint8_t stage = STAGE_EGG;
+  while (stage < STAGE_ELDER &&
+         ageMinutes >= stageEndAgeMinutes(static_cast<Stage>(stage))) {
+    ++stage;
+  }
+  return static_cast<Stage>(stage);
+}
+
+static void applyCareClassModifier(uint16_t mistakesInStage) {
+  int happinessDelta = 0;
+  uint16_t sicknessMultiplier = 1000;
+
+  if (mistakesInStage <= 1) {
+    happinessDelta = 10;
+    sicknessMultiplier = 800;
+  } else if (mistakesInStage <= 3) {
+    happinessDelta = 0;
+    sicknessMultiplier = 1000;
+  } else if (mistakesInStage <= 6) {
+    happinessDelta = -10;
+    sicknessMultiplier = 1200;
+  } else {
+    happinessDelta = -20;
+    sicknessMultiplier = 1400;
+  }
+
+  gState.happiness = clampU8((int)gState.happiness + happinessDelta);
+  gState.sicknessRiskPermille = sicknessMultiplier;
+}
+
+static void evolveIfNeeded(uint32_t nowEpoch) {
+  Stage current = static_cast<Stage>(gState.stage);
+  Stage next = stageForAgeMinutes(gState.ageMinutes);
+  if (next == current) return;
+
+  uint16_t mistakesInStage =
+      (gState.careMistakes >= gState.stageStartMistakes)
+          ? (gState.careMistakes - gState.stageStartMistakes)
+          : gState.careMistakes;
+
+  applyCareClassModifier(mistakesInStage);
+  gState.stage = static_cast<uint8_t>(next);
+  gState.stageStartMistakes = gState.careMistakes;
+  platformSimEvent(SIM_EVENT_EVOLVED, nowEpoch, next);
+}
+
+static bool sleepWindowForStage(Stage stage, uint16_t &sleepMinute,
+                                uint16_t &wakeMinute) {
+  switch (stage) {
+    case STAGE_EGG:
+      return false;
+    case STAGE_BABY:
+      sleepMinute = 20 * 60;
+      wakeMinute = 7 * 60;
+      return true;
+    case STAGE_CHILD:
+      sleepMinute = 21 * 60;
+      wakeMinute = 7 * 60;
+      return true;
+    case STAGE_TEEN:
+      sleepMinute = 22 * 60;
+      wakeMinute = 8 * 60;
+      return true;
+    case STAGE_ADULT:
+      sleepMinute = 23 * 60;
+      wakeMinute = 8 * 60;
+      return true;
+    case STAGE_ELDER:
+      sleepMinute = 21 * 60 + 30;
+      wakeMinute = 7 * 60 + 30;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool isInSleepWindow(uint16_t minuteOfDay, uint16_t sleepMinute,
+                            uint16_t wakeMinute) {
+  if (sleepMinute == wakeMinute) return true;
+
+  if (sleepMinute < wakeMinute) {
+    return minuteOfDay >= sleepMinute && minuteOfDay < wakeMinute;
+  }
+
+  return minuteOfDay >= sleepMinute || minuteOfDay < wakeMinute;
+}
+
+static uint16_t minuteOfDayFromEpoch(uint32_t epoch) {
+  if (epoch == 0) return 0;
+  return static_cast<uint16_t>((epoch / SECONDS_PER_MINUTE) % MINUTES_PER_DAY);
+}
+
+static void syncSleepSchedule(uint32_t epoch) {
+  Stage stage = static_cast<Stage>(gState.stage);
+  uint16_t sleepMinute = 0;
+  uint16_t wakeMinute = 0;
+
+  if (!sleepWindowForStage(stage, sleepMinute, wakeMinute)) {
+    gState.asleep = false;
+    return;
+  }
+
+  bool shouldSleep = isInSleepWindow(minuteOfDayFromEpoch(epoch), sleepMinute,
+                                     wakeMinute);
+
+  if (shouldSleep && !gState.asleep) {
+    gState.asleep = true;
+  }
+
+  if (!shouldSleep && gState.asleep) {
+    gState.asleep = false;
+    gState.lightsOn = true;
+  }
+}
+
+/** @copydoc scheduleNextTantrum */
+void scheduleNextTantrum(uint32_t nowEpoch) {
+  if (nowEpoch == 0) return;
+  gState.nextTantrumEpoch = nowEpoch + randomTantrumOffsetSeconds();
+}
+
+static void addCareMistake(AttentionReason reason, uint32_t nowEpoch) {
+  if (gState.careMistakes < USHRT_MAX) {
+    ++gState.careMistakes;
+  }
+  platformSimEvent(SIM_EVENT_CARE_MISTAKE, nowEpoch, reason);
+}
+
+static uint8_t alertBit(AttentionReason reason, bool active) {
+  return active ? static_cast<uint8_t>(1U << reason) : 0;
+}
+
+static uint8_t alertMaskFor(const PetState &s) {
+  // Expired tantrums are cleared by processTantrum() on the minute, so a
+  // non-zero timer is the active state from the simulation's point of view.
+  return alertBit(ATTN_HUNGER, s.hunger <= LOW_STAT_THRESHOLD) |
+         alertBit(ATTN_HAPPINESS, s.happiness <= LOW_STAT_THRESHOLD) |
+         alertBit(ATTN_POOP, s.poop >= 2) |
+         alertBit(ATTN_SICK, s.sick) |
+         alertBit(ATTN_LIGHTS, s.asleep && s.lightsOn) |
+         alertBit(ATTN_TANTRUM, s.tantrumUntilEpoch != 0);
+}
+
+/** @copydoc syncAlerts */
+void syncAlerts() {
+  uint8_t mask = alertMaskFor(gState);
+  if (mask == gAlerts.mask) return;
+
+  gAlerts.changed |= static_cast<uint8_t>(mask ^ gAlerts.mask);
+  gAlerts.mask = mask;
+  gAlerts.count = countAlerts(mask);
+  ++gAlerts.version;
+}
+
+/** @copydoc takeAlertChanges */
+uint8_t takeAlertChanges() {
+  uint8_t changed = gAlerts.changed;
+  gAlerts.changed = 0;
+  return changed;
+}
+
+static void applySignedRate(uint8_t &stat, int16_t &acc, int ratePerHour) {
+  acc += ratePerHour;
+
+  while (acc >= 60) {
+    stat = clampU8((int)stat + 1);
+    acc -= 60;
+  }
+
+  while (acc <= -60) {
+    stat = clampU8((int)stat - 1);
+    acc += 60;
+  }
+}
+
+static void applyDrainRate(uint8_t &stat, int16_t &acc, int ratePerHour) {
+  applySignedRate(stat, acc, -ratePerHour);
+}
+
+static int hungerDrainPerHour(bool awake) { return awake ? 12 : 3; }
+static int happinessDrainPerHour(bool awake) { return awake ? 8 : 2; }
+
+static void applyPassiveDrift() {
+  const bool awake = !gState.asleep;
+
+  if (awake) {
+    applyDrainRate(gState.hunger, gState.hungerAcc, hungerDrainPerHour(true));
+    applyDrainRate(gState.happiness, gState.happinessAcc,
+                   happinessDrainPerHour(true));
+    applyDrainRate(gState.discipline, gState.disciplineAcc,
+                   DISCIPLINE_DRAIN_PER_HOUR);
+
+    ++gState.poopMinuteAcc;
+    while (gState.poopMinuteAcc >= POOP_INTERVAL_MINUTES) {
+      gState.poopMinuteAcc -= POOP_INTERVAL_MINUTES;
+      if (gState.poop < 99) {
+        ++gState.poop;
+      }
+      gState.cleanliness = clampU8((int)gState.cleanliness - 12);
+    }
+  } else {
+    applyDrainRate(gState.hunger, gState.hungerAcc, hungerDrainPerHour(false));
+    applyDrainRate(gState.happiness, gState.happinessAcc,
+                   happinessDrainPerHour(false));
+  }
+
+  if (gState.poop > 0) {
+    int cleanRate = 2 * (int)gState.poop;
+    applyDrainRate(gState.cleanliness, gState.cleanlinessAcc, cleanRate);
+  }
+}
+
+static void updateLowStatTimers() {
+  if (gState.hunger <= LOW_STAT_THRESHOLD) {
+    if (gState.lowHungerMinutes < USHRT_MAX) ++gState.lowHungerMinutes;
+  } else {
+    gState.lowHungerMinutes = 0;
+  }
+
+  if (gState.happiness <= LOW_STAT_THRESHOLD) {
+    if (gState.lowHappinessMinutes < USHRT_MAX) ++gState.lowHappinessMinutes;
+  } else {
+    gState.lowHappinessMinutes = 0;
+  }
+}
+
+static uint32_t sicknessThresholdPpm(const PetState &s,
+                                     uint16_t lowHungerMinutes,
+                                     uint16_t lowHappinessMinutes) {
+  int chancePerHourPct = 0;
+  if (s.poop >= 3) chancePerHourPct += 15;
+  if (lowHungerMinutes >= SICK_LOW_HUNGER_MINUTES) chancePerHourPct += 10;
+  if (lowHappinessMinutes >= SICK_LOW_HAPPINESS_MINUTES) chancePerHourPct += 10;
+  if (chancePerHourPct > 35) chancePerHourPct = 35;
+
+  int chancePerHourPermille = chancePerHourPct * 10;
+  chancePerHourPermille =
+      (chancePerHourPermille * (int)s.sicknessRiskPermille + 500) / 1000;
+  if (chancePerHourPermille > 950) chancePerHourPermille = 950;
+
+  return (uint32_t)chancePerHourPermille * 1000U / 60U;
+}
+
+// Sickness scheduler.
+//
+// Every awake, healthy minute is a Bernoulli trial with a fixed per-minute
+// chance until one of its inputs changes, so the number of minutes until the
+// pet falls sick is geometric. Drawing that wait once per chance change
+// reproduces the per-minute hazard exactly (the distribution is memoryless)
+// while costing one RNG call instead of one per minute.
+
+static uint32_t drawMinutesUntilSick(uint32_t chancePpm) {
+  // Inverse CDF of the geometric distribution with u in (0, 1].
+  double u = rngUnit(gState.rng);
+  double trials = floor(log(u) / log1p(-(double)chancePpm / 1000000.0)) + 1.0;
+  if (trials >= (double)UINT32_MAX) return UINT32_MAX;
+  return static_cast<uint32_t>(trials);
+}
+
+static void resetSicknessSchedule() {
+  gState.sickChancePpm = 0;
+  gState.sickMinutesLeft = 0;
+}
+
+static void syncSicknessSchedule(uint32_t chancePpm) {
+  if (chancePpm == gState.sickChancePpm) return;
+  gState.sickChancePpm = chancePpm;
+  gState.sickMinutesLeft = chancePpm == 0 ? 0 : drawMinutesUntilSick(chancePpm);
+}
+
+static void maybeApplySicknessChance(uint32_t nowEpoch) {
+  if (gState.asleep || gState.sick) return;
+
+  syncSicknessSchedule(sicknessThresholdPpm(gState, gState.lowHungerMinutes,
+                                            gState.lowHappinessMinutes));
+  if (gState.sickChancePpm == 0) return;
+
+  if (--gState.sickMinutesLeft == 0) {
+    gState.sick = true;
+    resetSicknessSchedule();
+    platformSimEvent(SIM_EVENT_SICK, nowEpoch, 0);
+  }
+}
+
+static void updateAttentionTracking(uint32_t nowEpoch) {
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    bool active = (gAlerts.mask & (1U << i)) != 0;
+
+    if (!active) {
+      gState.attentionSinceEpoch[i] = 0;
+      continue;
+    }
+
+    if (gState.attentionSinceEpoch[i] == 0) {
+      gState.attentionSinceEpoch[i] = nowEpoch;
+    }
+
+    bool overdue =
+        nowEpoch >= gState.attentionSinceEpoch[i] + ATTENTION_DELAY_SECONDS;
+    bool cooldownDone =
+        nowEpoch >= gState.attentionCooldownUntilEpoch[i];
+
+    if (overdue && cooldownDone) {
+      addCareMistake(static_cast<AttentionReason>(i), nowEpoch);
+      gState.attentionCooldownUntilEpoch[i] =
+          nowEpoch + ATTENTION_COOLDOWN_SECONDS;
+    }
+  }
+}
+
+static int healthRatePerHour(uint8_t alertMask) {
+  bool sickWithOtherAlert =
+      gState.sick && ((alertMask & ~(1U << ATTN_SICK)) != 0);
+
+  if (sickWithOtherAlert) return -20;
+  if (countAlerts(alertMask) >= 2) return -12;
+  if (!gState.sick && gState.hunger > GOOD_STAT_THRESHOLD &&
+      gState.happiness > GOOD_STAT_THRESHOLD && gState.poop == 0) {
+    return 4;
+  }
+  return 0;
+}
+
+static void applyHealthRules() {
+  applySignedRate(gState.health, gState.healthAcc,
+                  healthRatePerHour(gAlerts.mask));
+}
+
+static void processTantrum(uint32_t nowEpoch) {
+  if (gState.nextTantrumEpoch == 0) {
+    scheduleNextTantrum(nowEpoch);
+  }
+
+  if (gState.tantrumUntilEpoch != 0 && nowEpoch >= gState.tantrumUntilEpoch) {
+    gState.tantrumUntilEpoch = 0;
+    gState.happiness = clampU8((int)gState.happiness - 10);
+    addCareMistake(ATTN_TANTRUM, nowEpoch);
+    gState.tantrumCooldownUntilEpoch = nowEpoch + ATTENTION_COOLDOWN_SECONDS;
+    scheduleNextTantrum(nowEpoch);
+    platformSimEvent(SIM_EVENT_TANTRUM_IGNORED, nowEpoch, 0);
+    return;
+  }
+
+  if (gState.tantrumUntilEpoch == 0 && !gState.asleep &&
+      nowEpoch >= gState.nextTantrumEpoch &&
+      nowEpoch >= gState.tantrumCooldownUntilEpoch) {
+    gState.tantrumUntilEpoch = nowEpoch + TANTRUM_DURATION_SECONDS;
+    platformSimEvent(SIM_EVENT_TANTRUM_STARTED, nowEpoch, 0);
+  }
+}
+
+static void stepOneMinute(uint32_t nowEpoch) {
+  syncSleepSchedule(nowEpoch);
+  processTantrum(nowEpoch);
+  applyPassiveDrift();
+  updateLowStatTimers();
+  maybeApplySicknessChance(nowEpoch);
+  syncAlerts();
+  updateAttentionTracking(nowEpoch);
+  applyHealthRules();
+
+  ++gState.ageMinutes;
+  ++gState.coinMinuteAcc;
+  while (gState.coinMinuteAcc >= COIN_INTERVAL_MINUTES) {
+    gState.coinMinuteAcc -= COIN_INTERVAL_MINUTES;
+    if (gState.coins < 999) ++gState.coins;
+  }
+
+  evolveIfNeeded(nowEpoch);
+  syncAlerts();
+}
+
+// Fast-forward engine.
+//
+// Between "event horizons" every per-minute rule is either a no-op or a
+// constant-rate drift, so a quiet span can be applied in closed form. Anything
+// that is not provably quiet (boundaries, random rolls, popups) still goes
+// through stepOneMinute(), which keeps the result identical to per-minute
+// stepping for every deterministic rule.
+
+static void limitSpan(uint32_t &span, uint32_t cap) {
+  if (cap < span) span = cap;
+}
+
+/** Number of minutes k >= 1 for which `epoch + k * 60` is still before `target`. */
+static uint32_t minutesBefore(uint32_t epoch, uint32_t target) {
+  if (target <= epoch) return 0;
+  return (target - epoch - 1) / SECONDS_PER_MINUTE;
+}
+
+static bool accNormalized(int16_t acc) { return acc > -60 && acc < 60; }
+
+/** Minutes of draining at `ratePerHour` until the stat has lost `drops` points. */
+static uint32_t minutesUntilDrained(int16_t acc, int ratePerHour, int drops) {
+  if (ratePerHour <= 0) return UINT32_MAX;
+  int32_t need = (int32_t)acc + 60 * drops;
+  return (uint32_t)((need + ratePerHour - 1) / ratePerHour);
+}
+
+/** Quiet minutes left before a draining stat falls to `threshold` or below. */
+static uint32_t minutesAboveThreshold(uint8_t stat, int16_t acc, int ratePerHour,
+                                      uint8_t threshold) {
+  if (stat <= threshold) return UINT32_MAX;
+  return minutesUntilDrained(acc, ratePerHour, stat - threshold) - 1;
+}
+
+static uint32_t quietMinutesBeforeSleepFlip(const PetState &s, uint32_t epoch) {
+  uint16_t sleepMinute = 0;
+  uint16_t wakeMinute = 0;
+  if (!sleepWindowForStage(static_cast<Stage>(s.stage), sleepMinute,
+                           wakeMinute)) {
+    return s.asleep ? 0 : UINT32_MAX;
+  }
+
+  uint32_t nextMinute = (epoch / SECONDS_PER_MINUTE + 1) % MINUTES_PER_DAY;
+  bool shouldSleep = isInSleepWindow(static_cast<uint16_t>(nextMinute),
+                                     sleepMinute, wakeMinute);
+  if (shouldSleep != s.asleep) return 0;
+  if (sleepMinute == wakeMinute) return UINT32_MAX;
+
+  uint32_t flipMinute = s.asleep ? wakeMinute : sleepMinute;
+  return (flipMinute + MINUTES_PER_DAY - nextMinute) % MINUTES_PER_DAY;
+}
+
+/**
+ * Number of minutes after `epoch` (at most `limit`) that are guaranteed to be
+ * free of discrete events, so fastForwardMinutes() reproduces stepOneMinute().
+ */
+static uint32_t quietMinutesAhead(uint32_t epoch, uint32_t limit) {
+  uint32_t span = limit;
+  const bool awake = !gState.asleep;
+
+  if (!accNormalized(gState.hungerAcc) || !accNormalized(gState.happinessAcc) ||
+      !accNormalized(gState.disciplineAcc) ||
+      !accNormalized(gState.cleanlinessAcc) ||
+      !accNormalized(gState.healthAcc)) {
+    return 0;
+  }
+
+  // Evolution and sleep/wake boundaries.
+  Stage stage = static_cast<Stage>(gState.stage);
+  if (stageForAgeMinutes(gState.ageMinutes + 1) != stage) return 0;
+  limitSpan(span, stageEndAgeMinutes(stage) - gState.ageMinutes - 1);
+  limitSpan(span, quietMinutesBeforeSleepFlip(gState, epoch));
+
+  // Tantrum scheduling, expiry and onset.
+  if (gState.nextTantrumEpoch == 0) return 0;
+  if (gState.tantrumUntilEpoch != 0) {
+    limitSpan(span, minutesBefore(epoch, gState.tantrumUntilEpoch));
+  } else if (awake) {
+    uint32_t tantrumGate = gState.nextTantrumEpoch;
+    if (gState.tantrumCooldownUntilEpoch > tantrumGate) {
+      tantrumGate = gState.tantrumCooldownUntilEpoch;
+    }
+    limitSpan(span, minutesBefore(epoch, tantrumGate));
+  }
+
+  // Next poop.
+  if (awake) {
+    if (gState.poopMinuteAcc + 1 >= POOP_INTERVAL_MINUTES) return 0;
+    limitSpan(span, POOP_INTERVAL_MINUTES - 1 - gState.poopMinuteAcc);
+  }
+
+  // Stat threshold crossings that flip alerts or the health recovery rule.
+  const int hungerRate = hungerDrainPerHour(awake);
+  const int happinessRate = happinessDrainPerHour(awake);
+  limitSpan(span, minutesAboveThreshold(gState.hunger, gState.hungerAcc,
+                                        hungerRate, LOW_STAT_THRESHOLD));
+  limitSpan(span, minutesAboveThreshold(gState.hunger, gState.hungerAcc,
+                                        hungerRate, GOOD_STAT_THRESHOLD));
+  limitSpan(span, minutesAboveThreshold(gState.happiness, gState.happinessAcc,
+                                        happinessRate, LOW_STAT_THRESHOLD));
+  limitSpan(span, minutesAboveThreshold(gState.happiness, gState.happinessAcc,
+                                        happinessRate, GOOD_STAT_THRESHOLD));
+
+  // Sickness onset, plus the low-stat timers maturing into a new chance. A
+  // chance change re-draws the countdown, which is left to stepOneMinute().
+  if (awake && !gState.sick && span > 0) {
+    uint16_t lowHunger = gState.lowHungerMinutes;
+    uint16_t lowHappiness = gState.lowHappinessMinutes;
+    if (gState.hunger <= LOW_STAT_THRESHOLD) {
+      if (lowHunger < SICK_LOW_HUNGER_MINUTES) {
+        limitSpan(span, SICK_LOW_HUNGER_MINUTES - 1 - lowHunger);
+      }
+      if (lowHunger < USHRT_MAX) ++lowHunger;
+    } else {
+      lowHunger = 0;
+    }
+    if (gState.happiness <= LOW_STAT_THRESHOLD) {
+      if (lowHappiness < SICK_LOW_HAPPINESS_MINUTES) {
+        limitSpan(span, SICK_LOW_HAPPINESS_MINUTES - 1 - lowHappiness);
+      }
+      if (lowHappiness < USHRT_MAX) ++lowHappiness;
+    } else {
+      lowHappiness = 0;
+    }
+    if (sicknessThresholdPpm(gState, lowHunger, lowHappiness) !=
+        gState.sickChancePpm) {
+      return 0;
+    }
+    if (gState.sickChancePpm != 0) limitSpan(span, gState.sickMinutesLeft - 1);
+  }
+
+  return span;
+}
+
+static void applySignedRateSpan(uint8_t &stat, int16_t &acc, int ratePerHour,
+                                uint32_t minutes) {
+  int32_t total = (int32_t)acc + (int32_t)ratePerHour * (int32_t)minutes;
+  int32_t steps = 0;
+
+  if (total >= 60) {
+    steps = (total - 60) / 60 + 1;
+    total -= steps * 60;
+  } else if (total <= -60) {
+    steps = -((-60 - total) / 60 + 1);
+    total -= steps * 60;
+  }
+
+  stat = clampU8((int)stat + steps);
+  acc = static_cast<int16_t>(total);
+}
+
+static void addLowStatMinutes(uint16_t &counter, uint8_t stat, uint32_t minutes) {
+  if (stat > LOW_STAT_THRESHOLD) {
+    counter = 0;
+    return;
+  }
+  uint32_t total = (uint32_t)counter + minutes;
+  counter = total > USHRT_MAX ? USHRT_MAX : static_cast<uint16_t>(total);
+}
+
+static void fastForwardAttention(uint32_t epoch, uint32_t minutes,
+                                 uint8_t alertMask) {
+  const uint32_t firstEpoch = epoch + SECONDS_PER_MINUTE;
+  const uint32_t lastEpoch = epoch + minutes * SECONDS_PER_MINUTE;
+
+  // Each overdue reason repeats every cooldown from its first mistake;
+  // UINT32_MAX marks a reason with none left in the span.
+  uint32_t nextMistake[ATTN_COUNT];
+
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    nextMistake[i] = UINT32_MAX;
+    if ((alertMask & (1U << i)) == 0) {
+      gState.attentionSinceEpoch[i] = 0;
+      continue;
+    }
+
+    if (gState.attentionSinceEpoch[i] == 0) {
+      gState.attentionSinceEpoch[i] = firstEpoch;
+    }
+
+    uint32_t due = gState.attentionSinceEpoch[i] + ATTENTION_DELAY_SECONDS;
+    if (gState.attentionCooldownUntilEpoch[i] > due) {
+      due = gState.attentionCooldownUntilEpoch[i];
+    }
+    if (due > lastEpoch) continue;
+
+    uint32_t firstMistake = firstEpoch;
+    if (due > firstEpoch) {
+      firstMistake += (due - firstEpoch + SECONDS_PER_MINUTE - 1) /
+                      SECONDS_PER_MINUTE * SECONDS_PER_MINUTE;
+    }
+    uint32_t mistakes =
+        1 + (lastEpoch - firstMistake) / ATTENTION_COOLDOWN_SECONDS;
+    uint32_t total = (uint32_t)gState.careMistakes + mistakes;
+    gState.careMistakes =
+        total > USHRT_MAX ? USHRT_MAX : static_cast<uint16_t>(total);
+    gState.attentionCooldownUntilEpoch[i] =
+        firstMistake + mistakes * ATTENTION_COOLDOWN_SECONDS;
+    nextMistake[i] = firstMistake;
+  }
+
+  // Report them as stepping would: by epoch, and by reason within a minute.
+  for (;;) {
+    uint8_t earliest = 0;
+    for (uint8_t i = 1; i < ATTN_COUNT; ++i) {
+      if (nextMistake[i] < nextMistake[earliest]) earliest = i;
+    }
+    const uint32_t at = nextMistake[earliest];
+    if (at == UINT32_MAX) break;
+    platformSimEvent(SIM_EVENT_CARE_MISTAKE, at, earliest);
+    nextMistake[earliest] = lastEpoch - at >= ATTENTION_COOLDOWN_SECONDS
+                                ? at + ATTENTION_COOLDOWN_SECONDS
+                                : UINT32_MAX;
+  }
+}
+
+/** Apply `minutes` quiet minutes after `epoch` in closed form. */
+static void fastForwardMinutes(uint32_t epoch, uint32_t minutes) {
+  const bool awake = !gState.asleep;
+
+  // Quiet spans never cross a threshold, so the cached alert mask and the
+  // health rate hold for the whole span.
+  const uint8_t alertMask = gAlerts.mask;
+  const int healthRate = healthRatePerHour(alertMask);
+
+  applySignedRateSpan(gState.hunger, gState.hungerAcc,
+                      -hungerDrainPerHour(awake), minutes);
+  applySignedRateSpan(gState.happiness, gState.happinessAcc,
+                      -happinessDrainPerHour(awake), minutes);
+  if (awake) {
+    applySignedRateSpan(gState.discipline, gState.disciplineAcc,
+                        -DISCIPLINE_DRAIN_PER_HOUR, minutes);
+    gState.poopMinuteAcc += minutes;
+  }
+  if (gState.poop > 0) {
+    applySignedRateSpan(gState.cleanliness, gState.cleanlinessAcc,
+                        -2 * (int)gState.poop, minutes);
+  }
+  if (awake && !gState.sick && gState.sickChancePpm != 0) {
+    gState.sickMinutesLeft -= minutes;
+  }
+
+  addLowStatMinutes(gState.lowHungerMinutes, gState.hunger, minutes);
+  addLowStatMinutes(gState.lowHappinessMinutes, gState.happiness, minutes);
+  fastForwardAttention(epoch, minutes, alertMask);
+  applySignedRateSpan(gState.health, gState.healthAcc, healthRate, minutes);
+
+  gState.ageMinutes += minutes;
+  uint32_t coinTicks = gState.coinMinuteAcc + minutes;
+  gState.coinMinuteAcc = coinTicks % COIN_INTERVAL_MINUTES;
+  if (gState.coins < 999) {
+    uint32_t coins = gState.coins + coinTicks / COIN_INTERVAL_MINUTES;
+    gState.coins = coins > 999 ? 999 : static_cast<uint16_t>(coins);
+  }
+}
+
+/** @copydoc simulateMinutes */
+void simulateMinutes(uint32_t startEpoch, uint32_t minutes) {
+  TRACE_SCOPE("simulateMinutes");
+  const uint32_t startCycles = platformCycleCount();
+  if (minutes > MAX_OFFLINE_MINUTES) minutes = MAX_OFFLINE_MINUTES;
+  uint32_t epoch = startEpoch;
+
+  syncAlerts();
+  uint32_t remaining = minutes;
+  while (remaining > 0) {
+    uint32_t quiet = quietMinutesAhead(epoch, remaining);
+    if (quiet > 0) {
+      fastForwardMinutes(epoch, quiet);
+      syncAlerts();
+      epoch += quiet * SECONDS_PER_MINUTE;
+      remaining -= quiet;
+      ++gSimStats.fastForwardSpans;
+      continue;
+    }
+
+    epoch += SECONDS_PER_MINUTE;
+    stepOneMinute(epoch);
+    --remaining;
+    ++gSimStats.steppedMinutes;
+  }
+
+  gSimStats.simulatedMinutes += minutes;
+  metricAdd(METRIC_SIM_MINUTES, minutes);
+  metricObserve(METRIC_CATCHUP_US,
+                (platformCycleCount() - startCycles) / platformCyclesPerUs());
+}
+
+/** @copydoc simCatchUpSlice */
+bool simCatchUpSlice(CatchUp &c, uint32_t nowEpoch, uint32_t sliceMinutes) {
+  if (c.minutesLeft == 0) {
+    if (nowEpoch <= gState.lastEpoch) return false;
+    const uint32_t elapsed = (nowEpoch - gState.lastEpoch) / SECONDS_PER_MINUTE;
+    c.minutesLeft = elapsed < MAX_OFFLINE_MINUTES ? elapsed : MAX_OFFLINE_MINUTES;
+    c.skipMinutes = elapsed - c.minutesLeft;
+    if (c.minutesLeft == 0) return false;
+  }
+
+  const uint32_t minutes =
+      c.minutesLeft < sliceMinutes ? c.minutesLeft : sliceMinutes;
+  simulateMinutes(gState.lastEpoch, minutes);
+  gState.lastEpoch += minutes * SECONDS_PER_MINUTE;
+  c.minutesLeft -= minutes;
+  if (c.minutesLeft > 0) return true;
+
+  gState.lastEpoch += c.skipMinutes * SECONDS_PER_MINUTE;
+  c.skipMinutes = 0;
+  return false;
+}
+
+/** First minute k >= 1 whose epoch `epoch + k * 60` reaches `target`. */
+static uint32_t firstMinuteAt(uint32_t epoch, uint32_t target) {
+  return minutesBefore(epoch, target) + 1;
+}
+
+/** The minute after `quiet` quiet ones; `UINT32_MAX` stays "never". */
+static uint32_t minuteAfter(uint32_t quiet) {
+  return quiet == UINT32_MAX ? quiet : quiet + 1;
+}
+
+/** @copydoc simNextEventEpoch */
+uint32_t simNextEventEpoch(const PetState &s, uint32_t limit) {
+  const uint32_t epoch = s.lastEpoch;
+  const bool awake = !s.asleep;
+  uint32_t minute = limit;
+
+  // Rolls and reschedules the next step makes that nothing here can see.
+  if (!accNormalized(s.hungerAcc) || !accNormalized(s.happinessAcc) ||
+      s.nextTantrumEpoch == 0) {
+    limitSpan(minute, 1);
+  }
+
+  // Sleep/wake, evolution and the day counter.
+  limitSpan(minute, minuteAfter(quietMinutesBeforeSleepFlip(s, epoch)));
+  const uint32_t stageEnd = stageEndAgeMinutes(static_cast<Stage>(s.stage));
+  if (stageEnd != UINT32_MAX) {
+    limitSpan(minute, stageEnd > s.ageMinutes ? stageEnd - s.ageMinutes : 1);
+  }
+  limitSpan(minute, MINUTES_PER_DAY - s.ageMinutes % MINUTES_PER_DAY);
+
+  // Tantrum expiry and onset.
+  if (s.tantrumUntilEpoch != 0) {
+    limitSpan(minute, firstMinuteAt(epoch, s.tantrumUntilEpoch));
+  } else if (awake && s.nextTantrumEpoch != 0) {
+    uint32_t tantrumGate = s.nextTantrumEpoch;
+    if (s.tantrumCooldownUntilEpoch > tantrumGate) {
+      tantrumGate = s.tantrumCooldownUntilEpoch;
+    }
+    limitSpan(minute, firstMinuteAt(epoch, tantrumGate));
+  }
+
+  // Poop, and the stats falling into their alerts.
+  if (awake) {
+    limitSpan(minute, s.poopMinuteAcc < POOP_INTERVAL_MINUTES
+                          ? POOP_INTERVAL_MINUTES - s.poopMinuteAcc
+                          : 1);
+  }
+  limitSpan(minute, minuteAfter(minutesAboveThreshold(
+                        s.hunger, s.hungerAcc, hungerDrainPerHour(awake),
+                        LOW_STAT_THRESHOLD)));
+  limitSpan(minute, minuteAfter(minutesAboveThreshold(
+                        s.happiness, s.happinessAcc,
+                        happinessDrainPerHour(awake), LOW_STAT_THRESHOLD)));
+
+  // Sickness onset. A low-stat timer maturing re-draws the countdown, which
+  // may then land sooner, so that minute counts as an event too.
+  if (awake && !s.sick) {
+    uint16_t lowHunger = s.lowHungerMinutes;
+    uint16_t lowHappiness = s.lowHappinessMinutes;
+    if (s.hunger <= LOW_STAT_THRESHOLD) {
+      if (lowHunger < SICK_LOW_HUNGER_MINUTES) {
+        limitSpan(minute, SICK_LOW_HUNGER_MINUTES - lowHunger);
+      }
+      if (lowHunger < USHRT_MAX) ++lowHunger;
+    } else {
+      lowHunger = 0;
+    }
+    if (s.happiness <= LOW_STAT_THRESHOLD) {
+      if (lowHappiness < SICK_LOW_HAPPINESS_MINUTES) {
+        limitSpan(minute, SICK_LOW_HAPPINESS_MINUTES - lowHappiness);
+      }
+      if (lowHappiness < USHRT_MAX) ++lowHappiness;
+    } else {
+      lowHappiness = 0;
+    }
+    if (sicknessThresholdPpm(s, lowHunger, lowHappiness) != s.sickChancePpm) {
+      limitSpan(minute, 1);
+    } else if (s.sickChancePpm != 0) {
+      limitSpan(minute, s.sickMinutesLeft > 0 ? s.sickMinutesLeft : 1);
+    }
+  }
+
+  // Care mistakes for alerts already up; an alert raised since the last
+  // step starts its clock on the next one.
+  const uint8_t alertMask = alertMaskFor(s);
+  for (uint8_t i = 0; i < ATTN_COUNT; ++i) {
+    if ((alertMask & (1U << i)) == 0) continue;
+    uint32_t since = s.attentionSinceEpoch[i];
+    if (since == 0) since = epoch + SECONDS_PER_MINUTE;
+    uint32_t due = since + ATTENTION_DELAY_SECONDS;
+    if (s.attentionCooldownUntilEpoch[i] > due) {
+      due = s.attentionCooldownUntilEpoch[i];
+    }
+    limitSpan(minute, firstMinuteAt(epoch, due));
+  }
+
+  if (minute == 0) minute = 1;
+  return epoch + minute * SECONDS_PER_MINUTE;
+}
+
+/** @copydoc clampState */
+void clampState() {
+  gState.hunger = clampU8(gState.hunger);
+  gState.happiness = clampU8(gState.happiness);
+  gState.cleanliness = clampU8(gState.cleanliness);
+  gState.energy = clampU8(gState.energy);
+  gState.health = clampU8(gState.health);
+  gState.discipline = clampU8(gState.discipline);
+  gState.weight = clampU8(gState.weight);
+  if (gState.coins > 999) gState.coins = 999;
+  // Saves keep 3 bits of stage; `kStageNames` has no entry past the last one.
+  if (gState.stage > STAGE_ELDER) gState.stage = STAGE_ELDER;
+  if (gState.sicknessRiskPermille == 0) gState.sicknessRiskPermille = 1000;
+  syncAlerts();
+}
+
+static uint32_t initialSeed() {
+#ifdef SIM_RNG_SEED
+  return SIM_RNG_SEED;
+#else
+  return platformEntropy();
+#endif
+}
+
+/** @copydoc seedRngIfNeeded */
+void seedRngIfNeeded() {
+  if (!rngIsSeeded(gState.rng)) {
+    rngSeed(gState.rng, initialSeed());
+  }
+}
+
+/** @copydoc defaultState */
+void defaultState() {
+  memset(&gState, 0, sizeof(gState));
+  rngSeed(gState.rng, initialSeed());
+  gState.lastEpoch = 0;
+  gState.ageMinutes = 0;
+  gState.coins = 10;
+  gState.stage = STAGE_EGG;
+  gState.hunger = 80;
+  gState.happiness = 70;
+  gState.cleanliness = 80;
+  gState.energy = 70;
+  gState.health = 90;
+  gState.discipline = 50;
+  gState.weight = 50;
+  gState.poop = 0;
+  gState.asleep = false;
+  gState.sick = false;
+  gState.lightsOn = true;
+  gState.medGuaranteePending = false;
+
+  gState.invFood = 3;
+  gState.invSnack = 2;
+  gState.invMed = 1;
+  gState.invToy = 1;
+
+  gState.careMistakes = 0;
+  gState.stageStartMistakes = 0;
+  gState.sicknessRiskPermille = 1000;
+  syncAlerts();
+}
+
+/** @copydoc resolveTantrum */
+bool resolveTantrum(uint32_t nowEpoch) {
+  if (gState.tantrumUntilEpoch == 0) return false;
+  if (nowEpoch != 0 && nowEpoch >= gState.tantrumUntilEpoch) {
+    return false;
+  }
+
+  gState.tantrumUntilEpoch = 0;
+  gState.tantrumCooldownUntilEpoch = 0;
+  gState.attentionSinceEpoch[ATTN_TANTRUM] = 0;
+  gState.attentionCooldownUntilEpoch[ATTN_TANTRUM] = 0;
+  if (nowEpoch != 0) {
+    scheduleNextTantrum(nowEpoch);
+  }
+  syncAlerts();
+  return true;
+}
+
+/** @copydoc tantrumActiveAt */
+bool tantrumActiveAt(uint32_t nowEpoch) {
+  if (gState.tantrumUntilEpoch == 0) return false;
+  if (nowEpoch == 0) return true;
+  return nowEpoch < gState.tantrumUntilEpoch;
+}
+
+/** @copydoc currentMood */
+Mood currentMood() {
+  if (gState.sick || gState.health < 35) return MOOD_SICK;
+  if (gState.asleep) return MOOD_SLEEPY;
+
+  int avg =
+      (gState.hunger + gState.happiness + gState.cleanliness + gState.health +
+       gState.discipline) /
+      5;
+
+  if (avg > 70) return MOOD_HAPPY;
+  if (avg > 45) return MOOD_OK;
+  return MOOD_SAD;
+}
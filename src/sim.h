@@ -0,0 +1,310 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "rng.h"
+
+/**
+ * @file sim.h
+ * @brief Platform-free pet state and simulation core.
+ *
+ * The single source of truth for the pet. No display, no NVS, no RTC: feed
+ * it epochs and it will tell you how badly things went.
+ */
+
+/**
+ * @brief Save metadata and simulation constants.
+ *
+ * Yes, these are magic values. No, they are not self-healing.
+ */
+static const uint32_t MAGIC = 0x54414D41; // "TAMA"
+static const uint16_t STATE_VERSION = 4;
+static const uint32_t MAX_OFFLINE_MINUTES = 7 * 24 * 60; // one week
+static const uint32_t SECONDS_PER_MINUTE = 60;
+
+/** @brief High-level mood buckets derived from the stat apocalypse. */
+enum Mood {
+  MOOD_HAPPY,
+  MOOD_OK,
+  MOOD_SAD,
+  MOOD_SLEEPY,
+  MOOD_SICK
+};
+
+/** @brief Growth stages as time and care quality do their thing. */
+enum Stage {
+  STAGE_EGG,
+  STAGE_BABY,
+  STAGE_CHILD,
+  STAGE_TEEN,
+  STAGE_ADULT,
+  STAGE_ELDER
+};
+
+/** @brief Inventory item types available for buying or consuming. */
+enum ItemType {
+  ITEM_FOOD,
+  ITEM_SNACK,
+  ITEM_MED,
+  ITEM_TOY,
+  ITEM_COUNT
+};
+
+/** @brief Attention reasons that can generate care mistakes. */
+enum AttentionReason {
+  ATTN_HUNGER,
+  ATTN_HAPPINESS,
+  ATTN_POOP,
+  ATTN_SICK,
+  ATTN_LIGHTS,
+  ATTN_TANTRUM,
+  ATTN_COUNT
+};
+
+/** @brief Shop/inventory definition for a single item type. */
+struct ItemDef {
+  /** @brief Display name shown in inventory and shop UI. */
+  const char *name;
+  /** @brief Coin cost per purchase. */
+  uint8_t cost;
+};
+
+/** @brief Human-readable labels for each pet stage. */
+extern const char *const kStageNames[];
+/** @brief Human-readable labels for each mood state. */
+extern const char *const kMoodNames[];
+/** @brief Static catalog used by the inventory/shop screen. */
+extern const ItemDef kItems[ITEM_COUNT];
+/**
+ * @brief Persistent pet state.
+ *
+ * Saved through `save_codec.h`. Adding a field means a new save version with
+ * its own decoder; old saves then migrate instead of politely dying.
+ */
+struct PetState {
+  /** @brief Last known RTC epoch used for offline progression. */
+  uint32_t lastEpoch;
+  /** @brief Total lifetime in in-game minutes. */
+  uint32_t ageMinutes;
+
+  /** @brief Currency used for purchases. */
+  uint16_t coins;
+  /** @brief Current growth stage encoded as `Stage`. */
+  uint8_t stage;
+
+  uint8_t hunger;      // 0-100
+  uint8_t happiness;   // 0-100
+  uint8_t cleanliness; // 0-100
+  uint8_t energy;      // hidden/internal (legacy)
+  uint8_t health;      // 0-100
+  uint8_t discipline;  // 0-100
+  uint8_t weight;      // 0-100
+
+  uint8_t poop;
+  bool asleep;
+  bool sick;
+  bool lightsOn;
+  bool medGuaranteePending;
+
+  uint8_t invFood;
+  uint8_t invSnack;
+  uint8_t invMed;
+  uint8_t invToy;
+
+  /** @brief Care mistakes accumulated over the pet lifetime. */
+  uint16_t careMistakes;
+  /** @brief Snapshot of `careMistakes` at stage start for stage scoring. */
+  uint16_t stageStartMistakes;
+  /** @brief Sickness chance multiplier in permille (1000 = 1.0x). */
+  uint16_t sicknessRiskPermille;
+
+  /** @brief Minutes spent with low hunger for sickness checks. */
+  uint16_t lowHungerMinutes;
+  /** @brief Minutes spent with low happiness for sickness checks. */
+  uint16_t lowHappinessMinutes;
+
+  /** @brief Per-minute drift accumulators to avoid truncation dead zones. */
+  int16_t hungerAcc;
+  int16_t happinessAcc;
+  int16_t disciplineAcc;
+  int16_t cleanlinessAcc;
+  int16_t healthAcc;
+
+  /** @brief Time accumulators for periodic events. */
+  uint16_t poopMinuteAcc;
+  uint16_t coinMinuteAcc;
+
+  /** @brief Medicine timing and guarantee tracking. */
+  uint32_t lastMedicineEpoch;
+
+  /** @brief Tantrum scheduler and state. */
+  uint32_t nextTantrumEpoch;
+  uint32_t tantrumUntilEpoch;         // 0 when inactive
+  uint32_t tantrumCooldownUntilEpoch; // block retrigger after failure
+
+  /** @brief Per-reason attention state for care-mistake timing. */
+  uint32_t attentionSinceEpoch[ATTN_COUNT];
+  uint32_t attentionCooldownUntilEpoch[ATTN_COUNT];
+
+  /** @brief Simulation random stream (added in save version 3). */
+  SimRng rng;
+  /** @brief Per-minute sickness chance (ppm) the countdown was drawn for; 0 = none. */
+  uint32_t sickChancePpm;
+  /** @brief Eligible minutes left until sickness onset, including the onset minute. */
+  uint32_t sickMinutesLeft;
+};
+
+/** @brief Notable simulation transitions reported through `platformSimEvent`. */
+enum SimEvent {
+  SIM_EVENT_TANTRUM_STARTED,
+  SIM_EVENT_TANTRUM_IGNORED,
+  /** @brief Detail: the `AttentionReason` that was neglected. */
+  SIM_EVENT_CARE_MISTAKE,
+  /** @brief Detail: the new `Stage`. */
+  SIM_EVENT_EVOLVED,
+  SIM_EVENT_SICK
+};
+
+/** @brief Cost counters for the simulation loop, for benchmarks and debugging. */
+struct SimStats {
+  /** @brief Total minutes handed to `simulateMinutes`. */
+  uint32_t simulatedMinutes;
+  /** @brief Minutes that had to be stepped one at a time. */
+  uint32_t steppedMinutes;
+  /** @brief Quiet spans applied in closed form by the fast-forward engine. */
+  uint32_t fastForwardSpans;
+};
+
+/**
+ * @brief Cached attention mask, kept in step with the fields it depends on.
+ *
+ * Refreshed by `syncAlerts()` wherever those fields change, so readers get
+ * the mask without re-deriving it.
+ */
+struct AlertCache {
+  /** @brief Active reasons as a bitmask of `AttentionReason` ordinals. */
+  uint8_t mask;
+  /** @brief Number of bits set in `mask`. */
+  uint8_t count;
+  /** @brief Bits that flipped since the last `takeAlertChanges()`. */
+  uint8_t changed;
+  /** @brief Incremented every time `mask` changes. */
+  uint32_t version;
+};
+
+/**
+ * @brief A catch-up in progress across `simCatchUpSlice()` calls; zero it
+ * before the first.
+ */
+struct CatchUp {
+  /** @brief Minutes of the absence still to simulate; 0 when idle. */
+  uint32_t minutesLeft;
+  /** @brief Minutes beyond `MAX_OFFLINE_MINUTES`, skipped at the end. */
+  uint32_t skipMinutes;
+};
+
+/** @brief Global persistent pet state instance. */
+extern PetState gState;
+/** @brief Global simulation cost counters. */
+extern SimStats gSimStats;
+/** @brief Global alert cache for `gState`. */
+extern AlertCache gAlerts;
+
+/**
+ * @brief Clamp a stat value into the only acceptable emotional range.
+ * @param v Input value.
+ * @return Value clamped to [0, 100].
+ */
+uint8_t clampU8(int v);
+/**
+ * @brief Compute the pet mood from current stats.
+ * @return Derived mood bucket.
+ */
+Mood currentMood();
+/**
+ * @brief Reset persistent state to a fresh new life.
+ *
+ * Fresh meaning "minutes from existential decline."
+ */
+void defaultState();
+/**
+ * @brief Seed the simulation RNG if the state does not carry a stream yet.
+ *
+ * Uses `SIM_RNG_SEED` when defined, otherwise `platformEntropy()`.
+ */
+void seedRngIfNeeded();
+/**
+ * @brief Clamp every stat back into range after loads or long catch-ups.
+ */
+void clampState();
+/**
+ * @brief Advance the pet by whole minutes after `startEpoch`.
+ *
+ * Quiet stretches are fast-forwarded in closed form; everything else is
+ * stepped minute by minute. Capped at `MAX_OFFLINE_MINUTES`.
+ * @param startEpoch Epoch of the last simulated minute.
+ * @param minutes Number of minutes to simulate.
+ */
+void simulateMinutes(uint32_t startEpoch, uint32_t minutes);
+/**
+ * @brief Simulate the next slice of the time between `gState.lastEpoch` and
+ * `nowEpoch`, moving `lastEpoch` along.
+ *
+ * A new catch-up is capped at `MAX_OFFLINE_MINUTES` as a whole, not per
+ * slice: once that much is simulated, `lastEpoch` skips the rest of the
+ * absence.
+ * @param c Catch-up state, kept by the caller between slices.
+ * @param nowEpoch Current epoch.
+ * @param sliceMinutes Most minutes to simulate in this call.
+ * @return `true` while minutes of this catch-up are left; call again.
+ */
+bool simCatchUpSlice(CatchUp &c, uint32_t nowEpoch, uint32_t sliceMinutes);
+/**
+ * @brief When the pet next changes in a way the Home screen shows.
+ *
+ * Sleep/wake flips, evolution, a new day, tantrum start and end, poop, a
+ * stat falling into its alert, sickness and care mistakes. Stat bars and
+ * the mood in between drift without counting. Reads `s` only, so it can
+ * plan a deep sleep without touching the simulation.
+ * @param s State as of its `lastEpoch`.
+ * @param limit Most minutes to look ahead; at least 1.
+ * @return `s.lastEpoch` plus a whole number of minutes (1 to `limit`): the
+ * first minute at which anything on that list may happen.
+ */
+uint32_t simNextEventEpoch(const PetState &s, uint32_t limit);
+/**
+ * @brief Pick the next random tantrum time after `nowEpoch`.
+ * @param nowEpoch Current epoch; `0` leaves the schedule untouched.
+ */
+void scheduleNextTantrum(uint32_t nowEpoch);
+/**
+ * @brief Resolve an active tantrum (the scold action).
+ * @param nowEpoch Current epoch, or `0` when unknown.
+ * @return `true` when a tantrum was active and resolved.
+ */
+bool resolveTantrum(uint32_t nowEpoch);
+/**
+ * @brief Whether a tantrum is running at `nowEpoch`.
+ * @param nowEpoch Current epoch, or `0` when unknown.
+ * @return `true` if the tantrum timer is running.
+ */
+bool tantrumActiveAt(uint32_t nowEpoch);
+/**
+ * @brief Refresh `gAlerts` after changing hunger, happiness, poop, sickness,
+ * sleep/lights or the tantrum timer.
+ *
+ * An expired tantrum keeps its bit until the next simulated minute clears
+ * the timer.
+ */
+void syncAlerts();
+/**
+ * @brief Take the alert bits that changed since the previous call.
+ * @return Changed bits; the accumulator is cleared.
+ */
+uint8_t takeAlertChanges();
+/**
+ * @brief Count the reasons set in an alert mask.
+ * @param mask Bitmask using `AttentionReason` ordinals.
+ * @return Number of active alerts.
+ */
+uint8_t countAlerts(uint8_t mask);
@@ -0,0 +1,58 @@
+#include "snapshot.h"
+
+#include <string.h>
+
+/**
+ * @file snapshot.cpp
+ * @brief Sequence lock over the published view model.
+ *
+ * The words are copied with relaxed atomic loads and stores, ordered by the
+ * fences around them, so a reader racing the writer gets stale or mixed
+ * words (and retries) but never undefined behavior.
+ */
+
+/** @copydoc snapshotPublish */
+bool snapshotPublish(ViewSnapshot &s, const ViewModel &vm) {
+  uint32_t words[SNAPSHOT_WORDS];
+  words[SNAPSHOT_WORDS - 1] = 0;
+  memcpy(words, &vm, sizeof(vm));
+  // Only the writer stores the words, so it may read them back plainly.
+  const uint32_t seq = s.seq;
+  if (seq != 0 && memcmp(words, s.words, sizeof(words)) == 0) return false;
+
+  __atomic_store_n(&s.seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  for (uint16_t i = 0; i < SNAPSHOT_WORDS; ++i) {
+    __atomic_store_n(&s.words[i], words[i], __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&s.seq, seq + 2, __ATOMIC_RELEASE);
+  return true;
+}
+
+/** @copydoc snapshotVersion */
+uint32_t snapshotVersion(const ViewSnapshot &s) {
+  return __atomic_load_n(&s.seq, __ATOMIC_ACQUIRE) >> 1;
+}
+
+/** @copydoc snapshotTryRead */
+bool snapshotTryRead(const ViewSnapshot &s, ViewModel &vm, uint32_t &version) {
+  const uint32_t before = __atomic_load_n(&s.seq, __ATOMIC_ACQUIRE);
+  if (before & 1u) return false;
+  uint32_t words[SNAPSHOT_WORDS];
+  for (uint16_t i = 0; i < SNAPSHOT_WORDS; ++i) {
+    words[i] = __atomic_load_n(&s.words[i], __ATOMIC_RELAXED);
+  }
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&s.seq, __ATOMIC_RELAXED) != before) return false;
+  memcpy(&vm, words, sizeof(vm));
+  version = before >> 1;
+  return true;
+}
+
+/** @copydoc snapshotRead */
+uint32_t snapshotRead(const ViewSnapshot &s, ViewModel &vm) {
+  uint32_t version;
+  while (!snapshotTryRead(s, vm, version)) {
+  }
+  return version;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "view_model.h"
+
+/**
+ * @file snapshot.h
+ * @brief The view model published by one writer for lock-free readers (a
+ * sequence lock).
+ *
+ * The game task publishes a fresh `ViewModel` after each tick or action; the
+ * render task, or anything else, copies it out without a mutex and without
+ * ever holding up the writer. The sequence number is odd while a publish is
+ * in progress. A reader copies the words and tries again if the sequence was
+ * odd or moved meanwhile, so it never sees half of one frame and half of the
+ * next.
+ *
+ * Publishing a view model equal to the current one changes nothing, so the
+ * version doubles as a cheap "has anything changed" check.
+ *
+ * Pure code: no Arduino, safe to build on the host. One writer, any number of
+ * readers.
+ */
+
+/** @brief 32-bit words a `ViewModel` takes in a snapshot. */
+static const uint16_t SNAPSHOT_WORDS = (sizeof(ViewModel) + 3) / 4;
+
+/** @brief A published view model. Zero-initialize; version 0 is "nothing yet". */
+struct ViewSnapshot {
+  /** @brief Twice the version, plus one while a publish is in progress. */
+  uint32_t seq;
+  /** @brief The view model, as words so readers can copy them atomically. */
+  uint32_t words[SNAPSHOT_WORDS];
+};
+
+/**
+ * @brief Publish a view model (writer side).
+ * @param s Snapshot.
+ * @param vm New view model; build it from a zeroed struct (as
+ * `buildViewModel()` does) so padding compares equal.
+ * @return `false`, with the version unchanged, when `vm` equals the current
+ * one.
+ */
+bool snapshotPublish(ViewSnapshot &s, const ViewModel &vm);
+/**
+ * @brief Version of the current view model, without copying it.
+ * @param s Snapshot.
+ * @return Number of changed view models published so far.
+ */
+uint32_t snapshotVersion(const ViewSnapshot &s);
+/**
+ * @brief Copy the current view model once (reader side).
+ * @param s Snapshot.
+ * @param vm Receives the copy; only valid on success.
+ * @param version Receives its version on success.
+ * @return `false` if a publish overlapped the copy; try again.
+ */
+bool snapshotTryRead(const ViewSnapshot &s, ViewModel &vm, uint32_t &version);
+/**
+ * @brief Copy the current view model, retrying until no publish overlaps.
+ * @param s Snapshot.
+ * @param vm Receives the copy.
+ * @return Its version.
+ */
+uint32_t snapshotRead(const ViewSnapshot &s, ViewModel &vm);
@@ -0,0 +1,172 @@
+#include "trace.h"
+
+#include "platform.h"
+
+#include <stdio.h>
+
+/**
+ * @file trace.cpp
+ * @brief Probe ring and its Chrome trace export.
+ */
+
+TraceStats gTraceStats;
+
+#if TAMA_TRACE
+
+static TraceEvent gRing[TRACE_RING_EVENTS];
+/** @brief Slot the next event goes to. */
+static uint16_t gHead = 0;
+static uint16_t gCount = 0;
+
+static uint32_t gLastCount = 0;
+static uint64_t gWraps = 0;
+
+/** @copydoc traceNow */
+uint64_t traceNow() {
+  // Read under the lock, so readings from both cores reach it in order and a
+  // lower one really is a wrap.
+  platformLock();
+  uint32_t count = platformCycleCount();
+  if (count < gLastCount) gWraps += 1ULL << 32;
+  gLastCount = count;
+  uint64_t now = gWraps | count;
+  platformUnlock();
+  return now;
+}
+
+/** @copydoc traceRecord */
+void traceRecord(const char *name, uint64_t start, uint64_t end) {
+  uint64_t ticks = end - start;
+  const uint8_t core = platformCoreId();
+  platformLock();
+  TraceEvent &event = gRing[gHead];
+  event.name = name;
+  event.start = start;
+  event.ticks = ticks > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(ticks);
+  event.core = core;
+
+  gHead = static_cast<uint16_t>((gHead + 1) % TRACE_RING_EVENTS);
+  if (gCount < TRACE_RING_EVENTS) {
+    ++gCount;
+  } else {
+    ++gTraceStats.overwritten;
+  }
+  ++gTraceStats.recorded;
+  platformUnlock();
+}
+
+/** @copydoc traceClear */
+void traceClear() {
+  platformLock();
+  gHead = 0;
+  gCount = 0;
+  gTraceStats.recorded = 0;
+  gTraceStats.overwritten = 0;
+  platformUnlock();
+}
+
+/** @copydoc traceEvent */
+bool traceEvent(uint16_t index, TraceEvent &out) {
+  platformLock();
+  const bool found = index < gCount;
+  if (found) {
+    const uint16_t oldest = static_cast<uint16_t>(
+        (gHead + TRACE_RING_EVENTS - gCount) % TRACE_RING_EVENTS);
+    out = gRing[(oldest + index) % TRACE_RING_EVENTS];
+  }
+  platformUnlock();
+  return found;
+}
+
+/**
+ * Events to dump, as `TraceStats::recorded` sequence numbers: the oldest
+ * still in the ring up to (not including) `end`.
+ */
+static uint32_t dumpRange(uint32_t &end) {
+  platformLock();
+  end = gTraceStats.recorded;
+  const uint32_t first = end - gCount;
+  platformUnlock();
+  return first;
+}
+
+/** Copy event number `seq`; `false` once it has been overwritten or cleared. */
+static bool copyEvent(uint32_t seq, TraceEvent &out) {
+  platformLock();
+  const uint32_t behind = gTraceStats.recorded - seq;
+  const bool kept = behind != 0 && behind <= gCount;
+  if (kept) {
+    out = gRing[(gHead + TRACE_RING_EVENTS - behind) % TRACE_RING_EVENTS];
+  }
+  platformUnlock();
+  return kept;
+}
+
+#else
+
+/** @copydoc traceNow */
+uint64_t traceNow() { return 0; }
+
+/** @copydoc traceRecord */
+void traceRecord(const char *name, uint64_t start, uint64_t end) {
+  (void)name;
+  (void)start;
+  (void)end;
+}
+
+/** @copydoc traceClear */
+void traceClear() {}
+
+/** @copydoc traceEvent */
+bool traceEvent(uint16_t index, TraceEvent &out) {
+  (void)index;
+  (void)out;
+  return false;
+}
+
+static uint32_t dumpRange(uint32_t &end) {
+  end = 0;
+  return 0;
+}
+
+static bool copyEvent(uint32_t seq, TraceEvent &out) {
+  (void)seq;
+  (void)out;
+  return false;
+}
+
+#endif
+
+/** Ticks as microseconds with three decimals, without floating point. */
+static void formatMicros(char *buf, size_t len, uint64_t ticks, uint32_t perUs) {
+  unsigned long long whole = ticks / perUs;
+  unsigned frac = static_cast<unsigned>((ticks % perUs) * 1000 / perUs);
+  snprintf(buf, len, "%llu.%03u", whole, frac);
+}
+
+/** @copydoc traceWriteJson */
+uint16_t traceWriteJson(void (*write)(const char *text, void *ctx), void *ctx) {
+  const uint32_t perUs = platformCyclesPerUs() ? platformCyclesPerUs() : 1;
+  write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", ctx);
+
+  uint16_t written = 0;
+  uint32_t end;
+  for (uint32_t seq = dumpRange(end); seq != end; ++seq) {
+    TraceEvent event;
+    if (!copyEvent(seq, event)) continue;
+    char ts[24];
+    char dur[24];
+    formatMicros(ts, sizeof(ts), event.start, perUs);
+    formatMicros(dur, sizeof(dur), event.ticks, perUs);
+    char line[112];
+    snprintf(line, sizeof(line),
+             "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+             "\"ts\":%s,\"dur\":%s}",
+             written ? "," : "", event.name, event.core + 1u, ts, dur);
+    write(line, ctx);
+    ++written;
+  }
+
+  write("\n]}\n", ctx);
+  return written;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file trace.h
+ * @brief Scoped timing probes recorded into a RAM ring, exported as a Chrome
+ * trace.
+ *
+ * `TRACE_SCOPE("name")` times the rest of the enclosing block and records one
+ * complete event (name, start, duration) into a ring of `TRACE_RING_EVENTS`.
+ * When the ring is full the oldest events are overwritten. The ticks come from
+ * `platformCycleCount()`: microseconds on the device, nanoseconds on the host.
+ * Each event remembers the core it ran on and gets that core's row in the
+ * trace.
+ *
+ * Probes exist only when built with `-DTAMA_TRACE=1`; otherwise
+ * `TRACE_SCOPE` compiles to nothing and the ring is not even allocated.
+ * Open the output of `traceWriteJson()` in `chrome://tracing` or Perfetto.
+ *
+ * Pure code: no Arduino, safe to build on the host. Probes may fire on any
+ * task (`platformLock()` guards the ring) while another one dumps it: readers
+ * copy each event under the lock. Clear it from the task that dumps it.
+ */
+
+#ifndef TAMA_TRACE
+#define TAMA_TRACE 0
+#endif
+
+/** @brief Events kept; the newest ones win. */
+static const uint16_t TRACE_RING_EVENTS = 256;
+
+/** @brief One timed scope. */
+struct TraceEvent {
+  /** @brief Probe name; must be a string literal (only the pointer is kept). */
+  const char *name;
+  /** @brief Start, in ticks since boot. */
+  uint64_t start;
+  /** @brief Duration in ticks. */
+  uint32_t ticks;
+  /** @brief `platformCoreId()` of the task that ran the scope. */
+  uint8_t core;
+};
+
+/** @brief Probe counters. */
+struct TraceStats {
+  /** @brief Events recorded since boot or the last `traceClear()`. */
+  uint32_t recorded;
+  /** @brief Events overwritten before they were dumped. */
+  uint32_t overwritten;
+};
+
+/** @brief Probe counters since boot. */
+extern TraceStats gTraceStats;
+
+/**
+ * @brief Current time for probes, widened to 64 bits.
+ *
+ * Must be called at least once per wrap of the 32-bit counter (71 minutes on
+ * the device), which the minute tick's probes do.
+ * @return Ticks since boot.
+ */
+uint64_t traceNow();
+/**
+ * @brief Record one finished scope.
+ * @param name String literal naming the probe.
+ * @param start `traceNow()` at scope entry.
+ * @param end `traceNow()` at scope exit.
+ */
+void traceRecord(const char *name, uint64_t start, uint64_t end);
+/** @brief Drop all recorded events. */
+void traceClear();
+/**
+ * @brief Copy one recorded event, oldest first.
+ *
+ * Each call takes the lock on its own, so probes firing between calls move
+ * the indices; `traceWriteJson()` walks the ring without that problem.
+ * @param index 0 for the oldest.
+ * @param out Receives the event.
+ * @return `false` past the newest.
+ */
+bool traceEvent(uint16_t index, TraceEvent &out);
+/**
+ * @brief Emit the ring as Chrome trace-event JSON (`"ph":"X"` events, times
+ * in microseconds), oldest first, in small pieces.
+ *
+ * Dumps the events recorded before the call. Each one is copied under the
+ * lock before it is formatted; one overwritten meanwhile is left out (and
+ * counted in `TraceStats::overwritten`).
+ * @param write Receives each piece of text.
+ * @param ctx Passed to `write`.
+ * @return Number of events written.
+ */
+uint16_t traceWriteJson(void (*write)(const char *text, void *ctx), void *ctx);
+
+#if TAMA_TRACE
+
+/** @brief Records the lifetime of the object as one event. */
+class TraceScope {
+ public:
+  explicit TraceScope(const char *name, bool active = true)
+      : name(active ? name : nullptr), start(active ? traceNow() : 0) {}
+  ~TraceScope() {
+    if (name) traceRecord(name, start, traceNow());
+  }
+
+ private:
+  const char *name;
+  uint64_t start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+/** @brief Time the rest of the enclosing block as `name`. */
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+/** @brief `TRACE_SCOPE` only when `active`, for polls that are mostly idle. */
+#define TRACE_SCOPE_IF(name, active) \
+  TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name, active)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_IF(name, active) ((void)0)
+
+#endif
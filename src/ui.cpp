@@ -1,5 +1,9 @@
 #include "ui.h"
+#include "dirty_rects.h"
+#include "frame_tiles.h"
 #include "logic.h"
+#include "pet_bitmaps.h"
+#include "trace.h"
 
 #include <M5GFX.h>
 #include <stdio.h>
@@ -8,11 +12,39 @@
 /**
  * @file ui.cpp
  * @brief Screen rendering for the monochrome life simulator.
+ *
+ * Each screen is a static chrome layer plus a table of widgets bound to the
+ * `ViewModel`. A frame compares every widget's key with the one it was last
+ * drawn with and re-rasterizes only the widgets whose key moved.
  */
 
 static const uint16_t UI_BG = TFT_BLACK;
 static const uint16_t UI_FG = TFT_WHITE;
 
+/** @brief Alert bits that changed between the previous frame and this one. */
+static uint8_t gFrameAlertChanges = 0;
+
+/** @brief Partial refreshes allowed before a ghost-clearing full refresh. */
+static const uint8_t UI_FULL_REFRESH_EVERY = 20;
+/** @brief Damage covering at least this share of the screen is pushed whole. */
+static const uint8_t UI_FULL_REFRESH_AREA_PERCENT = 50;
+/** @brief Bytes per framebuffer row (1bpp). */
+static const int UI_ROW_BYTES = SCREEN_W / 8;
+
+RefreshStats gRefreshStats;
+
+/** @brief Copy of what the panel shows; the "old" data of a partial update. */
+static uint8_t gPanelShadow[UI_ROW_BYTES * SCREEN_H];
+/** @brief Packed refresh windows; partial updates never exceed half the screen. */
+static uint8_t gWindowBefore[UI_ROW_BYTES * SCREEN_H / 2];
+static uint8_t gWindowAfter[UI_ROW_BYTES * SCREEN_H / 2];
+/** @brief Tile hashes of what the panel shows. */
+static FrameTiles gPanelTiles;
+static bool gPanelValid = false;
+static uint8_t gPartialsSinceFull = 0;
+/** @brief Framebuffer byte of an empty screen, sampled after each clear. */
+static uint8_t gBlankByte = 0;
+
 // drawing helpers
 static int estimateTextWidth(const char *text, uint8_t size) {
   if (!text) return 0;
@@ -39,11 +71,6 @@ static inline void drawCircleCompat(Ink_Sprite &sprite, int x, int y, int r,
   sprite.drawCircle(x, y, r, color);
 }
 
-static inline void fillCircleCompat(Ink_Sprite &sprite, int x, int y, int r,
-                                    uint16_t color) {
-  sprite.fillCircle(x, y, r, color);
-}
-
 static inline void drawLineCompat(Ink_Sprite &sprite, int x1, int y1, int x2,
                                   int y2, uint16_t color) {
   sprite.drawLine(x1, y1, x2, y2, color);
@@ -64,8 +91,10 @@ static void setTextColorMono(bool inverted) {
   gSprite.setTextColor(inverted ? UI_BG : UI_FG);
 }
 
-static void drawBar(int x, int y, int w, int h, uint8_t value) {
-  drawRectCompat(gSprite, x, y, w, h, UI_FG);
+static const int STAT_BAR_W = 66;
+static const int STAT_BAR_H = 8;
+
+static void drawBarFill(int x, int y, int w, int h, uint8_t value) {
   int fill = (w - 2) * value / 100;
   if (fill < 0) fill = 0;
   fillRectCompat(gSprite, x + 1, y + 1, fill, h - 2, UI_FG);
@@ -73,16 +102,9 @@ static void drawBar(int x, int y, int w, int h, uint8_t value) {
 
 static void drawDivider(int y) { drawLineCompat(gSprite, 0, y, SCREEN_W, y, UI_FG); }
 
-static void drawSoftkeys(const char *left, const char *mid, const char *right) {
-  drawDivider(176);
-  drawText(4, 182, left, 1);
-  drawTextCentered(182, mid, 1);
-  drawTextRight(SCREEN_W - 4, 182, right, 1);
-}
-
-static void drawStatMini(int x, int y, const char *label, uint8_t value) {
+static void drawStatFrame(int x, int y, const char *label) {
   drawText(x, y, label, 1);
-  drawBar(x + 16, y + 1, 66, 8, value);
+  drawRectCompat(gSprite, x + 16, y + 1, STAT_BAR_W, STAT_BAR_H, UI_FG);
 }
 
 static void drawHomeIconRow(int y, bool topRow) {
@@ -149,540 +171,1026 @@ static void drawHomeIconRow(int y, bool topRow) {
   }
 }
 
-static int scaleSignedRounded(int value, int numer, int denom) {
-  int mag = value >= 0 ? value : -value;
-  int scaled = (mag * numer + denom / 2) / denom;
-  return value >= 0 ? scaled : -scaled;
+
+/** Dividers and title under the top bar; the top bar itself is a widget row. */
+static void drawHeaderChrome(const char *title, uint8_t size = 1) {
+  drawDivider(20);
+  if (title && title[0]) {
+    drawTextCentered(24, title, size);
+    drawDivider(44);
+  }
 }
 
-static int scaleDimRounded(int value, int numer, int denom) {
-  int scaled = (value * numer + denom / 2) / denom;
-  return scaled < 1 ? 1 : scaled;
+static uint32_t secondsUntil(uint32_t targetEpoch) {
+  if (targetEpoch == 0) return 0;
+  const ClockSnapshot &now = clockNow();
+  if (!now.valid) return 0;
+  uint32_t nowEpoch = now.epoch;
+  if (targetEpoch <= nowEpoch) return 0;
+  return targetEpoch - nowEpoch;
 }
 
-static const int FACE_DRAW_BASE = 72;
-static const int FACE_DRAW_TARGET = FACE_DRAW_BASE - 15;
-static const int STAGE_DRAW_BASE = 24;
-static const int STAGE_DRAW_TARGET = STAGE_DRAW_BASE - 5;
+static const char *const kHelpLines[] = {
+    "Controls",
+    "A: Up in Helper",
+    "B: Select / Back",
+    "C: Down in Helper",
+    "G5: Go Home",
+    "G27: Toggle Status",
+    "",
+    "Home",
+    "A Menu  B Play/Light",
+    "C Status",
+    "",
+    "Reset",
+    "Status: C opens confirm",
+    "B confirms reset",
+    "A/C cancel reset",
+    "",
+    "Legend",
+    "HL Health  HU Hunger",
+    "HP Happy   CL Clean",
+    "DS Discipline"};
+
+static const int HELP_TOTAL_LINES = (int)(sizeof(kHelpLines) / sizeof(kHelpLines[0]));
+static const int HELP_VISIBLE_LINES = 10;
+static const int HELP_MAX_SCROLL =
+    HELP_TOTAL_LINES > HELP_VISIBLE_LINES ? HELP_TOTAL_LINES - HELP_VISIBLE_LINES : 0;
+
+/**
+ * Page 0 shows pet internals; later pages one metric per line. Runs on the
+ * game task, so the render task's frame counts come from the metrics
+ * registry rather than `gRefreshStats`.
+ */
+static void formatDebugLines(ViewModel &vm, uint8_t page) {
+  char(*lines)[DEBUG_LINE_LEN] = vm.debugLines;
+  if (page == 0 || page >= DEBUG_OVERLAY_PAGES) {
+    uint32_t tSeconds = vm.tantrum ? secondsUntil(gState.tantrumUntilEpoch)
+                                   : secondsUntil(gState.nextTantrumEpoch);
+    snprintf(lines[0], DEBUG_LINE_LEN, "CM:%u AL:%u M:%02X D:%02X",
+             vm.careMistakes, getActiveAlertCount(), getActiveAlertMask(),
+             gFrameAlertChanges);
+    snprintf(lines[1], DEBUG_LINE_LEN, "TN:%lum %s W:%lu/%lu",
+             (unsigned long)(tSeconds / 60), vm.tantrum ? "ACTIVE" : "NEXT",
+             (unsigned long)gSaveStats.writes,
+             (unsigned long)gSaveStats.writesAvoided);
+    snprintf(lines[2], DEBUG_LINE_LEN, "R:%u/%u/%u/%u/%u P:%lu/%lu",
+             vm.stats[VIEW_STAT_HUNGER], vm.stats[VIEW_STAT_HAPPINESS],
+             vm.stats[VIEW_STAT_CLEANLINESS], vm.stats[VIEW_STAT_DISCIPLINE],
+             vm.stats[VIEW_STAT_HEALTH],
+             (unsigned long)metricRead(METRIC_FRAMES_PUSHED),
+             (unsigned long)metricRead(METRIC_FRAMES_RENDERED));
+    return;
+  }
 
-static int faceOffset(int value) {
-  return scaleSignedRounded(value, FACE_DRAW_TARGET, FACE_DRAW_BASE);
+  for (uint8_t i = 0; i < DEBUG_OVERLAY_LINES; ++i) {
+    unsigned id = (page - 1u) * DEBUG_OVERLAY_LINES + i;
+    if (id < METRIC_COUNT) {
+      metricFormat(static_cast<MetricId>(id), lines[i], DEBUG_LINE_LEN);
+    } else {
+      lines[i][0] = '\0';
+    }
+  }
 }
 
-static int faceRadius(int value) {
-  return scaleDimRounded(value, FACE_DRAW_TARGET, FACE_DRAW_BASE);
+/** @copydoc buildViewModel */
+void buildViewModel(ViewModel &vm) {
+  memset(&vm, 0, sizeof(vm));
+  vm.screen = gRun.screen;
+
+  const ClockSnapshot &now = clockNow();
+  vm.clockValid = now.valid;
+  vm.hour = now.hour;
+  vm.minute = now.minute;
+  vm.days = gState.ageMinutes / (24 * 60);
+  vm.coins = gState.coins;
+  vm.battery = getBatteryPercent();
+
+  vm.stats[VIEW_STAT_HUNGER] = gState.hunger;
+  vm.stats[VIEW_STAT_HAPPINESS] = gState.happiness;
+  vm.stats[VIEW_STAT_CLEANLINESS] = gState.cleanliness;
+  vm.stats[VIEW_STAT_DISCIPLINE] = gState.discipline;
+  vm.stats[VIEW_STAT_HEALTH] = gState.health;
+  vm.stage = gState.stage;
+  vm.mood = static_cast<uint8_t>(currentMood());
+  vm.asleep = gState.asleep;
+  vm.sick = gState.sick;
+  vm.tantrum = isTantrumActive();
+  vm.weight = gState.weight;
+  vm.poop = gState.poop;
+  vm.careMistakes = gState.careMistakes;
+
+  vm.menuIndex = gRun.menuIndex;
+  vm.item = gRun.inventoryIndex;
+  vm.itemCount = inventoryCount(static_cast<ItemType>(vm.item));
+  vm.helpScroll = static_cast<uint8_t>(
+      gRun.helpScroll > HELP_MAX_SCROLL ? HELP_MAX_SCROLL : gRun.helpScroll);
+  vm.mgActive = gRun.mgActive;
+  vm.mgTarget = gRun.mgTarget;
+  if (gRun.mgActive) {
+    uint32_t nowMs = millis();
+    vm.mgSecondsLeft =
+        gRun.mgDeadlineMs > nowMs ? (gRun.mgDeadlineMs - nowMs) / 1000 : 0;
+  }
+  snprintf(vm.message, sizeof(vm.message), "%s", gRun.message);
+
+  vm.devMode = gRun.devModeUnlocked;
+  vm.debugOverlay = gRun.devModeUnlocked && gRun.debugOverlay;
+  if (vm.debugOverlay) formatDebugLines(vm, gRun.debugPage);
 }
 
-static int stageOffset(int value) {
-  return scaleSignedRounded(value, STAGE_DRAW_TARGET, STAGE_DRAW_BASE);
+// Widgets: a box on screen plus what to draw in it, read from the view model.
+// The box must hold everything the widget can draw; the chrome underneath it
+// is restored before each redraw.
+
+enum WidgetKind : uint8_t {
+  /** @brief One line of text; an empty string draws nothing. */
+  WIDGET_LABEL,
+  /** @brief Fill of a stat bar whose frame is part of the chrome. */
+  WIDGET_BAR,
+  /** @brief Baked bitmap; every bitmap of one widget has the same size. */
+  WIDGET_ICON,
+  /** @brief Menu grid cell, filled when selected. */
+  WIDGET_CELL,
+  /** @brief The three softkey labels, tab-separated. */
+  WIDGET_SOFTKEYS,
+  /** @brief Anything else: own key and draw callbacks. */
+  WIDGET_CUSTOM
+};
+
+enum WidgetAlign : uint8_t { ALIGN_LEFT, ALIGN_CENTER, ALIGN_RIGHT };
+
+static const uint8_t UI_WIDGET_TEXT = 40;
+
+typedef void (*WidgetText)(const ViewModel &vm, char *buf, size_t len);
+typedef const PetBitmap &(*WidgetBitmap)(const ViewModel &vm);
+typedef uint32_t (*WidgetKey)(const ViewModel &vm);
+typedef void (*WidgetDraw)(const ViewModel &vm);
+
+struct Widget {
+  WidgetKind kind;
+  /** @brief Text size (labels), `ViewStat` (bars) or menu index (cells). */
+  uint8_t arg;
+  WidgetAlign align;
+  /** @brief Box; for icons `x`/`y` is the anchor and the size comes from the bitmap. */
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+  WidgetText text;
+  WidgetBitmap bitmap;
+  WidgetKey key;
+  WidgetDraw draw;
+};
+
+static Widget makeWidget(WidgetKind kind, uint8_t arg, int x, int y, int w,
+                         int h) {
+  Widget widget;
+  memset(&widget, 0, sizeof(widget));
+  widget.kind = kind;
+  widget.arg = arg;
+  widget.x = static_cast<int16_t>(x);
+  widget.y = static_cast<int16_t>(y);
+  widget.w = static_cast<int16_t>(w);
+  widget.h = static_cast<int16_t>(h);
+  return widget;
 }
 
-static int stageRadius(int value) {
-  return scaleDimRounded(value, STAGE_DRAW_TARGET, STAGE_DRAW_BASE);
+static Widget label(int x, int y, int w, uint8_t size, WidgetAlign align,
+                    WidgetText text) {
+  Widget widget = makeWidget(WIDGET_LABEL, size, x, y, w, 8 * size);
+  widget.align = align;
+  widget.text = text;
+  return widget;
 }
 
-static int stageDim(int value) {
-  return scaleDimRounded(value, STAGE_DRAW_TARGET, STAGE_DRAW_BASE);
+/** Fill of the bar `drawStatFrame(x, y, ...)` put in the chrome. */
+static Widget bar(int x, int y, ViewStat stat) {
+  return makeWidget(WIDGET_BAR, stat, x + 16, y + 1, STAT_BAR_W, STAT_BAR_H);
 }
 
-static void drawStageIcon(int cx, int cy, Stage stage) {
-  switch (stage) {
-    case STAGE_EGG:
-      drawCircleCompat(gSprite, cx, cy + stageOffset(2), stageRadius(10), UI_FG);
-      drawCircleCompat(gSprite, cx, cy + stageOffset(-4), stageRadius(8), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(-4), cy + stageOffset(2),
-                     cx + stageOffset(-1), cy + stageOffset(5), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(-1), cy + stageOffset(5),
-                     cx + stageOffset(2), cy + stageOffset(2), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(2), cy + stageOffset(2),
-                     cx + stageOffset(5), cy + stageOffset(5), UI_FG);
-      break;
-    case STAGE_BABY:
-      drawCircleCompat(gSprite, cx, cy + stageOffset(-4), stageRadius(7), UI_FG);
-      drawCircleCompat(gSprite, cx, cy + stageOffset(8), stageRadius(6), UI_FG);
-      drawCircleCompat(gSprite, cx, cy + stageOffset(2), stageRadius(2), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(-3), cy + stageOffset(4),
-                     cx + stageOffset(3), cy + stageOffset(4), UI_FG);
-      break;
-    case STAGE_CHILD:
-      drawCircleCompat(gSprite, cx, cy + stageOffset(-4), stageRadius(8), UI_FG);
-      drawRectCompat(gSprite, cx + stageOffset(-6), cy + stageOffset(4),
-                     stageDim(12), stageDim(10), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(-10), cy + stageOffset(6),
-                     cx + stageOffset(-6), cy + stageOffset(8), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(6), cy + stageOffset(8),
-                     cx + stageOffset(10), cy + stageOffset(6), UI_FG);
-      break;
-    case STAGE_TEEN:
-      drawCircleCompat(gSprite, cx, cy + stageOffset(-4), stageRadius(8), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(-6), cy + stageOffset(-12),
-                     cx + stageOffset(-2), cy + stageOffset(-8), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(0), cy + stageOffset(-12),
-                     cx + stageOffset(2), cy + stageOffset(-8), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(6), cy + stageOffset(-12),
-                     cx + stageOffset(2), cy + stageOffset(-8), UI_FG);
-      drawRectCompat(gSprite, cx + stageOffset(-5), cy + stageOffset(4),
-                     stageDim(10), stageDim(12), UI_FG);
-      break;
-    case STAGE_ADULT:
-      drawCircleCompat(gSprite, cx, cy + stageOffset(-5), stageRadius(9), UI_FG);
-      drawRectCompat(gSprite, cx + stageOffset(-8), cy + stageOffset(4),
-                     stageDim(16), stageDim(12), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(-12), cy + stageOffset(6),
-                     cx + stageOffset(-8), cy + stageOffset(10), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(8), cy + stageOffset(10),
-                     cx + stageOffset(12), cy + stageOffset(6), UI_FG);
-      break;
-    case STAGE_ELDER:
-      drawCircleCompat(gSprite, cx, cy + stageOffset(-5), stageRadius(8), UI_FG);
-      drawCircleCompat(gSprite, cx + stageOffset(-4), cy + stageOffset(-5),
-                       stageRadius(2), UI_FG);
-      drawCircleCompat(gSprite, cx + stageOffset(4), cy + stageOffset(-5),
-                       stageRadius(2), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(-2), cy + stageOffset(-5),
-                     cx + stageOffset(2), cy + stageOffset(-5), UI_FG);
-      drawRectCompat(gSprite, cx + stageOffset(-6), cy + stageOffset(4),
-                     stageDim(12), stageDim(10), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(10), cy + stageOffset(2),
-                     cx + stageOffset(10), cy + stageOffset(14), UI_FG);
-      drawLineCompat(gSprite, cx + stageOffset(8), cy + stageOffset(14),
-                     cx + stageOffset(12), cy + stageOffset(14), UI_FG);
-      break;
-    default:
-      break;
+static Widget icon(int x, int y, WidgetBitmap bitmap) {
+  Widget widget = makeWidget(WIDGET_ICON, 0, x, y, 0, 0);
+  widget.bitmap = bitmap;
+  return widget;
+}
+
+static Widget softkeys(WidgetText text) {
+  Widget widget = makeWidget(WIDGET_SOFTKEYS, 1, 0, 182, SCREEN_W, 8);
+  widget.text = text;
+  return widget;
+}
+
+static Widget custom(int x, int y, int w, int h, WidgetKey key, WidgetDraw draw) {
+  Widget widget = makeWidget(WIDGET_CUSTOM, 0, x, y, w, h);
+  widget.key = key;
+  widget.draw = draw;
+  return widget;
+}
+
+static const int MENU_START_Y = 50;
+static const int MENU_CELL_W = 88;
+static const int MENU_CELL_H = 20;
+static const int MENU_GAP_X = 8;
+static const int MENU_GAP_Y = 4;
+static const int MENU_LEFT_X = 8;
+
+static Widget cell(uint8_t index) {
+  int col = (index % 2);
+  int row = (index / 2);
+  int x = col == 0 ? MENU_LEFT_X : MENU_LEFT_X + MENU_CELL_W + MENU_GAP_X;
+  int y = MENU_START_Y + row * (MENU_CELL_H + MENU_GAP_Y);
+  return makeWidget(WIDGET_CELL, index, x, y, MENU_CELL_W, MENU_CELL_H);
+}
+
+static void drawMenuCell(const Widget &widget, bool selected) {
+  if (selected) {
+    gSprite.setColor(UI_FG);
+    fillRectCompat(gSprite, widget.x, widget.y, widget.w, widget.h, UI_FG);
   }
+  drawRectCompat(gSprite, widget.x, widget.y, widget.w, widget.h, UI_FG);
+  setTextColorMono(selected);
+
+  const char *name = kMenuItems[widget.arg];
+  int labelX = widget.x + (widget.w - estimateTextWidth(name, 1)) / 2;
+  drawText(labelX, widget.y + 6, name, 1);
+  setTextColorMono(false);
 }
 
-static void drawMoodFace(int cx, int cy, Mood mood, int eyeDx, int eyeDy, int eyeR,
-                         int mouthHalf, int mouthDy) {
-  if (mood == MOOD_SLEEPY) {
-    drawLineCompat(gSprite, cx - eyeDx - 2, cy + eyeDy, cx - eyeDx + 2, cy + eyeDy,
-                   UI_FG);
-    drawLineCompat(gSprite, cx + eyeDx - 2, cy + eyeDy, cx + eyeDx + 2, cy + eyeDy,
-                   UI_FG);
-  } else if (mood == MOOD_SICK) {
-    drawLineCompat(gSprite, cx - eyeDx - 2, cy + eyeDy - 2, cx - eyeDx + 2,
-                   cy + eyeDy + 2, UI_FG);
-    drawLineCompat(gSprite, cx - eyeDx - 2, cy + eyeDy + 2, cx - eyeDx + 2,
-                   cy + eyeDy - 2, UI_FG);
-    drawLineCompat(gSprite, cx + eyeDx - 2, cy + eyeDy - 2, cx + eyeDx + 2,
-                   cy + eyeDy + 2, UI_FG);
-    drawLineCompat(gSprite, cx + eyeDx - 2, cy + eyeDy + 2, cx + eyeDx + 2,
-                   cy + eyeDy - 2, UI_FG);
-  } else {
-    drawCircleCompat(gSprite, cx - eyeDx, cy + eyeDy, eyeR, UI_FG);
-    drawCircleCompat(gSprite, cx + eyeDx, cy + eyeDy, eyeR, UI_FG);
+static DirtyRect widgetBox(const Widget &widget, const ViewModel &vm) {
+  if (widget.kind == WIDGET_ICON) {
+    const PetBitmap &bitmap = widget.bitmap(vm);
+    DirtyRect box = {static_cast<int16_t>(widget.x + bitmap.originX),
+                     static_cast<int16_t>(widget.y + bitmap.originY),
+                     static_cast<int16_t>(bitmap.w),
+                     static_cast<int16_t>(bitmap.h)};
+    return box;
   }
+  DirtyRect box = {widget.x, widget.y, widget.w, widget.h};
+  return box;
+}
 
-  int mouthY = cy + mouthDy;
-  if (mood == MOOD_HAPPY) {
-    drawLineCompat(gSprite, cx - mouthHalf, mouthY - 2, cx, mouthY + 2, UI_FG);
-    drawLineCompat(gSprite, cx, mouthY + 2, cx + mouthHalf, mouthY - 2, UI_FG);
-  } else if (mood == MOOD_SAD || mood == MOOD_SICK) {
-    drawLineCompat(gSprite, cx - mouthHalf, mouthY + 2, cx, mouthY - 2, UI_FG);
-    drawLineCompat(gSprite, cx, mouthY - 2, cx + mouthHalf, mouthY + 2, UI_FG);
-  } else {
-    drawLineCompat(gSprite, cx - mouthHalf, mouthY, cx + mouthHalf, mouthY, UI_FG);
+static uint32_t textKey(const char *text) {
+  return drawKeyMix(DRAW_KEY_SEED, text, (uint32_t)strlen(text));
+}
+
+/** Everything that decides the widget's pixels, hashed. */
+static uint32_t widgetKey(const Widget &widget, const ViewModel &vm) {
+  char buf[UI_WIDGET_TEXT];
+  switch (widget.kind) {
+    case WIDGET_LABEL:
+    case WIDGET_SOFTKEYS:
+      widget.text(vm, buf, sizeof(buf));
+      return textKey(buf);
+    case WIDGET_BAR:
+      return vm.stats[widget.arg];
+    case WIDGET_ICON:
+      return widget.bitmap(vm).id;
+    case WIDGET_CELL:
+      return vm.menuIndex == widget.arg ? 1 : 0;
+    case WIDGET_CUSTOM:
+      return widget.key(vm);
   }
+  return 0;
 }
 
-static void drawPetAvatar(int cx, int cy, Stage stage, Mood mood) {
-  switch (stage) {
-    case STAGE_EGG:
-      drawCircleCompat(gSprite, cx, cy + 5, 15, UI_FG);
-      drawCircleCompat(gSprite, cx, cy - 4, 11, UI_FG);
-      drawLineCompat(gSprite, cx - 7, cy + 4, cx - 3, cy + 8, UI_FG);
-      drawLineCompat(gSprite, cx - 3, cy + 8, cx + 1, cy + 4, UI_FG);
-      drawLineCompat(gSprite, cx + 1, cy + 4, cx + 6, cy + 8, UI_FG);
-      drawMoodFace(cx, cy + 1, mood, 4, -1, 1, 3, 3);
-      break;
-    case STAGE_BABY:
-      drawCircleCompat(gSprite, cx, cy - 6, 12, UI_FG);
-      drawCircleCompat(gSprite, cx, cy + 10, 10, UI_FG);
-      drawCircleCompat(gSprite, cx, cy + 2, 2, UI_FG);
-      drawMoodFace(cx, cy - 6, mood, 4, -2, 1, 3, 4);
+static void drawWidget(const Widget &widget, const ViewModel &vm) {
+  char buf[UI_WIDGET_TEXT];
+  setTextColorMono(false);
+  switch (widget.kind) {
+    case WIDGET_LABEL: {
+      widget.text(vm, buf, sizeof(buf));
+      if (!buf[0]) break;
+      int spare = widget.w - estimateTextWidth(buf, widget.arg);
+      int x = widget.x;
+      if (widget.align == ALIGN_CENTER) x += spare / 2;
+      if (widget.align == ALIGN_RIGHT) x += spare;
+      drawText(x, widget.y, buf, widget.arg);
       break;
-    case STAGE_CHILD:
-      drawCircleCompat(gSprite, cx, cy - 8, 11, UI_FG);
-      drawRectCompat(gSprite, cx - 10, cy + 2, 20, 16, UI_FG);
-      drawLineCompat(gSprite, cx - 13, cy + 6, cx - 10, cy + 9, UI_FG);
-      drawLineCompat(gSprite, cx + 10, cy + 9, cx + 13, cy + 6, UI_FG);
-      drawMoodFace(cx, cy - 8, mood, 4, -2, 1, 4, 4);
+    }
+    case WIDGET_BAR:
+      drawBarFill(widget.x, widget.y, widget.w, widget.h, vm.stats[widget.arg]);
       break;
-    case STAGE_TEEN:
-      drawCircleCompat(gSprite, cx, cy - 8, 11, UI_FG);
-      drawLineCompat(gSprite, cx - 7, cy -18, cx - 3, cy -13, UI_FG);
-      drawLineCompat(gSprite, cx, cy -18, cx + 2, cy -13, UI_FG);
-      drawLineCompat(gSprite, cx + 7, cy -18, cx + 3, cy -13, UI_FG);
-      drawRectCompat(gSprite, cx - 9, cy + 2, 18, 18, UI_FG);
-      drawMoodFace(cx, cy - 8, mood, 4, -2, 1, 4, 4);
+    case WIDGET_ICON: {
+      const PetBitmap &bitmap = widget.bitmap(vm);
+      drawBitmapCompat(gSprite, widget.x + bitmap.originX,
+                       widget.y + bitmap.originY, bitmap.bits, bitmap.w,
+                       bitmap.h, UI_FG, 0);
       break;
-    case STAGE_ADULT:
-      drawCircleCompat(gSprite, cx, cy - 8, 12, UI_FG);
-      drawRectCompat(gSprite, cx - 11, cy + 2, 22, 20, UI_FG);
-      drawLineCompat(gSprite, cx - 15, cy + 6, cx - 11, cy + 11, UI_FG);
-      drawLineCompat(gSprite, cx + 11, cy + 11, cx + 15, cy + 6, UI_FG);
-      drawMoodFace(cx, cy - 8, mood, 4, -2, 1, 4, 4);
+    }
+    case WIDGET_CELL:
+      drawMenuCell(widget, vm.menuIndex == widget.arg);
       break;
-    case STAGE_ELDER:
-      drawCircleCompat(gSprite, cx, cy - 8, 11, UI_FG);
-      drawRectCompat(gSprite, cx - 9, cy + 2, 18, 16, UI_FG);
-      drawLineCompat(gSprite, cx + 13, cy + 2, cx + 13, cy + 18, UI_FG);
-      drawLineCompat(gSprite, cx + 11, cy + 18, cx + 15, cy + 18, UI_FG);
-      drawMoodFace(cx, cy - 8, mood, 4, -2, 1, 4, 4);
+    case WIDGET_SOFTKEYS: {
+      widget.text(vm, buf, sizeof(buf));
+      char *mid = strchr(buf, '\t');
+      char *right = mid ? strchr(mid + 1, '\t') : nullptr;
+      if (!right) break;
+      *mid++ = '\0';
+      *right++ = '\0';
+      drawText(widget.x + 4, widget.y, buf, 1);
+      drawTextCentered(widget.y, mid, 1);
+      drawTextRight(widget.x + widget.w - 4, widget.y, right, 1);
       break;
-    default:
-      drawCircleCompat(gSprite, cx, cy, faceRadius(20), UI_FG);
-      drawMoodFace(cx, cy, mood, 4, -2, 1, 4, 4);
+    }
+    case WIDGET_CUSTOM:
+      widget.draw(vm);
       break;
   }
 }
 
-static void drawTopBar() {
-  RTC_TimeTypeDef t;
-  RTC_DateTypeDef d;
-  M5.Rtc.GetTime(&t);
-  M5.Rtc.GetDate(&d);
+// Chrome cache: each screen's static layer (frames, icons, dividers, titles)
+// is drawn once into a full-frame copy. Screen switches start from a bulk copy
+// of it, and a widget is erased by copying its box back out of it.
 
-  char timeBuf[6];
-  snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d", t.Hours, t.Minutes);
+/** @brief Screens whose chrome stays cached at once. */
+static const uint8_t UI_CHROME_SLOTS = 3;
 
-  char leftBuf[24];
-  uint32_t days = gState.ageMinutes / (24 * 60);
-  snprintf(leftBuf, sizeof(leftBuf), "%s - D%lu", timeBuf, (unsigned long)days);
-  drawText(4, 6, leftBuf, 1);
+/** @brief One cached static layer. */
+struct ChromeSlot {
+  bool valid;
+  /** @brief `Screen` the layer belongs to. */
+  uint8_t screen;
+  /** @brief Frame counter at last use, for eviction. */
+  uint32_t lastUse;
+  uint8_t bits[UI_ROW_BYTES * SCREEN_H];
+};
 
-  char coinBuf[14];
-  snprintf(coinBuf, sizeof(coinBuf), "C%u", gState.coins);
-  drawTextCentered(6, coinBuf, 1);
+static ChromeSlot gChrome[UI_CHROME_SLOTS];
+static uint32_t gChromeClock = 0;
 
-  char batBuf[12];
-  snprintf(batBuf, sizeof(batBuf), "B%u%%", getBatteryPercent());
-  drawTextRight(SCREEN_W - 4, 6, batBuf, 1);
-}
+/**
+ * Lay down the static layer of a screen on the cleared sprite. Without
+ * framebuffer access the chrome is simply drawn and nothing is cached.
+ * @return The slot holding the layer, or `nullptr`.
+ */
+static const ChromeSlot *drawChrome(uint8_t screen, void (*draw)()) {
+  uint8_t *frame = spriteBufferCompat(gSprite, 0);
+  if (!frame) {
+    draw();
+    return nullptr;
+  }
 
-static void drawHeader(const char *title, uint8_t size = 1) {
-  drawTopBar();
-  drawDivider(20);
-  if (title && title[0]) {
-    drawTextCentered(24, title, size);
-    drawDivider(44);
+  ++gChromeClock;
+  ChromeSlot *slot = nullptr;
+  for (uint8_t i = 0; i < UI_CHROME_SLOTS; ++i) {
+    if (gChrome[i].valid && gChrome[i].screen == screen) {
+      slot = &gChrome[i];
+      break;
+    }
+  }
+
+  if (slot) {
+    memcpy(frame, slot->bits, sizeof(slot->bits));
+  } else {
+    slot = &gChrome[0];
+    for (uint8_t i = 1; i < UI_CHROME_SLOTS; ++i) {
+      if (!slot->valid) break;
+      if (!gChrome[i].valid || gChrome[i].lastUse < slot->lastUse) {
+        slot = &gChrome[i];
+      }
+    }
+
+    draw();
+    memcpy(slot->bits, frame, sizeof(slot->bits));
+    slot->screen = screen;
+    slot->valid = true;
+    ++gRefreshStats.chromeBuilds;
   }
+
+  slot->lastUse = gChromeClock;
+  return slot;
 }
 
-static uint32_t secondsUntil(uint32_t targetEpoch) {
-  if (targetEpoch == 0) return 0;
-  uint32_t nowEpoch = 0;
-  if (!getCurrentEpoch(nowEpoch)) return 0;
-  if (targetEpoch <= nowEpoch) return 0;
-  return targetEpoch - nowEpoch;
+/** Copy the chrome back over a byte-aligned box of the frame. */
+static void restoreChrome(uint8_t *frame, const ChromeSlot &slot,
+                          const DirtyRect &r) {
+  const int bytes = r.w / 8;
+  for (int row = 0; row < r.h; ++row) {
+    int offset = (r.y + row) * UI_ROW_BYTES + r.x / 8;
+    memcpy(frame + offset, slot.bits + offset, bytes);
+  }
 }
 
-static void drawDebugOverlay() {
-  if (!gRun.devModeUnlocked || !gRun.debugOverlay) return;
+// top bar
 
-  drawRectCompat(gSprite, 4, 144, 192, 30, UI_FG);
+static void topBarClock(const ViewModel &vm, char *buf, size_t len) {
+  if (vm.clockValid) {
+    snprintf(buf, len, "%02u:%02u - D%lu", vm.hour, vm.minute,
+             (unsigned long)vm.days);
+  } else {
+    snprintf(buf, len, "--:-- - D%lu", (unsigned long)vm.days);
+  }
+}
 
-  uint8_t alertMask = getActiveAlertMask();
-  uint8_t alertCount = getActiveAlertCount();
+static void topBarCoins(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "C%u", vm.coins);
+}
 
-  char line1[28];
-  snprintf(line1, sizeof(line1), "CM:%u AL:%u M:%02X", gState.careMistakes,
-           alertCount, alertMask);
-  drawText(8, 148, line1, 1);
+static void topBarBattery(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "B%u%%", vm.battery);
+}
 
-  uint32_t tSeconds = isTantrumActive() ? secondsUntil(gState.tantrumUntilEpoch)
-                                        : secondsUntil(gState.nextTantrumEpoch);
-  char line2[28];
-  snprintf(line2, sizeof(line2), "TN:%lum %s", (unsigned long)(tSeconds / 60),
-           isTantrumActive() ? "ACTIVE" : "NEXT");
-  drawText(8, 158, line2, 1);
+static void tantrumMark(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "%s", vm.tantrum ? "!" : "");
+}
 
-  char line3[40];
-  snprintf(line3, sizeof(line3), "R:%u/%u/%u/%u/%u", gState.hunger,
-           gState.happiness, gState.cleanliness, gState.discipline,
-           gState.health);
-  drawText(8, 168, line3, 1);
+static void stageName(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "%s", kStageNames[vm.stage]);
 }
 
-static void renderHome() {
-  clearSpriteCompat(gSprite, 0);
-  setTextColorMono(false);
-  drawTopBar();
-  drawDivider(20);
+static const Widget kTopBarWidgets[] = {
+    label(4, 6, 84, 1, ALIGN_LEFT, topBarClock),
+    label(82, 6, 36, 1, ALIGN_CENTER, topBarCoins),
+    label(160, 6, 36, 1, ALIGN_RIGHT, topBarBattery),
+};
 
-  Mood mood = currentMood();
-  Stage stage = static_cast<Stage>(gState.stage);
+// home
 
+static void drawHomeChrome() {
+  setTextColorMono(false);
+  drawDivider(20);
   drawHomeIconRow(24, true);
 
-  const int playX = 28;
-  const int playY = 44;
-  const int playW = 144;
-  const int playH = 78;
-  drawRectCompat(gSprite, playX, playY, playW, playH, UI_FG);
-  drawRectCompat(gSprite, playX + 2, playY + 2, playW - 4, playH - 4, UI_FG);
+  drawRectCompat(gSprite, 28, 44, 144, 78, UI_FG);
+  drawRectCompat(gSprite, 30, 46, 140, 74, UI_FG);
 
-  char ageBuf[20];
-  uint32_t days = gState.ageMinutes / (24 * 60);
-  snprintf(ageBuf, sizeof(ageBuf), "Age %lud", (unsigned long)days);
-  drawText(playX + 6, playY + 4, kStageNames[stage], 1);
-  drawTextRight(playX + playW - 6, playY + 4, ageBuf, 1);
+  drawHomeIconRow(126, false);
 
-  drawPetAvatar(SCREEN_W / 2, playY + 43, stage, mood);
+  drawDivider(142);
+  drawStatFrame(8, 146, "HU");
+  drawStatFrame(8, 160, "DS");
+  drawStatFrame(108, 146, "CL");
+  drawStatFrame(108, 160, "HP");
+  drawDivider(176);
+}
 
-  if (gState.asleep) {
-    drawText(playX + 6, playY + 14, "Zzz", 1);
-  }
-  if (gState.sick) {
-    drawTextRight(playX + playW - 6, playY + 14, "Sick", 1);
-  }
-  if (isTantrumActive()) {
-    drawTextRight(playX + playW - 6, playY + 26, "!", 2);
-  }
+static void homeAge(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Age %lud", (unsigned long)vm.days);
+}
 
-  drawHomeIconRow(126, false);
+static void homeAsleep(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "%s", vm.asleep ? "Zzz" : "");
+}
 
-  drawDivider(142);
-  drawStatMini(8, 146, "HU", gState.hunger);
-  drawStatMini(8, 160, "DS", gState.discipline);
-  drawStatMini(108, 146, "CL", gState.cleanliness);
-  drawStatMini(108, 160, "HP", gState.happiness);
+static void homeSick(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "%s", vm.sick ? "Sick" : "");
+}
 
-  const char *action = gState.asleep ? "B Light" : "B Play";
-  drawSoftkeys("A Menu", action, "C Status");
+static const PetBitmap &homeAvatar(const ViewModel &vm) {
+  return petAvatarBitmap(static_cast<Stage>(vm.stage), static_cast<Mood>(vm.mood));
 }
 
-static void renderMenu() {
-  clearSpriteCompat(gSprite, 0);
-  setTextColorMono(false);
-  drawHeader("Menu");
-
-  const int startY = 50;
-  const int cellW = 88;
-  const int cellH = 20;
-  const int gapX = 8;
-  const int gapY = 4;
-  const int leftX = 8;
-  const int rightX = leftX + cellW + gapX;
-
-  for (uint8_t i = 0; i < kMenuCount; ++i) {
-    int col = (i % 2);
-    int row = (i / 2);
-    int x = col == 0 ? leftX : rightX;
-    int y = startY + row * (cellH + gapY);
-
-    if (i == gRun.menuIndex) {
-      gSprite.setColor(UI_FG);
-      fillRectCompat(gSprite, x, y, cellW, cellH, UI_FG);
-      drawRectCompat(gSprite, x, y, cellW, cellH, UI_FG);
-      setTextColorMono(true);
-    } else {
-      drawRectCompat(gSprite, x, y, cellW, cellH, UI_FG);
-      setTextColorMono(false);
-    }
+static void homeSoftkeys(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "A Menu\t%s\tC Status", vm.asleep ? "B Light" : "B Play");
+}
 
-    int labelW = estimateTextWidth(kMenuItems[i], 1);
-    int labelX = x + (cellW - labelW) / 2;
-    drawText(labelX, y + 6, kMenuItems[i], 1);
-  }
+static const Widget kHomeWidgets[] = {
+    label(34, 48, 60, 1, ALIGN_LEFT, stageName),
+    label(106, 48, 60, 1, ALIGN_RIGHT, homeAge),
+    icon(SCREEN_W / 2, 87, homeAvatar),
+    label(34, 58, 18, 1, ALIGN_LEFT, homeAsleep),
+    label(142, 58, 24, 1, ALIGN_RIGHT, homeSick),
+    label(154, 70, 12, 2, ALIGN_RIGHT, tantrumMark),
+    bar(8, 146, VIEW_STAT_HUNGER),
+    bar(8, 160, VIEW_STAT_DISCIPLINE),
+    bar(108, 146, VIEW_STAT_CLEANLINESS),
+    bar(108, 160, VIEW_STAT_HAPPINESS),
+    softkeys(homeSoftkeys),
+};
+
+// menu
+
+static void drawMenuChrome() {
   setTextColorMono(false);
+  drawHeaderChrome("Menu");
+  drawDivider(176);
+}
 
-  drawSoftkeys("A Home", "B Select", "C Next");
+static void menuSoftkeys(const ViewModel &, char *buf, size_t len) {
+  snprintf(buf, len, "A Home\tB Select\tC Next");
 }
 
-static void renderStatus() {
-  clearSpriteCompat(gSprite, 0);
+static const Widget kMenuWidgets[] = {
+    cell(0), cell(1), cell(2), cell(3), cell(4),
+    cell(5), cell(6), cell(7), cell(8), cell(9),
+    softkeys(menuSoftkeys),
+};
+
+// status
+
+static void drawStatusChrome() {
   setTextColorMono(false);
-  drawHeader("Status");
-  if (isTantrumActive()) {
-    drawTextRight(SCREEN_W - 8, 24, "!", 2);
-  }
+  drawHeaderChrome("Status");
 
   int y = 52;
-  drawStatMini(8, y, "HL", gState.health);
-  drawStatMini(8, y + 14, "HU", gState.hunger);
-  drawStatMini(8, y + 28, "HP", gState.happiness);
-  drawStatMini(8, y + 42, "CL", gState.cleanliness);
-  drawStatMini(8, y + 56, "DS", gState.discipline);
-
-  char buf[24];
-  uint32_t days = gState.ageMinutes / (24 * 60);
+  drawStatFrame(8, y, "HL");
+  drawStatFrame(8, y + 14, "HU");
+  drawStatFrame(8, y + 28, "HP");
+  drawStatFrame(8, y + 42, "CL");
+  drawStatFrame(8, y + 56, "DS");
   drawText(110, 50, "Stage", 1);
-  drawText(110, 60, kStageNames[gState.stage], 1);
-  drawStageIcon(170, 66, static_cast<Stage>(gState.stage));
-  snprintf(buf, sizeof(buf), "Age: %lud", (unsigned long)days);
-  drawText(110, 82, buf, 1);
-  snprintf(buf, sizeof(buf), "Wt: %u", gState.weight);
-  drawText(110, 94, buf, 1);
-  snprintf(buf, sizeof(buf), "Poop: %u", gState.poop);
-  drawText(110, 106, buf, 1);
-  snprintf(buf, sizeof(buf), "Sick: %s", gState.sick ? "Yes" : "No");
-  drawText(110, 118, buf, 1);
-  snprintf(buf, sizeof(buf), "Sleep: %s", gState.asleep ? "Yes" : "No");
-  drawText(110, 130, buf, 1);
-  snprintf(buf, sizeof(buf), "CM: %u", gState.careMistakes);
-  drawText(110, 142, buf, 1);
-
-  drawDebugOverlay();
-  drawSoftkeys("A Back", gRun.devModeUnlocked ? "B Inv/Dbg" : "B Inv",
-               "C Reset");
-}
-
-static void renderResetConfirm() {
-  clearSpriteCompat(gSprite, 0);
+  drawDivider(176);
+}
+
+static const PetBitmap &statusStageIcon(const ViewModel &vm) {
+  return stageIconBitmap(static_cast<Stage>(vm.stage));
+}
+
+static void statusAge(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Age: %lud", (unsigned long)vm.days);
+}
+
+static void statusWeight(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Wt: %u", vm.weight);
+}
+
+static void statusPoop(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Poop: %u", vm.poop);
+}
+
+static void statusSick(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Sick: %s", vm.sick ? "Yes" : "No");
+}
+
+static void statusSleep(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Sleep: %s", vm.asleep ? "Yes" : "No");
+}
+
+static void statusCareMistakes(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "CM: %u", vm.careMistakes);
+}
+
+static void statusSoftkeys(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "A Back\t%s\tC Reset", vm.devMode ? "B Inv/Dbg" : "B Inv");
+}
+
+static uint32_t debugOverlayKey(const ViewModel &vm) {
+  if (!vm.debugOverlay) return 0;
+  uint32_t key = DRAW_KEY_SEED;
+  for (uint8_t i = 0; i < DEBUG_OVERLAY_LINES; ++i) {
+    key = drawKeyMix(key, vm.debugLines[i], (uint32_t)strlen(vm.debugLines[i]) + 1);
+  }
+  return key;
+}
+
+static void drawDebugOverlay(const ViewModel &vm) {
+  if (!vm.debugOverlay) return;
+
+  drawRectCompat(gSprite, 4, 144, 192, 30, UI_FG);
+  for (uint8_t i = 0; i < DEBUG_OVERLAY_LINES; ++i) {
+    drawText(8, 148 + i * 10, vm.debugLines[i], 1);
+  }
+}
+
+static const Widget kStatusWidgets[] = {
+    label(180, 24, 12, 2, ALIGN_RIGHT, tantrumMark),
+    bar(8, 52, VIEW_STAT_HEALTH),
+    bar(8, 66, VIEW_STAT_HUNGER),
+    bar(8, 80, VIEW_STAT_HAPPINESS),
+    bar(8, 94, VIEW_STAT_CLEANLINESS),
+    bar(8, 108, VIEW_STAT_DISCIPLINE),
+    label(110, 60, 42, 1, ALIGN_LEFT, stageName),
+    icon(170, 66, statusStageIcon),
+    label(110, 82, 84, 1, ALIGN_LEFT, statusAge),
+    label(110, 94, 84, 1, ALIGN_LEFT, statusWeight),
+    label(110, 106, 84, 1, ALIGN_LEFT, statusPoop),
+    label(110, 118, 84, 1, ALIGN_LEFT, statusSick),
+    label(110, 130, 84, 1, ALIGN_LEFT, statusSleep),
+    label(110, 142, 84, 1, ALIGN_LEFT, statusCareMistakes),
+    // Last, so it stays on top of the labels it overlaps.
+    custom(4, 144, 192, 32, debugOverlayKey, drawDebugOverlay),
+    softkeys(statusSoftkeys),
+};
+
+// reset confirm
+
+static void drawResetConfirmChrome() {
   setTextColorMono(false);
-  drawHeader("Reset Game?");
+  drawHeaderChrome("Reset Game?");
 
   drawRectCompat(gSprite, 14, 56, 172, 86, UI_FG);
   drawTextCentered(74, "This will erase", 1);
   drawTextCentered(88, "all progress.", 1);
   drawTextCentered(108, "B: Confirm", 1);
   drawTextCentered(122, "A/C: Cancel", 1);
+  drawDivider(176);
+}
 
-  drawSoftkeys("A No", "B Yes", "C No");
+static void resetConfirmSoftkeys(const ViewModel &, char *buf, size_t len) {
+  snprintf(buf, len, "A No\tB Yes\tC No");
 }
 
-static void renderInventory() {
-  clearSpriteCompat(gSprite, 0);
-  setTextColorMono(false);
-  drawHeader("Inventory");
+static const Widget kResetConfirmWidgets[] = {
+    softkeys(resetConfirmSoftkeys),
+};
 
-  ItemType item = static_cast<ItemType>(gRun.inventoryIndex);
-  uint8_t count = inventoryCount(item);
-  char buf[32];
+// inventory
 
+static void drawInventoryChrome() {
+  setTextColorMono(false);
+  drawHeaderChrome("Inventory");
   drawRectCompat(gSprite, 20, 54, 160, 76, UI_FG);
+  drawDivider(176);
+}
 
-  snprintf(buf, sizeof(buf), "%s", kItems[item].name);
-  drawTextCentered(62, buf, 3);
+static void inventoryName(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "%s", kItems[vm.item].name);
+}
 
-  snprintf(buf, sizeof(buf), "Count %u", count);
-  drawTextCentered(92, buf, 2);
+static void inventoryCountText(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Count %u", vm.itemCount);
+}
 
-  snprintf(buf, sizeof(buf), "Cost %u", kItems[item].cost);
-  drawTextCentered(112, buf, 2);
+static void inventoryCost(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "Cost %u", kItems[vm.item].cost);
+}
 
-  drawTextCentered(136, count > 0 ? "Use" : "Buy", 2);
+static void inventoryAction(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "%s", vm.itemCount > 0 ? "Use" : "Buy");
+}
 
-  drawSoftkeys("A Back", "B Use/Buy", "C Next");
+static void inventorySoftkeys(const ViewModel &, char *buf, size_t len) {
+  snprintf(buf, len, "A Back\tB Use/Buy\tC Next");
 }
 
-static void renderMinigame() {
-  clearSpriteCompat(gSprite, 0);
+static const Widget kInventoryWidgets[] = {
+    label(0, 62, SCREEN_W, 3, ALIGN_CENTER, inventoryName),
+    label(0, 92, SCREEN_W, 2, ALIGN_CENTER, inventoryCountText),
+    label(0, 112, SCREEN_W, 2, ALIGN_CENTER, inventoryCost),
+    label(0, 136, SCREEN_W, 2, ALIGN_CENTER, inventoryAction),
+    softkeys(inventorySoftkeys),
+};
+
+// mini-game
+
+static void drawMinigameChrome() {
   setTextColorMono(false);
-  drawHeader("Mini-game");
+  drawHeaderChrome("Mini-game");
+  drawDivider(176);
+}
 
-  if (!gRun.mgActive) {
+static uint32_t minigameKey(const ViewModel &vm) {
+  uint32_t round[3] = {vm.mgActive, vm.mgTarget, vm.mgSecondsLeft};
+  return drawKeyMix(DRAW_KEY_SEED, round, sizeof(round));
+}
+
+static void drawMinigameBody(const ViewModel &vm) {
+  if (!vm.mgActive) {
     drawTextCentered(74, "Press B", 2);
     drawTextCentered(94, "to start", 2);
-  } else {
-    const char *target =
-        gRun.mgTarget == 0 ? "A" : (gRun.mgTarget == 1 ? "B" : "C");
-    char buf[32];
-    snprintf(buf, sizeof(buf), "Press %s", target);
-    drawTextCentered(76, buf, 3);
-
-    uint32_t now = millis();
-    uint32_t remaining =
-        (gRun.mgDeadlineMs > now) ? (gRun.mgDeadlineMs - now) : 0;
-    snprintf(buf, sizeof(buf), "%lus", (unsigned long)(remaining / 1000));
-    drawTextCentered(112, buf, 2);
+    return;
   }
+  const char *target = vm.mgTarget == 0 ? "A" : (vm.mgTarget == 1 ? "B" : "C");
+  char buf[32];
+  snprintf(buf, sizeof(buf), "Press %s", target);
+  drawTextCentered(76, buf, 3);
+  snprintf(buf, sizeof(buf), "%lus", (unsigned long)vm.mgSecondsLeft);
+  drawTextCentered(112, buf, 2);
+}
 
-  drawSoftkeys("A Back", "B Go", "C Back");
+static void minigameSoftkeys(const ViewModel &, char *buf, size_t len) {
+  snprintf(buf, len, "A Back\tB Go\tC Back");
 }
 
-static void renderMessage() {
-  clearSpriteCompat(gSprite, 0);
+static const Widget kMinigameWidgets[] = {
+    custom(0, 74, SCREEN_W, 56, minigameKey, drawMinigameBody),
+    softkeys(minigameSoftkeys),
+};
+
+// message
+
+static void drawMessageChrome() {
   setTextColorMono(false);
   drawRectCompat(gSprite, 12, 54, 176, 84, UI_FG);
-  drawTextCentered(86, gRun.message, 2);
-  drawSoftkeys("A OK", "B OK", "C OK");
+  drawDivider(176);
+}
+
+static void messageText(const ViewModel &vm, char *buf, size_t len) {
+  snprintf(buf, len, "%s", vm.message);
 }
 
-static void renderHelp() {
-  clearSpriteCompat(gSprite, 0);
+static void messageSoftkeys(const ViewModel &, char *buf, size_t len) {
+  snprintf(buf, len, "A OK\tB OK\tC OK");
+}
+
+static const Widget kMessageWidgets[] = {
+    label(0, 86, SCREEN_W, 2, ALIGN_CENTER, messageText),
+    softkeys(messageSoftkeys),
+};
+
+// help
+
+static void drawHelpChrome() {
   setTextColorMono(false);
-  drawHeader("Helper", 1);
-
-  static const char *const kHelpLines[] = {
-      "Controls",
-      "A: Up in Helper",
-      "B: Select / Back",
-      "C: Down in Helper",
-      "G5: Go Home",
-      "G27: Toggle Status",
-      "",
-      "Home",
-      "A Menu  B Play/Light",
-      "C Status",
-      "",
-      "Reset",
-      "Status: C opens confirm",
-      "B confirms reset",
-      "A/C cancel reset",
-      "",
-      "Legend",
-      "HL Health  HU Hunger",
-      "HP Happy   CL Clean",
-      "DS Discipline"};
+  drawHeaderChrome("Helper", 1);
+  drawDivider(176);
+}
 
+static uint32_t helpKey(const ViewModel &vm) { return vm.helpScroll; }
+
+static void drawHelpBody(const ViewModel &vm) {
   const int startY = 52;
   const int lineH = 12;
-  const int visibleLines = 10;
-  const int totalLines = (int)(sizeof(kHelpLines) / sizeof(kHelpLines[0]));
-  const int maxScroll = totalLines > visibleLines ? (totalLines - visibleLines) : 0;
-  int scroll = gRun.helpScroll;
-  if (scroll > maxScroll) scroll = maxScroll;
-
-  for (int i = 0; i < visibleLines; ++i) {
-    int idx = scroll + i;
-    if (idx >= totalLines) break;
+  for (int i = 0; i < HELP_VISIBLE_LINES; ++i) {
+    int idx = vm.helpScroll + i;
+    if (idx >= HELP_TOTAL_LINES) break;
     drawText(8, startY + i * lineH, kHelpLines[idx], 1);
   }
 
   char pageBuf[16];
-  snprintf(pageBuf, sizeof(pageBuf), "%d/%d", scroll + 1, maxScroll + 1);
+  snprintf(pageBuf, sizeof(pageBuf), "%d/%d", vm.helpScroll + 1,
+           HELP_MAX_SCROLL + 1);
   drawTextRight(SCREEN_W - 4, 166, pageBuf, 1);
-
-  drawSoftkeys("A Up", "B Back", "C Down");
 }
 
-/** @copydoc renderScreen */
-void renderScreen() {
-  if (!gRun.dirty) return;
-  gRun.dirty = false;
+static void helpSoftkeys(const ViewModel &, char *buf, size_t len) {
+  snprintf(buf, len, "A Up\tB Back\tC Down");
+}
 
-  switch (gRun.screen) {
-    case SCREEN_HOME:
-      renderHome();
-      break;
+static const Widget kHelpWidgets[] = {
+    custom(0, 52, SCREEN_W, 124, helpKey, drawHelpBody),
+    softkeys(helpSoftkeys),
+};
+
+// screens
+
+struct ScreenDef {
+  void (*chrome)();
+  /** @brief Whether the shared top bar row comes before `widgets`. */
+  bool topBar;
+  const Widget *widgets;
+  uint8_t count;
+};
+
+#define SCREEN_DEF(chrome, topBar, widgets) \
+  { chrome, topBar, widgets, sizeof(widgets) / sizeof(widgets[0]) }
+
+static const ScreenDef kHomeScreen = SCREEN_DEF(drawHomeChrome, true, kHomeWidgets);
+static const ScreenDef kMenuScreen = SCREEN_DEF(drawMenuChrome, true, kMenuWidgets);
+static const ScreenDef kStatusScreen =
+    SCREEN_DEF(drawStatusChrome, true, kStatusWidgets);
+static const ScreenDef kInventoryScreen =
+    SCREEN_DEF(drawInventoryChrome, true, kInventoryWidgets);
+static const ScreenDef kMinigameScreen =
+    SCREEN_DEF(drawMinigameChrome, true, kMinigameWidgets);
+static const ScreenDef kMessageScreen =
+    SCREEN_DEF(drawMessageChrome, false, kMessageWidgets);
+static const ScreenDef kHelpScreen = SCREEN_DEF(drawHelpChrome, true, kHelpWidgets);
+static const ScreenDef kResetConfirmScreen =
+    SCREEN_DEF(drawResetConfirmChrome, true, kResetConfirmWidgets);
+
+#undef SCREEN_DEF
+
+static const ScreenDef &screenDef(uint8_t screen) {
+  switch (screen) {
     case SCREEN_MENU:
-      renderMenu();
-      break;
+      return kMenuScreen;
     case SCREEN_STATUS:
-      renderStatus();
-      break;
+      return kStatusScreen;
     case SCREEN_INVENTORY:
-      renderInventory();
-      break;
+      return kInventoryScreen;
     case SCREEN_MINIGAME:
-      renderMinigame();
-      break;
+      return kMinigameScreen;
     case SCREEN_MESSAGE:
-      renderMessage();
-      break;
+      return kMessageScreen;
     case SCREEN_HELP:
-      renderHelp();
-      break;
+      return kHelpScreen;
     case SCREEN_RESET_CONFIRM:
-      renderResetConfirm();
-      break;
+      return kResetConfirmScreen;
     default:
-      renderHome();
-      break;
+      return kHomeScreen;
+  }
+}
+
+static const uint8_t TOP_BAR_WIDGETS =
+    sizeof(kTopBarWidgets) / sizeof(kTopBarWidgets[0]);
+
+static uint8_t widgetCount(const ScreenDef &def) {
+  return static_cast<uint8_t>((def.topBar ? TOP_BAR_WIDGETS : 0) + def.count);
+}
+
+static const Widget &screenWidget(const ScreenDef &def, uint8_t index) {
+  if (def.topBar) {
+    if (index < TOP_BAR_WIDGETS) return kTopBarWidgets[index];
+    index = static_cast<uint8_t>(index - TOP_BAR_WIDGETS);
   }
+  return def.widgets[index];
+}
+
+// Retained state: the screen on the panel and the key each of its widgets was
+// last drawn with.
+
+/** @brief Widgets one screen may have, top bar included. */
+static const uint8_t UI_MAX_WIDGETS = 24;
+
+static uint32_t gWidgetKeys[UI_MAX_WIDGETS];
+static uint8_t gRetainedScreen = 0;
+static bool gRetainedValid = false;
+static const ChromeSlot *gRetainedChrome = nullptr;
+
+/** The widget's box widened to whole framebuffer bytes: what a restore touches. */
+static DirtyRect restoreBox(const Widget &widget, const ViewModel &vm) {
+  DirtyRect box = widgetBox(widget, vm);
+  int x0 = box.x < 0 ? 0 : box.x;
+  int y0 = box.y < 0 ? 0 : box.y;
+  int x1 = box.x + box.w > SCREEN_W ? SCREEN_W : box.x + box.w;
+  int y1 = box.y + box.h > SCREEN_H ? SCREEN_H : box.y + box.h;
+  x0 -= x0 % 8;
+  x1 = (x1 + 7) / 8 * 8;
+  DirtyRect r = {static_cast<int16_t>(x0), static_cast<int16_t>(y0),
+                 static_cast<int16_t>(x1 > x0 ? x1 - x0 : 0),
+                 static_cast<int16_t>(y1 > y0 ? y1 - y0 : 0)};
+  return r;
+}
+
+static bool boxesOverlap(const DirtyRect &a, const DirtyRect &b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h &&
+         b.y < a.y + a.h;
+}
 
+/**
+ * Erasing a widget also erases whatever of its neighbours shares its bytes,
+ * so those are redrawn too, until no undamaged widget overlaps a damaged one.
+ */
+static void spreadDamage(const DirtyRect *boxes, bool *damaged, uint8_t count) {
+  bool grew = true;
+  while (grew) {
+    grew = false;
+    for (uint8_t i = 0; i < count; ++i) {
+      if (!damaged[i]) continue;
+      for (uint8_t j = 0; j < count; ++j) {
+        if (!damaged[j] && boxesOverlap(boxes[i], boxes[j])) {
+          damaged[j] = true;
+          grew = true;
+        }
+      }
+    }
+  }
+}
+
+static void copyWindow(uint8_t *dst, const uint8_t *frame, const DirtyRect &r) {
+  const int bytes = r.w / 8;
+  for (int row = 0; row < r.h; ++row) {
+    memcpy(dst + row * bytes, frame + (r.y + row) * UI_ROW_BYTES + r.x / 8,
+           bytes);
+  }
+}
+
+static void storeWindow(const uint8_t *frame, const DirtyRect &r) {
+  const int bytes = r.w / 8;
+  for (int row = 0; row < r.h; ++row) {
+    int offset = (r.y + row) * UI_ROW_BYTES + r.x / 8;
+    memcpy(gPanelShadow + offset, frame + offset, bytes);
+  }
+}
+
+static void pushFull(uint8_t *frame) {
+  TRACE_SCOPE("pushFull");
+  if (frame) {
+    // A cleared panel shows an empty frame, whatever the shadow said.
+    if (clearPanelCompat(M5.M5Ink, 0)) {
+      memset(gPanelShadow, gBlankByte, sizeof(gPanelShadow));
+    }
+    if (pushWindowCompat(M5.M5Ink, gPanelShadow, frame, 0, 0, SCREEN_W,
+                         SCREEN_H, 0)) {
+      memcpy(gPanelShadow, frame, sizeof(gPanelShadow));
+      return;
+    }
+  }
   pushSpriteCompat(gSprite, 0);
 }
+
+static bool pushPartial(uint8_t *frame, const DirtyRects &dirty) {
+  TRACE_SCOPE("pushPartial");
+  for (uint8_t i = 0; i < dirty.count; ++i) {
+    const DirtyRect &r = dirty.rects[i];
+    copyWindow(gWindowBefore, gPanelShadow, r);
+    copyWindow(gWindowAfter, frame, r);
+    if (!pushWindowCompat(M5.M5Ink, gWindowBefore, gWindowAfter, r.x, r.y, r.w,
+                          r.h, 0)) {
+      return false;
+    }
+    storeWindow(frame, r);
+    gRefreshStats.pixels += (uint32_t)r.w * r.h;
+  }
+  return true;
+}
+
+/**
+ * Bring the panel up to date with the frame just drawn: nothing if no widget
+ * or no tile changed, partial windows over the changed tiles, or a full
+ * refresh every `UI_FULL_REFRESH_EVERY` updates and whenever the damage is
+ * large anyway.
+ */
+static void presentFrame(uint8_t *frame, DirtyRects dirty) {
+  ++gRefreshStats.frames;
+  metricAdd(METRIC_FRAMES_RENDERED);
+  if (gPanelValid && dirty.count == 0) {
+    ++gRefreshStats.skipped;
+    return;
+  }
+
+  if (frame) {
+    // Narrow the widget damage down to tiles whose pixels really changed.
+    DirtyRects changed;
+    frameTilesUpdate(gPanelTiles, frame, SCREEN_W, SCREEN_H,
+                     gPanelValid ? &dirty : nullptr, changed);
+    if (gPanelValid && changed.count == 0) {
+      ++gRefreshStats.identical;
+      return;
+    }
+    dirty = changed;
+  }
+
+  const uint32_t screenArea = (uint32_t)SCREEN_W * SCREEN_H;
+  bool full = !gPanelValid || !frame ||
+              gPartialsSinceFull >= UI_FULL_REFRESH_EVERY ||
+              dirtyArea(dirty) * 100 >= screenArea * UI_FULL_REFRESH_AREA_PERCENT;
+
+  if (!full && pushPartial(frame, dirty)) {
+    ++gRefreshStats.partial;
+    ++gPartialsSinceFull;
+    metricAdd(METRIC_FRAMES_PUSHED);
+    metricAdd(METRIC_REFRESH_PARTIAL);
+    return;
+  }
+
+  pushFull(frame);
+  gPanelValid = true;
+  gPartialsSinceFull = 0;
+  ++gRefreshStats.full;
+  gRefreshStats.pixels += screenArea;
+  metricAdd(METRIC_FRAMES_PUSHED);
+  metricAdd(METRIC_REFRESH_FULL);
+}
+
+/** @copydoc takeViewModel */
+bool takeViewModel(ViewModel &vm) {
+  if (!gRun.dirty) return false;
+  gRun.dirty = false;
+  gFrameAlertChanges = takeAlertChanges();
+  buildViewModel(vm);
+  return true;
+}
+
+/** @copydoc renderViewModel */
+void renderViewModel(const ViewModel &vm) {
+  TRACE_SCOPE("renderScreen");
+  const ScreenDef &def = screenDef(vm.screen);
+  const uint8_t count = widgetCount(def);
+  uint8_t *frame = spriteBufferCompat(gSprite, 0);
+
+  bool rebuild = !gRetainedValid || gRetainedScreen != vm.screen;
+  bool damaged[UI_MAX_WIDGETS];
+  bool anyDamaged = false;
+  for (uint8_t i = 0; i < count; ++i) {
+    uint32_t key = widgetKey(screenWidget(def, i), vm);
+    damaged[i] = rebuild || key != gWidgetKeys[i];
+    anyDamaged = anyDamaged || damaged[i];
+    gWidgetKeys[i] = key;
+  }
+  gRetainedScreen = vm.screen;
+  gRetainedValid = true;
+
+  DirtyRects damage;
+  dirtyClear(damage);
+  if (rebuild || (!frame && anyDamaged)) {
+    // New screen, or no framebuffer to patch: draw everything from scratch.
+    clearSpriteCompat(gSprite, 0);
+    if (frame) gBlankByte = frame[0];
+    gRetainedChrome = drawChrome(vm.screen, def.chrome);
+    for (uint8_t i = 0; i < count; ++i) {
+      drawWidget(screenWidget(def, i), vm);
+    }
+    gRefreshStats.widgetsDrawn += count;
+    DirtyRect all = {0, 0, SCREEN_W, SCREEN_H};
+    dirtyAdd(damage, all, SCREEN_W, SCREEN_H);
+  } else if (frame && anyDamaged) {
+    DirtyRect boxes[UI_MAX_WIDGETS];
+    for (uint8_t i = 0; i < count; ++i) {
+      boxes[i] = restoreBox(screenWidget(def, i), vm);
+    }
+    spreadDamage(boxes, damaged, count);
+
+    // Erase every damaged widget before drawing any, so overlapping ones
+    // stay stacked in table order.
+    for (uint8_t i = 0; i < count; ++i) {
+      if (damaged[i]) restoreChrome(frame, *gRetainedChrome, boxes[i]);
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+      if (!damaged[i]) continue;
+      drawWidget(screenWidget(def, i), vm);
+      dirtyAdd(damage, boxes[i], SCREEN_W, SCREEN_H);
+      ++gRefreshStats.widgetsDrawn;
+    }
+  }
+
+  presentFrame(frame, damage);
+}
+
+/** @copydoc renderScreen */
+void renderScreen() {
+  ViewModel vm;
+  if (takeViewModel(vm)) renderViewModel(vm);
+}
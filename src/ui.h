@@ -1,6 +1,8 @@
 #pragma once
 
+#include "metrics.h"
 #include "pet.h"
+#include "view_model.h"
 #include <M5GFX.h>
 
 /**
@@ -8,8 +10,75 @@
  * @brief Rendering entry points and compatibility wrappers for sprite APIs.
  */
 
+/** @brief Panel update counters. */
+struct RefreshStats {
+  /** @brief Frames rendered. */
+  uint32_t frames;
+  /** @brief Frames in which no widget changed, so nothing was sent. */
+  uint32_t skipped;
+  /**
+   * @brief Frames drawn differently but pixel-identical to the panel (by tile
+   * hash), so nothing was sent.
+   */
+  uint32_t identical;
+  /** @brief Frames sent as partial-refresh windows. */
+  uint32_t partial;
+  /** @brief Frames sent as a full refresh. */
+  uint32_t full;
+  /** @brief Pixels sent to the panel. */
+  uint32_t pixels;
+  /** @brief Static screen layers drawn into the chrome cache (cache misses). */
+  uint32_t chromeBuilds;
+  /** @brief Widgets re-rasterized, whole-screen redraws included. */
+  uint32_t widgetsDrawn;
+};
+
+/**
+ * @brief Panel update counters since boot. Owned by the render task; other
+ * tasks read the frame counts from the metrics registry instead.
+ */
+extern RefreshStats gRefreshStats;
+
+/**
+ * @brief Pages of the dev-mode debug overlay: pet internals, then the metrics
+ * registry `DEBUG_OVERLAY_LINES` at a time.
+ */
+static const uint8_t DEBUG_OVERLAY_PAGES =
+    1 + (METRIC_COUNT + DEBUG_OVERLAY_LINES - 1) / DEBUG_OVERLAY_LINES;
+
+/**
+ * @brief Snapshot everything the screens show.
+ * @param vm Receives the current view model.
+ */
+void buildViewModel(ViewModel &vm);
+
+/**
+ * @brief Snapshot the screen if runtime state is marked dirty, and clear the
+ * mark.
+ * @param vm Receives the view model when there is a new frame.
+ * @return `false` when nothing changed since the last snapshot.
+ */
+bool takeViewModel(ViewModel &vm);
+
+/**
+ * @brief Draw a view model and bring the panel up to date with it.
+ *
+ * Screens are retained widget trees: only widgets whose view-model inputs
+ * changed since the last frame are redrawn, and only the 16x16 tiles whose
+ * pixels changed since the previous frame are sent to the panel, as
+ * partial-refresh windows. Pixel-identical frames are not sent at all; every
+ * so often a full refresh clears the ghosting partial updates leave behind.
+ * Frames pushed are `partial + full` of `gRefreshStats`.
+ *
+ * Reads nothing but `vm`, so it can run on the render task while the game
+ * task changes the state behind it.
+ * @param vm Frame to show.
+ */
+void renderViewModel(const ViewModel &vm);
+
 /**
- * @brief Render the currently active screen when runtime state is marked dirty.
+ * @brief Render the currently active screen when runtime state is marked
+ * dirty: `takeViewModel()`, then `renderViewModel()` on the same task.
  */
 void renderScreen();
 
@@ -82,3 +151,96 @@ static auto clearSpriteCompat(T &sprite, long)
     -> decltype(sprite.fillScreen(TFT_BLACK), void()) {
   sprite.fillScreen(TFT_BLACK);
 }
+
+/**
+ * @brief Draw the set bits of a packed 1bpp bitmap (MSB leftmost).
+ * @tparam T Sprite type.
+ */
+template <typename T>
+static auto drawBitmapCompat(T &sprite, int x, int y, const uint8_t *bits,
+                             int w, int h, uint16_t color, int)
+    -> decltype(sprite.drawBitmap(x, y, bits, w, h, color), void()) {
+  sprite.drawBitmap(x, y, bits, w, h, color);
+}
+
+/** @copydoc drawBitmapCompat */
+template <typename T>
+static auto drawBitmapCompat(T &sprite, int x, int y, const uint8_t *bits,
+                             int w, int h, uint16_t color, long)
+    -> decltype(sprite.drawPixel(x, y, color), void()) {
+  const int rowBytes = (w + 7) / 8;
+  for (int row = 0; row < h; ++row) {
+    for (int col = 0; col < w; ++col) {
+      if (bits[row * rowBytes + col / 8] & (0x80 >> (col & 7))) {
+        sprite.drawPixel(x + col, y + row, color);
+      }
+    }
+  }
+}
+
+/**
+ * @brief The sprite's 1bpp framebuffer (rows of `SCREEN_W / 8` bytes), if the
+ * sprite exposes it.
+ * @tparam T Sprite type.
+ */
+template <typename T>
+static auto spriteBufferCompat(T &sprite, int)
+    -> decltype(static_cast<uint8_t *>(sprite.getSpritePtr())) {
+  return static_cast<uint8_t *>(sprite.getSpritePtr());
+}
+
+/** @copydoc spriteBufferCompat */
+template <typename T>
+static uint8_t *spriteBufferCompat(T &sprite, long) {
+  (void)sprite;
+  return nullptr;
+}
+
+/**
+ * @brief Update one window of the panel with the Core Ink partial refresh.
+ * @tparam Ink Panel driver type.
+ * @param before What the window shows now, packed 1bpp.
+ * @param after What it should show, packed 1bpp.
+ * @return `false` when the driver has no windowed update.
+ */
+template <typename Ink>
+static auto pushWindowCompat(Ink &ink, uint8_t *before, uint8_t *after, int x,
+                             int y, int w, int h, int)
+    -> decltype(ink.setDrawAddr(x, y, w, h),
+                ink.drawBuff(before, after, (size_t)0), bool()) {
+  ink.setDrawAddr(x, y, w, h);
+  ink.drawBuff(before, after, (size_t)(w / 8) * h);
+  return true;
+}
+
+/** @copydoc pushWindowCompat */
+template <typename Ink>
+static bool pushWindowCompat(Ink &ink, uint8_t *before, uint8_t *after, int x,
+                             int y, int w, int h, long) {
+  (void)ink;
+  (void)before;
+  (void)after;
+  (void)x;
+  (void)y;
+  (void)w;
+  (void)h;
+  return false;
+}
+
+/**
+ * @brief Full-waveform clear of the panel, which removes ghosting.
+ * @tparam Ink Panel driver type.
+ * @return `false` when the driver cannot clear.
+ */
+template <typename Ink>
+static auto clearPanelCompat(Ink &ink, int) -> decltype(ink.clear(), bool()) {
+  ink.clear();
+  return true;
+}
+
+/** @copydoc clearPanelCompat */
+template <typename Ink>
+static bool clearPanelCompat(Ink &ink, long) {
+  (void)ink;
+  return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @file view_model.h
+ * @brief Everything the screens show, flattened into one comparable struct.
+ *
+ * Built from `PetState`, `RuntimeState`, the clock and a few counters once
+ * per rendered frame. Widgets read only this struct, so comparing what a
+ * widget would draw now with what it drew last time needs nothing else.
+ * It holds no pointers into the game state, so the render task can draw a
+ * copy while the game task moves on.
+ */
+
+/** @brief Text lines of the debug overlay. */
+static const uint8_t DEBUG_OVERLAY_LINES = 3;
+/** @brief Buffer size of one overlay line (32 characters fit the box). */
+static const uint8_t DEBUG_LINE_LEN = 48;
+/** @brief Buffer size of the message text, as in `RuntimeState::message`. */
+static const uint8_t VIEW_MESSAGE_LEN = 64;
+
+/** @brief Indices into `ViewModel::stats`. */
+enum ViewStat {
+  VIEW_STAT_HUNGER,
+  VIEW_STAT_HAPPINESS,
+  VIEW_STAT_CLEANLINESS,
+  VIEW_STAT_DISCIPLINE,
+  VIEW_STAT_HEALTH,
+  VIEW_STAT_COUNT
+};
+
+/** @brief Inputs of every widget on every screen. */
+struct ViewModel {
+  /** @brief `Screen` being shown. */
+  uint8_t screen;
+
+  /** @brief Whether the wall clock is known. */
+  bool clockValid;
+  uint8_t hour;
+  uint8_t minute;
+  /** @brief Pet age in whole days. */
+  uint32_t days;
+  uint16_t coins;
+  uint8_t battery;
+
+  /** @brief 0-100 stats by `ViewStat`. */
+  uint8_t stats[VIEW_STAT_COUNT];
+  /** @brief `Stage`. */
+  uint8_t stage;
+  /** @brief `Mood`. */
+  uint8_t mood;
+  bool asleep;
+  bool sick;
+  bool tantrum;
+  uint8_t weight;
+  uint8_t poop;
+  uint16_t careMistakes;
+
+  uint8_t menuIndex;
+  /** @brief `ItemType` selected in the inventory. */
+  uint8_t item;
+  uint8_t itemCount;
+  /** @brief Help scroll offset, already clamped to the last page. */
+  uint8_t helpScroll;
+  bool mgActive;
+  uint8_t mgTarget;
+  uint32_t mgSecondsLeft;
+  /** @brief Text of the message screen. */
+  char message[VIEW_MESSAGE_LEN];
+
+  bool devMode;
+  /** @brief Whether the Status screen shows the debug overlay. */
+  bool debugOverlay;
+  /** @brief Overlay text of the current page, already formatted. */
+  char debugLines[DEBUG_OVERLAY_LINES][DEBUG_LINE_LEN];
+};
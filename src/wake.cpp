@@ -0,0 +1,37 @@
+#include "wake.h"
+
+/**
+ * @file wake.cpp
+ * @brief The pure wake-deadline and deep sleep calculations.
+ */
+
+/** Shorten `best` to the time left until `dueMs`, if `active`. */
+static void considerDeadline(uint32_t &best, bool active, uint32_t nowMs,
+                             uint32_t dueMs) {
+  if (!active) return;
+  const int32_t left = static_cast<int32_t>(dueMs - nowMs);
+  const uint32_t wait = left > 0 ? static_cast<uint32_t>(left) : 0;
+  if (wait < best) best = wait;
+}
+
+/** @copydoc wakeDelayMs */
+uint32_t wakeDelayMs(const WakeInputs &in) {
+  if (in.busy) return 0;
+
+  uint32_t best = in.buttonHeld ? WAKE_HELD_POLL_MS : WAKE_MAX_SLEEP_MS;
+  considerDeadline(best, true, in.nowMs, in.minuteDueMs);
+  considerDeadline(best, in.messageActive, in.nowMs, in.messageDueMs);
+  considerDeadline(best, in.miniGameActive, in.nowMs, in.miniGameDueMs);
+  considerDeadline(best, in.savePending, in.nowMs, in.saveDueMs);
+  return best;
+}
+
+/** @copydoc wakeDeepSleepUntil */
+uint32_t wakeDeepSleepUntil(const DeepSleepInputs &in) {
+  if (in.nowEpoch == 0 || !in.home || in.idleMs < WAKE_DEEP_IDLE_MS) return 0;
+
+  uint32_t wakeEpoch = in.nowEpoch + WAKE_DEEP_MAX_MINUTES * 60;
+  if (in.nextEventEpoch < wakeEpoch) wakeEpoch = in.nextEventEpoch;
+  if (wakeEpoch < in.nowEpoch + WAKE_DEEP_MIN_MINUTES * 60) return 0;
+  return wakeEpoch;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "input.h"
+
+/**
+ * @file wake.h
+ * @brief When the game task has to run next, and sleeping until then.
+ *
+ * Nothing polls every 10 ms. Each pass of the game task (app_tasks.cpp) ends
+ * by asking `wakeDelayMs()` how long nothing can happen, then `wakeSleep()`
+ * light-sleeps that long or until a button interrupt, whichever is first.
+ * Button edges are queued by their interrupt (see input.h), which wakes the
+ * input task, so a tap is never missed even when it is over before the CPU
+ * is back up.
+ *
+ * Once the pet has been left alone on the Home screen, the game task goes
+ * further and deep-sleeps until the next minute the screen would change
+ * (`wakeDeepSleepUntil()`). The panel keeps its image without power and the
+ * pet waits in RTC memory (rtc_mirror.h); the timer or a button boots the
+ * firmware again, which catches up like after any other restart.
+ *
+ * `wakeDelayMs()` and `wakeDeepSleepUntil()` are pure and build on the host;
+ * the rest is device only (`wake_sources.cpp`).
+ */
+
+/** @brief Longest sleep, so a stuck deadline costs at most one extra wake. */
+static const uint32_t WAKE_MAX_SLEEP_MS = 60UL * 1000UL;
+/**
+ * @brief Sleep slice while a button is held.
+ *
+ * Light sleep wakes on a low level, so a held button would wake it at once;
+ * the input task checks for long presses in short slices until the button is
+ * let go.
+ */
+static const uint32_t WAKE_HELD_POLL_MS = 10;
+
+/** @brief Time left alone on the Home screen before deep sleep is considered. */
+static const uint32_t WAKE_DEEP_IDLE_MS = 2UL * 60UL * 1000UL;
+/** @brief Shortest deep sleep worth a reboot; shorter gaps light-sleep. */
+static const uint32_t WAKE_DEEP_MIN_MINUTES = 5;
+/**
+ * @brief Longest deep sleep, which is as stale as the clock and the stat
+ * bars on the panel can get.
+ */
+static const uint32_t WAKE_DEEP_MAX_MINUTES = 30;
+
+/** @brief How the current boot started (device only). */
+enum WakeBoot : uint8_t {
+  /** @brief Power-on or reset: nothing was sleeping. */
+  WAKE_BOOT_COLD,
+  /** @brief The deep sleep timer ran out; nobody touched the device. */
+  WAKE_BOOT_TIMER,
+  /** @brief A button ended the deep sleep. */
+  WAKE_BOOT_BUTTON
+};
+
+/**
+ * @brief Everything the next wake depends on.
+ *
+ * Deadlines are `millis()` values; a deadline only counts when its flag is
+ * set. Wrap-around is handled.
+ */
+struct WakeInputs {
+  uint32_t nowMs;
+  /** @brief Work is already waiting (a redraw, serial input). */
+  bool busy;
+  /** @brief A button is down right now. */
+  bool buttonHeld;
+  /** @brief When the next simulated minute is due. */
+  uint32_t minuteDueMs;
+  bool messageActive;
+  /** @brief When the message screen times out. */
+  uint32_t messageDueMs;
+  bool miniGameActive;
+  /** @brief When the running mini-game round is lost. */
+  uint32_t miniGameDueMs;
+  bool savePending;
+  /** @brief When `serviceSaves()` will write. */
+  uint32_t saveDueMs;
+};
+
+/**
+ * @brief Milliseconds until the loop has anything to do.
+ * @param in Current state of the deadlines.
+ * @return 0 to run again right away, otherwise at most `WAKE_MAX_SLEEP_MS`
+ * (`WAKE_HELD_POLL_MS` while a button is held).
+ */
+uint32_t wakeDelayMs(const WakeInputs &in);
+
+/** @brief Everything the deep sleep decision depends on. */
+struct DeepSleepInputs {
+  /** @brief Current epoch; 0 while the clock is unknown. */
+  uint32_t nowEpoch;
+  /** @brief Milliseconds since the last button event. */
+  uint32_t idleMs;
+  /** @brief The Home screen is up. */
+  bool home;
+  /** @brief Next visible change of the pet, from `simNextEventEpoch()`. */
+  uint32_t nextEventEpoch;
+};
+
+/**
+ * @brief Whether to deep-sleep now, and until when.
+ * @param in Current state.
+ * @return Epoch to wake at: the next event, at most `WAKE_DEEP_MAX_MINUTES`
+ * away. 0 to stay up: the clock is unknown, someone is using the device,
+ * or the next event is under `WAKE_DEEP_MIN_MINUTES` away.
+ */
+uint32_t wakeDeepSleepUntil(const DeepSleepInputs &in);
+
+/**
+ * @brief Attach the button edge interrupts and arm the wake sources (device
+ * only). Call once from `setup()`.
+ */
+void wakeSourcesBegin();
+/**
+ * @brief Give `task` (a FreeRTOS `TaskHandle_t`) a task notification for
+ * every edge queued from now on (device only).
+ * @param task Task that calls `wakeTakeEdge()`.
+ */
+void wakeSetEdgeTask(void *task);
+/**
+ * @brief Take the oldest queued button edge (device only).
+ * @param edge Receives it.
+ * @return `false` when no edge is waiting.
+ */
+bool wakeTakeEdge(InputEdge &edge);
+/**
+ * @brief Whether a button edge is still inside its debounce window (device
+ * only); its settled level has not been checked yet.
+ * @return `true` until every button has been quiet for `INPUT_DEBOUNCE_US`.
+ */
+bool wakeEdgesSettling();
+/**
+ * @brief Edges lost to a full queue since boot (device only).
+ * @return Dropped edge count; should stay 0.
+ */
+uint32_t wakeDroppedEdges();
+/**
+ * @brief Whether any button is down right now (device only).
+ * @return `true` while a button is held.
+ */
+bool wakeButtonHeld();
+/**
+ * @brief Sleep for up to `ms`, returning early on a button press or serial
+ * input (device only).
+ *
+ * Light sleep when nothing is held; otherwise a plain task delay. Returns
+ * at once if edges are still queued. Light sleep stops both cores, so only
+ * call it when no other task has work left.
+ * @param ms Sleep length from `wakeDelayMs()`; 0 returns at once.
+ */
+void wakeSleep(uint32_t ms);
+/**
+ * @brief Why this boot happened (device only).
+ * @return `WAKE_BOOT_COLD` unless it ended a `wakeDeepSleep()`.
+ */
+WakeBoot wakeBootReason();
+/**
+ * @brief Deep-sleep for `seconds` or until the wheel is pressed or pushed
+ * up (device only). Does not return; the firmware boots again.
+ *
+ * The power-hold pin (GPIO12) is latched high for the sleep, or the board
+ * would switch itself off on battery; `wakeSourcesBegin()` releases it.
+ * Everything not in RTC memory is lost, so call `mirrorForDeepSleep()`
+ * first. The ESP32 cannot wake on any of several low pins from deep sleep,
+ * so the other buttons do not wake it.
+ * @param seconds Sleep length.
+ */
+void wakeDeepSleep(uint32_t seconds);
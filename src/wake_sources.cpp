@@ -0,0 +1,186 @@
+#include "wake.h"
+
+#include <M5CoreInk.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include <esp_sleep.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+
+#include "metrics.h"
+
+/**
+ * @file wake_sources.cpp
+ * @brief Button edge interrupts, light and deep sleep on the Core Ink.
+ */
+
+/** @brief Button pins in `InputButton` order: A (up), B (mid), C (down), top, side. */
+static const uint8_t kButtonPins[INPUT_BUTTON_COUNT] = {37, 38, 39, 5, 27};
+/** @brief Keeps the board's power latch on while high; `M5.begin()` sets it. */
+static const gpio_num_t POWER_HOLD_PIN = GPIO_NUM_12;
+/** @brief Serial bytes that wake the CPU; they are lost, the rest arrives. */
+static const int WAKE_UART_THRESHOLD = 3;
+
+// The interrupt and syncButtonLevels() both produce edges; the mux makes them
+// one producer as far as the queue is concerned.
+static portMUX_TYPE gWakeMux = portMUX_INITIALIZER_UNLOCKED;
+static InputDebounce gDebounce;
+static InputQueue gInputQueue;
+static TaskHandle_t gEdgeTask = nullptr;
+
+/** `digitalRead()` is not in IRAM; the input registers are. */
+static bool IRAM_ATTR pinLow(uint8_t pin) {
+  const uint32_t levels =
+      pin < 32 ? REG_READ(GPIO_IN_REG) : REG_READ(GPIO_IN1_REG);
+  return ((levels >> (pin & 31)) & 1u) == 0;
+}
+
+static void IRAM_ATTR onButtonEdge(void *arg) {
+  const InputButton button =
+      static_cast<InputButton>(reinterpret_cast<uintptr_t>(arg));
+  const uint32_t now = micros();
+  const bool levelDown = pinLow(kButtonPins[button]);
+  portENTER_CRITICAL_ISR(&gWakeMux);
+  InputEdge edge;
+  if (inputDebounceEdge(gDebounce, button, levelDown, now, edge)) {
+    inputQueuePush(gInputQueue, edge);
+  }
+  portEXIT_CRITICAL_ISR(&gWakeMux);
+  // Filtered edges wake the task too: it re-reads the levels once they
+  // settle, in case the level read here was mid-bounce.
+  if (gEdgeTask) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(gEdgeTask, &woken);
+    if (woken) portYIELD_FROM_ISR();
+  }
+}
+
+/**
+ * Queue level changes no edge reported: presses that woke the CPU from light
+ * sleep (edge interrupts are off meanwhile) and a bounce that left the state
+ * inverted.
+ */
+static void syncButtonLevels() {
+  const uint32_t now = micros();
+  bool queued = false;
+  portENTER_CRITICAL(&gWakeMux);
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    InputEdge edge;
+    if (inputDebounceSync(gDebounce, static_cast<InputButton>(i),
+                          digitalRead(kButtonPins[i]) == LOW, now, edge)) {
+      queued = inputQueuePush(gInputQueue, edge) || queued;
+    }
+  }
+  portEXIT_CRITICAL(&gWakeMux);
+  if (queued && gEdgeTask) xTaskNotifyGive(gEdgeTask);
+}
+
+/** @copydoc wakeSourcesBegin */
+void wakeSourcesBegin() {
+  // Released only now, after M5.begin() drove the pin high again, so the
+  // latch never sees it float between deep sleep and boot.
+  gpio_hold_dis(POWER_HOLD_PIN);
+  uint8_t downMask = 0;
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    const uint8_t pin = kButtonPins[i];
+    // GPIO 34-39 are input only; the board pulls those buttons up itself.
+    pinMode(pin, pin >= 34 ? INPUT : INPUT_PULLUP);
+    if (digitalRead(pin) == LOW) downMask |= 1u << i;
+  }
+  inputDebounceReset(gDebounce, downMask, micros());
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    attachInterruptArg(kButtonPins[i], onButtonEdge,
+                       reinterpret_cast<void *>(static_cast<uintptr_t>(i)),
+                       CHANGE);
+  }
+  uart_set_wakeup_threshold(UART_NUM_0, WAKE_UART_THRESHOLD);
+  esp_sleep_enable_uart_wakeup(0);
+  esp_sleep_enable_gpio_wakeup();
+}
+
+/** @copydoc wakeSetEdgeTask */
+void wakeSetEdgeTask(void *task) { gEdgeTask = static_cast<TaskHandle_t>(task); }
+
+/** @copydoc wakeTakeEdge */
+bool wakeTakeEdge(InputEdge &edge) {
+  if (inputQueuePop(gInputQueue, edge)) return true;
+  syncButtonLevels();
+  return inputQueuePop(gInputQueue, edge);
+}
+
+/** @copydoc wakeEdgesSettling */
+bool wakeEdgesSettling() { return !inputDebounceSettled(gDebounce, micros()); }
+
+/** @copydoc wakeDroppedEdges */
+uint32_t wakeDroppedEdges() { return gInputQueue.dropped; }
+
+/** @copydoc wakeButtonHeld */
+bool wakeButtonHeld() {
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    if (digitalRead(kButtonPins[i]) == LOW) return true;
+  }
+  return false;
+}
+
+/** @copydoc wakeSleep */
+void wakeSleep(uint32_t ms) {
+  if (ms == 0 || inputQueuePending(gInputQueue)) return;
+  if (wakeButtonHeld()) {
+    delay(ms);
+    return;
+  }
+
+  const uint32_t startMs = millis();
+  Serial.flush();
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    gpio_wakeup_enable(static_cast<gpio_num_t>(kButtonPins[i]),
+                       GPIO_INTR_LOW_LEVEL);
+  }
+  esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(ms) * 1000ULL);
+  // A tap that came and went during this loop iteration is not a low level
+  // any more; it only shows in the queue.
+  if (!inputQueuePending(gInputQueue)) esp_light_sleep_start();
+
+  // Waking up left the pins on level wake; put the edge interrupts back.
+  for (uint8_t i = 0; i < INPUT_BUTTON_COUNT; ++i) {
+    const gpio_num_t pin = static_cast<gpio_num_t>(kButtonPins[i]);
+    gpio_wakeup_disable(pin);
+    gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+  }
+  syncButtonLevels();
+  metricObserve(METRIC_SLEEP_MS, millis() - startMs);
+}
+
+/** @copydoc wakeBootReason */
+WakeBoot wakeBootReason() {
+  switch (esp_sleep_get_wakeup_cause()) {
+    case ESP_SLEEP_WAKEUP_TIMER:
+      return WAKE_BOOT_TIMER;
+    case ESP_SLEEP_WAKEUP_EXT0:
+    case ESP_SLEEP_WAKEUP_EXT1:
+      return WAKE_BOOT_BUTTON;
+    default:
+      return WAKE_BOOT_COLD;
+  }
+}
+
+/** @copydoc wakeDeepSleep */
+void wakeDeepSleep(uint32_t seconds) {
+  Serial.flush();
+  // UART and GPIO wake are light sleep only.
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(seconds) * 1000000ULL);
+  // ext1 wakes only once all of its pins are low, so each source gets one
+  // button. Both have the board's pull-ups, which deep sleep leaves alone.
+  esp_sleep_enable_ext0_wakeup(
+      static_cast<gpio_num_t>(kButtonPins[INPUT_BUTTON_B]), 0);
+  esp_sleep_enable_ext1_wakeup(1ULL << kButtonPins[INPUT_BUTTON_A],
+                               ESP_EXT1_WAKEUP_ALL_LOW);
+  // Deep sleep powers down the GPIO matrix; a floating power-hold pin lets
+  // the latch drop, and on battery the device would just turn off.
+  gpio_hold_en(POWER_HOLD_PIN);
+  gpio_deep_sleep_hold_en();
+  esp_deep_sleep_start();
+}